@@ -0,0 +1,119 @@
+#ifndef MYVK_ASYNC_UPLOADER_HPP
+#define MYVK_ASYNC_UPLOADER_HPP
+
+#include "Buffer.hpp"
+#include "CommandBuffer.hpp"
+#include "CommandPool.hpp"
+#include "ImageBase.hpp"
+#include "Semaphore.hpp"
+#include "SyncHelper.hpp"
+
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace myvk {
+
+// Records buffer / image uploads on a (dedicated) transfer queue and hands them over to a destination queue.
+//
+// Usage:
+// 1. Enqueue*() from any thread, the data is copied to a staging buffer immediately
+// 2. Flush() submits all pending uploads to the transfer queue and returns the timeline value to wait on
+// 3. CmdAcquire() records the queue family ownership acquire barriers into a command buffer of the destination queue,
+//    the submission of that command buffer must wait on the returned timeline value (see GetSemaphorePtr())
+//
+// If the queue families differ, CmdAcquire() is mandatory: a flushed batch keeps its destination resources alive until
+// acquired. Otherwise it only returns the value to wait on, and batches are dropped once completed.
+//
+// After acquisition, the uploaded resources are in the requested dst sync state; for render graph external resources,
+// set it as their src pipeline stages / access flags / layout.
+class AsyncUploader : public DeviceObjectBase {
+private:
+	struct BufferUpload {
+		Ptr<Buffer> staging;
+		Ptr<BufferBase> dst;
+		VkBufferCopy region;
+		BufferSyncState dst_state;
+	};
+	struct ImageUpload {
+		Ptr<Buffer> staging;
+		Ptr<ImageBase> dst;
+		VkBufferImageCopy region;
+		ImageSyncState dst_state;
+	};
+	struct Batch {
+		uint64_t value{};
+		Ptr<CommandBuffer> command_buffer;
+		std::vector<BufferUpload> buffer_uploads;
+		std::vector<ImageUpload> image_uploads;
+		bool acquired{false}, completed{false};
+	};
+
+	Ptr<Queue> m_transfer_queue_ptr, m_dst_queue_ptr;
+	Ptr<CommandPool> m_command_pool_ptr;
+	Ptr<TimelineSemaphore> m_semaphore_ptr;
+
+	mutable std::mutex m_mutex;
+	uint64_t m_value{0};
+	std::vector<BufferUpload> m_pending_buffer_uploads;
+	std::vector<ImageUpload> m_pending_image_uploads;
+	std::deque<Batch> m_batches;
+
+	inline bool need_ownership_transfer() const {
+		return m_transfer_queue_ptr->GetFamilyIndex() != m_dst_queue_ptr->GetFamilyIndex();
+	}
+	Ptr<Buffer> create_staging(const void *data, VkDeviceSize size) const;
+	void collect();
+
+public:
+	static Ptr<AsyncUploader> Create(const Ptr<Queue> &transfer_queue, const Ptr<Queue> &dst_queue);
+
+	// Uploads data to dst_buffer[dst_offset, dst_offset + size)
+	bool EnqueueBuffer(const Ptr<BufferBase> &dst_buffer, VkDeviceSize dst_offset, const void *data,
+	                   VkDeviceSize size, const BufferSyncState &dst_state);
+
+	// Uploads tightly packed texels to a region of dst_image, the previous contents of the subresources are discarded
+	bool EnqueueImage(const Ptr<ImageBase> &dst_image, const VkImageSubresourceLayers &subresource,
+	                  const VkOffset3D &offset, const VkExtent3D &extent, const void *data, VkDeviceSize size,
+	                  const ImageSyncState &dst_state);
+
+	// Submits pending uploads, returns the timeline value signaled on completion
+	uint64_t Flush();
+
+	// Records acquire barriers of all flushed uploads, returns the timeline value to wait on (0 if nothing to wait)
+	uint64_t CmdAcquire(const Ptr<CommandBuffer> &dst_command_buffer);
+
+	// Whether a flushed batch can be dropped, acquisition is only required with an ownership transfer
+	inline static bool IsBatchRetired(bool completed, bool acquired, bool ownership_transfer) {
+		return completed && (acquired || !ownership_transfer);
+	}
+
+	// Waits on the host until all flushed uploads are completed
+	VkResult WaitIdle(uint64_t timeout = UINT64_MAX) const;
+
+	// Queue family ownership transfer barriers of an upload, recorded on the transfer and the destination queue
+	// The release and acquire barriers of an upload match in families, range and (image) layouts
+	static VkBufferMemoryBarrier2 GetReleaseBarrier(const BufferBase &dst_buffer, const VkBufferCopy &region,
+	                                                uint32_t src_family, uint32_t dst_family);
+	static VkBufferMemoryBarrier2 GetAcquireBarrier(const BufferBase &dst_buffer, const VkBufferCopy &region,
+	                                                const BufferSyncState &dst_state, uint32_t src_family,
+	                                                uint32_t dst_family);
+	static VkImageMemoryBarrier2 GetReleaseBarrier(const ImageBase &dst_image, const VkBufferImageCopy &region,
+	                                               const ImageSyncState &dst_state, uint32_t src_family,
+	                                               uint32_t dst_family);
+	static VkImageMemoryBarrier2 GetAcquireBarrier(const ImageBase &dst_image, const VkBufferImageCopy &region,
+	                                               const ImageSyncState &dst_state, uint32_t src_family,
+	                                               uint32_t dst_family);
+
+	inline const Ptr<TimelineSemaphore> &GetSemaphorePtr() const { return m_semaphore_ptr; }
+	inline const Ptr<Queue> &GetTransferQueuePtr() const { return m_transfer_queue_ptr; }
+	inline const Ptr<Queue> &GetDstQueuePtr() const { return m_dst_queue_ptr; }
+
+	inline const Ptr<Device> &GetDevicePtr() const override { return m_transfer_queue_ptr->GetDevicePtr(); }
+
+	~AsyncUploader() override = default;
+};
+
+} // namespace myvk
+
+#endif
@@ -15,6 +15,13 @@ private:
 	void *m_mapped_ptr{};
 	VkDeviceAddress m_address{};
 
+	// Kept to recreate the buffer when its allocation is moved, pNext and queue families are dropped
+	VkBufferCreateInfo m_create_info{};
+	std::vector<uint32_t> m_queue_families;
+	bool m_movable{false};
+
+	friend class Defragmenter;
+
 	inline VmaAllocator get_allocator_handle() const {
 		return (m_usage & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT) ? m_device_ptr->GetDeviceAddressAllocatorHandle()
 		                                                             : m_device_ptr->GetAllocatorHandle();
@@ -57,6 +64,7 @@ public:
 	void *Map() const;
 	void Unmap() const;
 	inline VkDeviceAddress GetDeviceAddress() const { return m_address; }
+	inline VmaAllocation GetAllocationHandle() const { return m_allocation; }
 
 	template <typename Iter> inline void UpdateData(Iter begin, Iter end, uint32_t byte_offset = 0) const {
 		using T = typename std::iterator_traits<Iter>::value_type;
@@ -14,6 +14,7 @@
 #include "Semaphore.hpp"
 
 #include "volk.h"
+#include <array>
 #include <map>
 #include <memory>
 #include <vector>
@@ -36,6 +37,9 @@ public:
 	                const SemaphoreGroup &signal_semaphores = SemaphoreGroup(),
 	                const Ptr<Fence> &fence = nullptr) const;
 	VkResult Submit(const Ptr<Fence> &fence = nullptr) const;
+	VkResult Submit2(const std::vector<VkSemaphoreSubmitInfo> &wait_semaphore_infos,
+	                 const std::vector<VkSemaphoreSubmitInfo> &signal_semaphore_infos,
+	                 const Ptr<Fence> &fence = nullptr) const;
 
 	VkResult Reset(VkCommandBufferResetFlags flags = 0) const;
 
@@ -166,6 +170,15 @@ public:
 	void CmdWriteTimestamp(VkPipelineStageFlagBits pipeline_stage, const Ptr<QueryPool> &query_pool,
 	                       uint32_t query) const;
 
+	void CmdBeginQuery(const Ptr<QueryPool> &query_pool, uint32_t query, VkQueryControlFlags flags = 0) const;
+
+	void CmdEndQuery(const Ptr<QueryPool> &query_pool, uint32_t query) const;
+
+	// No-op without VK_EXT_debug_utils
+	void CmdBeginDebugLabel(const char *name, const std::array<float, 4> &color = {}) const;
+
+	void CmdEndDebugLabel() const;
+
 	VkCommandBuffer GetHandle() const { return m_command_buffer; }
 
 	const Ptr<CommandPool> &GetCommandPoolPtr() const { return m_command_pool_ptr; }
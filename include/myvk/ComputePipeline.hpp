@@ -6,6 +6,9 @@
 
 namespace myvk {
 class ComputePipeline : public PipelineBase {
+private:
+	Ptr<ShaderModule> m_shader_module_ptr; // Kept alive for cached pipelines
+
 public:
 	static Ptr<ComputePipeline> Create(const Ptr<PipelineLayout> &pipeline_layout,
 	                                   const VkComputePipelineCreateInfo &create_info);
@@ -15,6 +18,19 @@ public:
 
 	static Ptr<ComputePipeline> Create(const Ptr<PipelineLayout> &pipeline_layout,
 	                                   const Ptr<ShaderModule> &shader_module);
+	// Returns an existing pipeline with the same layout and shader (including specialization) if one is alive
+	static Ptr<ComputePipeline> CreateCached(const Ptr<PipelineLayout> &pipeline_layout,
+	                                         const Ptr<ShaderModule> &shader_module);
+
+	// Canonical serialization of a compute pipeline create info, including the entry point and specialization values
+	// Returns false if the create info or its stage has a pNext chain (such infos never compare equal)
+	static bool AppendCacheKey(CacheKey *p_key, const VkComputePipelineCreateInfo &create_info);
+	struct CreateInfoHash {
+		std::size_t operator()(const VkComputePipelineCreateInfo &create_info) const;
+	};
+	struct CreateInfoEqual {
+		bool operator()(const VkComputePipelineCreateInfo &l, const VkComputePipelineCreateInfo &r) const;
+	};
 
 	VkPipelineBindPoint GetBindPoint() const override { return VK_PIPELINE_BIND_POINT_COMPUTE; }
 
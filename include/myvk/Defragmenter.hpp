@@ -0,0 +1,131 @@
+#ifndef MYVK_DEFRAGMENTER_HPP
+#define MYVK_DEFRAGMENTER_HPP
+
+#include "Buffer.hpp"
+#include "CommandBuffer.hpp"
+#include "CommandPool.hpp"
+#include "Image.hpp"
+#include "Semaphore.hpp"
+#include "SyncHelper.hpp"
+
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace myvk {
+
+// Compacts long-lived myvk::Image / myvk::Buffer allocations with VMA's incremental defragmentation.
+// Only registered resources are moved, all other allocations of the device allocator are left in place.
+//
+// Usage (between two frames, on the queue the resources are used on):
+// 1. Register() the resources with the sync state they are left in at the end of each frame
+// 2. Flush() starts a pass: the moved resources are recreated in their new place and copied on the GPU,
+//    the old resources keep working until the pass is applied
+// 3. Update() polls the pass; once the copies are done, the objects take over the new handles and the listeners are
+//    notified to recreate their image views and rewrite descriptor sets (render graph input buffers are followed
+//    automatically, input images need the new view set); the old memory is freed when the queue passed that point
+//
+// Registered resources must not be written by the GPU between Flush() and Update() applying the pass, nor by the host
+// until Update() finished it. Resources need TRANSFER_SRC and TRANSFER_DST usages, and ones created with pNext chains
+// or device addresses cannot be moved, neither can persistently mapped buffers.
+class Defragmenter : public DeviceObjectBase {
+public:
+	struct MoveEvent {
+		std::vector<Ptr<Image>> images;
+		std::vector<Ptr<Buffer>> buffers;
+	};
+	using Listener = std::function<void(const MoveEvent &)>;
+
+private:
+	struct ImageEntry {
+		std::weak_ptr<Image> image;
+		ImageSyncState state;
+	};
+	struct BufferEntry {
+		std::weak_ptr<Buffer> buffer;
+		BufferSyncState state;
+	};
+	struct ImageMove {
+		Ptr<Image> image;
+		ImageSyncState state;
+		VkImage vk_image; // The new handle before the pass is applied, the old one after
+	};
+	struct BufferMove {
+		Ptr<Buffer> buffer;
+		BufferSyncState state;
+		VkBuffer vk_buffer;
+	};
+
+public:
+	enum class PassState { kIdle, kCopying, kRetiring };
+	enum class PassAction { kBegin, kWait, kApply, kCancel, kEnd };
+	// Step of a pass: Flush() only begins one when idle, Update() waits for the last submission of the pass, then
+	// applies the moves (kCopying -> kRetiring) or frees the old resources (kRetiring -> kIdle); an abandoned pass is
+	// cancelled before being applied
+	static PassAction GetPassAction(PassState state, bool submission_completed, bool abandon = false);
+
+private:
+	Ptr<Queue> m_queue_ptr;
+	Ptr<CommandPool> m_command_pool_ptr;
+	Ptr<TimelineSemaphore> m_semaphore_ptr;
+	VmaDefragmentationInfo m_info{};
+
+	// Allocation handles stay the same when moved
+	std::unordered_map<VmaAllocation, ImageEntry> m_images;
+	std::unordered_map<VmaAllocation, BufferEntry> m_buffers;
+	std::vector<Listener> m_listeners;
+
+	VmaDefragmentationContext m_context{VK_NULL_HANDLE};
+	VmaDefragmentationPassMoveInfo m_pass{};
+	PassState m_pass_state{PassState::kIdle};
+	uint64_t m_value{0};
+	Ptr<CommandBuffer> m_command_buffer;
+	std::vector<ImageMove> m_image_moves;
+	std::vector<BufferMove> m_buffer_moves;
+	VmaDefragmentationStats m_stats{};
+
+	inline VmaAllocator get_allocator_handle() const { return GetDevicePtr()->GetAllocatorHandle(); }
+	bool create_moves();
+	void destroy_moves();
+	bool submit_copies();
+	void apply_moves();
+	void end_pass();
+	void cancel_pass();
+	void end_defragmentation();
+
+public:
+	// At most max_bytes_per_pass bytes and max_allocations_per_pass allocations are moved in a pass, 0 for no limit
+	static Ptr<Defragmenter> Create(const Ptr<Queue> &queue, VkDeviceSize max_bytes_per_pass = 0,
+	                                uint32_t max_allocations_per_pass = 0);
+
+	// Returns false if the resource cannot be moved, resources are unregistered when destroyed
+	bool Register(const Ptr<Image> &image, const ImageSyncState &state);
+	bool Register(const Ptr<Buffer> &buffer, const BufferSyncState &state);
+
+	// Called in Update() with the resources moved by a pass
+	inline void AddListener(Listener listener) { m_listeners.push_back(std::move(listener)); }
+
+	// Submits the copies of the next pass, starting a defragmentation if none is running, returns the timeline value
+	// signaled on their completion (0 if nothing is left to move)
+	uint64_t Flush();
+
+	// Applies the flushed pass once its copies are completed and finishes it when the queue no longer uses the old
+	// resources, returns true if nothing is pending
+	bool Update();
+
+	inline bool IsRunning() const { return m_context != VK_NULL_HANDLE; }
+	inline PassState GetPassState() const { return m_pass_state; }
+	// Statistics of the last finished defragmentation
+	inline const VmaDefragmentationStats &GetStats() const { return m_stats; }
+
+	inline const Ptr<TimelineSemaphore> &GetSemaphorePtr() const { return m_semaphore_ptr; }
+	inline const Ptr<Queue> &GetQueuePtr() const { return m_queue_ptr; }
+
+	inline const Ptr<Device> &GetDevicePtr() const override { return m_queue_ptr->GetDevicePtr(); }
+
+	~Defragmenter() override;
+};
+
+} // namespace myvk
+
+#endif
@@ -19,6 +19,10 @@ public:
 	                                       const std::vector<VkDescriptorSetLayoutBinding> &bindings,
 	                                       VkDescriptorSetLayoutCreateFlags flags = 0);
 	static Ptr<DescriptorSetLayout> Create(const Ptr<Device> &device, const DescriptorBindingFlagGroup &binding_flags);
+	// Returns an existing layout with identical bindings and flags if one is alive
+	static Ptr<DescriptorSetLayout> CreateCached(const Ptr<Device> &device,
+	                                             const std::vector<VkDescriptorSetLayoutBinding> &bindings,
+	                                             VkDescriptorSetLayoutCreateFlags flags = 0);
 
 	VkDescriptorSetLayout GetHandle() const { return m_descriptor_set_layout; }
 
@@ -1,6 +1,7 @@
 #ifndef MYVK_DEVICE_HPP
 #define MYVK_DEVICE_HPP
 
+#include "ObjectCache.hpp"
 #include "PhysicalDevice.hpp"
 #include "Ptr.hpp"
 #include "QueueSelector.hpp"
@@ -12,6 +13,17 @@
 
 namespace myvk {
 
+class RenderPass;
+class ImagelessFramebuffer;
+class Sampler;
+class ImageView;
+class ShaderModule;
+class DescriptorSetLayout;
+class PipelineLayout;
+class GraphicsPipeline;
+class GraphicsPipelineLibrary;
+class ComputePipeline;
+
 class Device : public Base {
 private:
 	Ptr<PhysicalDevice> m_physical_device_ptr;
@@ -20,6 +32,18 @@ private:
 	VkDevice m_device{VK_NULL_HANDLE};
 	VkPipelineCache m_pipeline_cache{VK_NULL_HANDLE};
 	VmaAllocator m_allocator{VK_NULL_HANDLE}, m_dev_addr_allocator{VK_NULL_HANDLE};
+	bool m_graphics_pipeline_library{false}, m_memory_budget{false};
+
+	mutable ObjectCache<RenderPass> m_render_pass_cache;
+	mutable ObjectCache<ImagelessFramebuffer> m_imageless_framebuffer_cache;
+	mutable ObjectCache<Sampler> m_sampler_cache;
+	mutable ObjectCache<ImageView> m_image_view_cache;
+	mutable ObjectCache<ShaderModule> m_shader_module_cache;
+	mutable ObjectCache<DescriptorSetLayout> m_descriptor_set_layout_cache;
+	mutable ObjectCache<PipelineLayout> m_pipeline_layout_cache;
+	mutable ObjectCache<GraphicsPipeline> m_graphics_pipeline_cache;
+	mutable ObjectCache<GraphicsPipelineLibrary> m_graphics_pipeline_library_cache;
+	mutable ObjectCache<ComputePipeline> m_compute_pipeline_cache;
 
 	VkResult create_device(const std::vector<VkDeviceQueueCreateInfo> &queue_create_infos,
 	                       const std::vector<const char *> &extensions, const PhysicalDeviceFeatures &features);
@@ -36,9 +60,35 @@ public:
 	inline const Ptr<PhysicalDevice> &GetPhysicalDevicePtr() const { return m_physical_device_ptr; }
 	inline VkDevice GetHandle() const { return m_device; }
 	inline const PhysicalDeviceFeatures &GetEnabledFeatures() const { return m_features; }
+	// True if VK_EXT_graphics_pipeline_library is enabled and its feature is chained to the device features
+	inline bool IsGraphicsPipelineLibraryEnabled() const { return m_graphics_pipeline_library; }
+	// True if VK_EXT_memory_budget is enabled, the allocators then report the driver's heap usages and budgets
+	inline bool IsMemoryBudgetEnabled() const { return m_memory_budget; }
+
+	// Used by the CreateCached() functions of the cached objects
+	inline ObjectCache<RenderPass> &GetRenderPassCache() const { return m_render_pass_cache; }
+	inline ObjectCache<ImagelessFramebuffer> &GetImagelessFramebufferCache() const {
+		return m_imageless_framebuffer_cache;
+	}
+	inline ObjectCache<Sampler> &GetSamplerCache() const { return m_sampler_cache; }
+	inline ObjectCache<ImageView> &GetImageViewCache() const { return m_image_view_cache; }
+	inline ObjectCache<ShaderModule> &GetShaderModuleCache() const { return m_shader_module_cache; }
+	inline ObjectCache<DescriptorSetLayout> &GetDescriptorSetLayoutCache() const {
+		return m_descriptor_set_layout_cache;
+	}
+	inline ObjectCache<PipelineLayout> &GetPipelineLayoutCache() const { return m_pipeline_layout_cache; }
+	inline ObjectCache<GraphicsPipeline> &GetGraphicsPipelineCache() const { return m_graphics_pipeline_cache; }
+	inline ObjectCache<GraphicsPipelineLibrary> &GetGraphicsPipelineLibraryCache() const {
+		return m_graphics_pipeline_library_cache;
+	}
+	inline ObjectCache<ComputePipeline> &GetComputePipelineCache() const { return m_compute_pipeline_cache; }
 
 	VkResult WaitIdle() const;
 
+	// Requires VK_EXT_debug_utils, returns VK_ERROR_EXTENSION_NOT_PRESENT otherwise
+	inline static bool IsDebugUtilsAvailable() { return vkSetDebugUtilsObjectNameEXT; }
+	VkResult SetObjectName(VkObjectType object_type, uint64_t object_handle, const char *name) const;
+
 	~Device() override;
 };
 } // namespace myvk
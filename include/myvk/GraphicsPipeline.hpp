@@ -15,11 +15,13 @@ struct GraphicsPipelineState;
 struct GraphicsPipelineShaderModules {
 	Ptr<ShaderModule> vert, tesc, tese, geom, frag;
 	std::vector<VkPipelineShaderStageCreateInfo> GetShaderStages() const;
+	void AppendCacheKey(CacheKey *p_key) const;
 };
 
 class GraphicsPipeline : public PipelineBase {
 private:
 	Ptr<RenderPass> m_render_pass_ptr;
+	GraphicsPipelineShaderModules m_shader_modules; // Kept alive for cached pipelines
 
 public:
 	static Ptr<GraphicsPipeline> Create(const Ptr<PipelineLayout> &pipeline_layout, const Ptr<RenderPass> &render_pass,
@@ -30,6 +32,12 @@ public:
 	                                    const GraphicsPipelineState &pipeline_state, uint32_t subpass);
 	static Ptr<GraphicsPipeline> Create(const Ptr<PipelineLayout> &pipeline_layout, const Ptr<RenderPass> &render_pass,
 	                                    const VkGraphicsPipelineCreateInfo &create_info);
+	// Returns an existing pipeline with the same layout, render pass, subpass, shaders (including specialization)
+	// and canonical state if one is alive, states with pNext chains are not cached
+	static Ptr<GraphicsPipeline> CreateCached(const Ptr<PipelineLayout> &pipeline_layout,
+	                                          const Ptr<RenderPass> &render_pass,
+	                                          const GraphicsPipelineShaderModules &shader_modules,
+	                                          const GraphicsPipelineState &pipeline_state, uint32_t subpass);
 
 	VkPipelineBindPoint GetBindPoint() const override { return VK_PIPELINE_BIND_POINT_GRAPHICS; }
 
@@ -107,6 +115,19 @@ struct GraphicsPipelineState {
 	} m_dynamic_state{};
 
 	void PopGraphicsPipelineCreateInfo(VkGraphicsPipelineCreateInfo *info) const;
+
+	inline static constexpr VkGraphicsPipelineLibraryFlagsEXT kAllLibraryParts =
+	    VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT |
+	    VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT |
+	    VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT |
+	    VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT;
+
+	// Canonical serialization of the states used by the given pipeline library parts,
+	// disabled states and state overridden by dynamic state are ignored
+	// Returns false if a create info has a pNext chain (such states never compare equal)
+	bool AppendCacheKey(CacheKey *p_key, VkGraphicsPipelineLibraryFlagsEXT parts = kAllLibraryParts) const;
+	std::size_t GetHash() const;
+	bool operator==(const GraphicsPipelineState &r) const;
 };
 } // namespace myvk
 
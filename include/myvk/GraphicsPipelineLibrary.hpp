@@ -0,0 +1,61 @@
+#ifndef MYVK_GRAPHICS_PIPELINE_LIBRARY_HPP
+#define MYVK_GRAPHICS_PIPELINE_LIBRARY_HPP
+
+#include "GraphicsPipeline.hpp"
+
+#include <future>
+
+namespace myvk {
+
+// One part of a graphics pipeline built with VK_EXT_graphics_pipeline_library,
+// parts are cached separately by the states they consume
+class GraphicsPipelineLibrary : public PipelineBase {
+private:
+	VkGraphicsPipelineLibraryFlagBitsEXT m_part{};
+	Ptr<RenderPass> m_render_pass_ptr;
+	GraphicsPipelineShaderModules m_shader_modules;
+
+public:
+	// Only the shader modules of the part's stages are used
+	static Ptr<GraphicsPipelineLibrary> CreateCached(VkGraphicsPipelineLibraryFlagBitsEXT part,
+	                                                 const Ptr<PipelineLayout> &pipeline_layout,
+	                                                 const Ptr<RenderPass> &render_pass,
+	                                                 const GraphicsPipelineShaderModules &shader_modules,
+	                                                 const GraphicsPipelineState &pipeline_state, uint32_t subpass);
+
+	inline VkGraphicsPipelineLibraryFlagBitsEXT GetPart() const { return m_part; }
+	VkPipelineBindPoint GetBindPoint() const override { return VK_PIPELINE_BIND_POINT_GRAPHICS; }
+
+	~GraphicsPipelineLibrary() override = default;
+};
+
+// A graphics pipeline fast-linked from cached libraries, optionally re-linked with link time optimization
+// on a background thread. GetPipelinePtr() switches to the optimized pipeline once it is ready.
+// Falls back to a monolithic (cached) GraphicsPipeline if the device has no graphics pipeline library support.
+class LinkedGraphicsPipeline : public DeviceObjectBase {
+private:
+	std::array<Ptr<GraphicsPipelineLibrary>, 4> m_library_ptrs;
+	Ptr<GraphicsPipeline> m_pipeline_ptr, m_optimized_pipeline_ptr;
+	std::future<Ptr<GraphicsPipeline>> m_optimized_future;
+
+public:
+	static Ptr<LinkedGraphicsPipeline> Create(const Ptr<PipelineLayout> &pipeline_layout,
+	                                          const Ptr<RenderPass> &render_pass,
+	                                          const GraphicsPipelineShaderModules &shader_modules,
+	                                          const GraphicsPipelineState &pipeline_state, uint32_t subpass,
+	                                          bool background_optimize = true);
+
+	// Both the fast-linked and the optimized pipelines stay alive until this object is destroyed,
+	// so command buffers recorded with either remain valid
+	const Ptr<GraphicsPipeline> &GetPipelinePtr();
+	inline bool IsLinked() const { return m_library_ptrs[0] != nullptr; }
+	inline bool IsOptimized() const { return m_optimized_pipeline_ptr != nullptr; }
+
+	const Ptr<Device> &GetDevicePtr() const override { return m_pipeline_ptr->GetDevicePtr(); }
+
+	~LinkedGraphicsPipeline() override = default;
+};
+
+} // namespace myvk
+
+#endif
@@ -11,6 +11,13 @@ private:
 
 	VmaAllocation m_allocation{VK_NULL_HANDLE};
 
+	// Kept to recreate the image when its allocation is moved, pNext and queue families are dropped
+	VkImageCreateInfo m_create_info{};
+	std::vector<uint32_t> m_queue_families;
+	bool m_movable{false};
+
+	friend class Defragmenter;
+
 public:
 	static Ptr<Image> Create(const Ptr<Device> &device, const VkImageCreateInfo &create_info,
 	                         VmaAllocationCreateFlags allocation_flags = 0,
@@ -29,6 +36,8 @@ public:
 	                                  VkFormat format, VkImageUsageFlags usage,
 	                                  const std::vector<Ptr<Queue>> &access_queue = {});
 
+	inline VmaAllocation GetAllocationHandle() const { return m_allocation; }
+
 	const Ptr<Device> &GetDevicePtr() const override { return m_device_ptr; }
 
 	~Image() override;
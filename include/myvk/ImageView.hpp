@@ -18,6 +18,12 @@ private:
 public:
 	static Ptr<ImageView> Create(const Ptr<ImageBase> &image, const VkImageViewCreateInfo &create_info);
 
+	// Returns an existing view of the same image with identical create info if one is alive,
+	// create infos with pNext chains other than VkImageViewUsageCreateInfo are not cached
+	static Ptr<ImageView> CreateCached(const Ptr<ImageBase> &image, const VkImageViewCreateInfo &create_info);
+
+	// The following helpers are cached
+
 	static Ptr<ImageView> Create(const Ptr<ImageBase> &image, VkImageViewType view_type, VkFormat format,
 	                             VkImageAspectFlags aspect_mask, uint32_t base_mip_level = 0, uint32_t level_count = 1,
 	                             uint32_t base_array_layer = 0, uint32_t layer_count = 1,
@@ -22,6 +22,12 @@ public:
 	static Ptr<ImagelessFramebuffer> Create(const Ptr<RenderPass> &render_pass,
 	                                        const std::vector<Ptr<ImageBase>> &template_images);
 
+	// Returns an existing framebuffer of the same render pass, attachment infos, extent and layers if one is alive
+	static Ptr<ImagelessFramebuffer>
+	CreateCached(const Ptr<RenderPass> &render_pass,
+	             const std::vector<VkFramebufferAttachmentImageInfo> &attachment_image_infos, const VkExtent2D &extent,
+	             uint32_t layers = 1);
+
 	~ImagelessFramebuffer() override = default;
 };
 } // namespace myvk
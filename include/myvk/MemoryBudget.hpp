@@ -0,0 +1,63 @@
+#ifndef MYVK_MEMORY_BUDGET_HPP
+#define MYVK_MEMORY_BUDGET_HPP
+
+#include "Device.hpp"
+#include "DeviceObjectBase.hpp"
+
+#include <functional>
+#include <vector>
+
+namespace myvk {
+
+// Tracks the usage of each memory heap against its budget with vmaGetHeapBudgets() over both device allocators
+// With VK_EXT_memory_budget enabled, usages and budgets come from the driver and account for the whole process and
+// other applications, otherwise only the allocators' own memory blocks are counted against 80% of the heap sizes
+class MemoryBudget : public DeviceObjectBase {
+public:
+	enum class Pressure : uint8_t { kNormal, kHigh, kCritical, kOverBudget };
+	struct Thresholds {
+		float high{0.8f}, critical{0.95f}; // Fractions of the budget
+		float release{0.05f};              // A pressure only drops once the usage is this far below its threshold
+	};
+	struct HeapState {
+		VkDeviceSize usage{}, budget{};
+		Pressure pressure{Pressure::kNormal};
+		bool device_local{};
+	};
+	// Called by Update() for each heap whose pressure changed, the only way heap pressure is reported
+	using Callback = std::function<void(uint32_t heap_index, const HeapState &state, Pressure prev_pressure)>;
+
+private:
+	Ptr<Device> m_device_ptr;
+	Thresholds m_thresholds{};
+	std::vector<HeapState> m_heap_states;
+	std::vector<Callback> m_callbacks;
+	uint32_t m_frame_index{};
+
+public:
+	static Ptr<MemoryBudget> Create(const Ptr<Device> &device, const Thresholds &thresholds);
+	inline static Ptr<MemoryBudget> Create(const Ptr<Device> &device) { return Create(device, Thresholds{}); }
+
+	// Refetches the budgets, call it once per frame
+	void Update();
+
+	// Pressure of a heap previously at prev_pressure, rising as soon as a threshold is reached and dropping with the
+	// release margin, so that a usage hovering around a threshold does not flip it every frame
+	static Pressure GetPressure(VkDeviceSize usage, VkDeviceSize budget, const Thresholds &thresholds,
+	                            Pressure prev_pressure = Pressure::kNormal);
+	// The highest pressure of the device-local heaps
+	Pressure GetPressure() const;
+	inline const std::vector<HeapState> &GetHeapStates() const { return m_heap_states; }
+
+	inline void AddCallback(Callback callback) { m_callbacks.push_back(std::move(callback)); }
+	inline void SetThresholds(const Thresholds &thresholds) { m_thresholds = thresholds; }
+	inline const Thresholds &GetThresholds() const { return m_thresholds; }
+
+	inline const Ptr<Device> &GetDevicePtr() const override { return m_device_ptr; }
+
+	~MemoryBudget() override = default;
+};
+
+} // namespace myvk
+
+#endif
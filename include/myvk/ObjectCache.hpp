@@ -0,0 +1,109 @@
+#ifndef MYVK_OBJECT_CACHE_HPP
+#define MYVK_OBJECT_CACHE_HPP
+
+#include "Ptr.hpp"
+
+#include <algorithm>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+
+namespace myvk {
+
+// Normalized byte representation of a create info, built field by field (no struct padding)
+class CacheKey {
+private:
+	std::string m_data;
+
+public:
+	template <typename T>
+	    requires std::is_arithmetic_v<T> || std::is_enum_v<T> || std::is_pointer_v<T>
+	inline CacheKey &operator<<(T value) {
+		m_data.append(reinterpret_cast<const char *>(&value), sizeof(T));
+		return *this;
+	}
+	inline CacheKey &Append(const void *p_data, std::size_t size) {
+		*this << size;
+		m_data.append(static_cast<const char *>(p_data), size);
+		return *this;
+	}
+	template <typename T, typename Func> inline CacheKey &AppendArray(const T *p_array, uint32_t count, Func &&func) {
+		*this << count;
+		for (uint32_t i = 0; i < count; ++i)
+			func(*this, p_array[i]);
+		return *this;
+	}
+
+	inline std::size_t GetSize() const { return m_data.size(); }
+	inline bool operator==(const CacheKey &r) const { return m_data == r.m_data; }
+	struct Hash {
+		inline std::size_t operator()(const CacheKey &key) const noexcept {
+			return std::hash<std::string_view>{}(key.m_data);
+		}
+	};
+};
+
+// Thread-safe content-addressed cache of shared objects
+// Entries are weak, an object is destroyed once its last user releases it and the entry is swept later
+template <typename T> class ObjectCache {
+private:
+	inline static constexpr std::size_t kMinSweepSize = 64;
+
+	mutable std::mutex m_mutex;
+	std::unordered_map<CacheKey, std::weak_ptr<T>, CacheKey::Hash> m_map;
+	std::size_t m_sweep_size{kMinSweepSize};
+
+	inline void sweep() {
+		std::erase_if(m_map, [](const auto &it) { return it.second.expired(); });
+		m_sweep_size = std::max(kMinSweepSize, m_map.size() * 2);
+	}
+
+public:
+	// create_func() runs without the lock so that objects can be created in parallel,
+	// if several threads create the same object the first one inserted is returned to all of them
+	template <typename CreateFunc> inline Ptr<T> GetOrCreate(CacheKey &&key, CreateFunc &&create_func) {
+		{
+			std::scoped_lock lock{m_mutex};
+			auto it = m_map.find(key);
+			if (it != m_map.end())
+				if (Ptr<T> ptr = it->second.lock())
+					return ptr;
+		}
+
+		Ptr<T> ptr = create_func();
+		if (!ptr)
+			return nullptr;
+
+		std::scoped_lock lock{m_mutex};
+		auto it = m_map.find(key);
+		if (it != m_map.end()) {
+			if (Ptr<T> winner = it->second.lock())
+				return winner;
+			it->second = ptr;
+		} else {
+			if (m_map.size() >= m_sweep_size)
+				sweep();
+			m_map.emplace(std::move(key), ptr);
+		}
+		return ptr;
+	}
+	inline std::size_t GetSize() const {
+		std::scoped_lock lock{m_mutex};
+		return m_map.size();
+	}
+	inline void Sweep() {
+		std::scoped_lock lock{m_mutex};
+		sweep();
+	}
+	inline void Clear() {
+		std::scoped_lock lock{m_mutex};
+		m_map.clear();
+		m_sweep_size = kMinSweepSize;
+	}
+};
+
+} // namespace myvk
+
+#endif
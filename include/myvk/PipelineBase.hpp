@@ -4,16 +4,38 @@
 #include "DeviceObjectBase.hpp"
 #include "PipelineLayout.hpp"
 #include "volk.h"
+#include <chrono>
 #include <memory>
+#include <vector>
 
 namespace myvk {
+// VkPipelineCreationFeedback of a pipeline, plus the CPU time spent in vkCreate*Pipelines
+struct PipelineCreationFeedback {
+	struct Stage {
+		VkShaderStageFlagBits stage;
+		bool valid, cache_hit;
+		uint64_t duration_ns;
+	};
+	bool valid{};     // False if the implementation provided no feedback
+	bool cache_hit{}; // Found in the Device pipeline cache without compilation
+	uint64_t duration_ns{}, wall_time_ns{};
+	std::chrono::steady_clock::time_point end_time{}; // When vkCreate*Pipelines returned
+	std::vector<Stage> stages;
+};
+
 class PipelineBase : public DeviceObjectBase {
 protected:
 	Ptr<PipelineLayout> m_pipeline_layout_ptr;
 	VkPipeline m_pipeline{VK_NULL_HANDLE};
+	PipelineCreationFeedback m_creation_feedback;
+
+	// Create m_pipeline with VkPipelineCreationFeedbackCreateInfo chained to create_info
+	VkResult create_pipeline(VkGraphicsPipelineCreateInfo create_info);
+	VkResult create_pipeline(VkComputePipelineCreateInfo create_info);
 
 public:
 	VkPipeline GetHandle() const { return m_pipeline; }
+	inline const PipelineCreationFeedback &GetCreationFeedback() const { return m_creation_feedback; }
 
 	virtual VkPipelineBindPoint GetBindPoint() const = 0;
 
@@ -3,6 +3,7 @@
 
 #include "DescriptorSetLayout.hpp"
 #include "DeviceObjectBase.hpp"
+#include "ShaderModule.hpp"
 
 #include "volk.h"
 
@@ -21,6 +22,18 @@ public:
 	static Ptr<PipelineLayout> Create(const Ptr<Device> &device,
 	                                  const std::vector<Ptr<DescriptorSetLayout>> &descriptor_layouts,
 	                                  const std::vector<VkPushConstantRange> &push_constant_ranges);
+	// Returns an existing layout with the same set layouts and push constant ranges if one is alive
+	static Ptr<PipelineLayout> CreateCached(const Ptr<Device> &device,
+	                                        const std::vector<Ptr<DescriptorSetLayout>> &descriptor_layouts,
+	                                        const std::vector<VkPushConstantRange> &push_constant_ranges);
+	// Derives a cached layout from the reflections of the shader modules. Non-null entries of descriptor_layouts
+	// replace the reflected set of the same index (e.g. a render graph pass's GetVkDescriptorSetLayout() as set 0).
+	// Push constants are merged into one range visible to every stage that declares them.
+	// Returns nullptr if a module has no reflection, the stages disagree on a binding,
+	// or a reflected binding is a runtime array (pass its set layout explicitly instead)
+	static Ptr<PipelineLayout> CreateReflected(const Ptr<Device> &device,
+	                                           const std::vector<Ptr<ShaderModule>> &shader_modules,
+	                                           const std::vector<Ptr<DescriptorSetLayout>> &descriptor_layouts = {});
 
 	VkPipelineLayout GetHandle() const { return m_pipeline_layout; }
 
@@ -44,6 +44,9 @@ public:
 	std::mutex &GetMutex() const { return m_unique_queue_ptr->m_mutex; }
 
 	VkResult WaitIdle() const;
+
+	// Submits under the queue mutex
+	VkResult Submit2(const VkSubmitInfo2 &submit_info, VkFence fence = VK_NULL_HANDLE) const;
 };
 
 class Surface;
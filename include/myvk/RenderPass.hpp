@@ -25,6 +25,11 @@ public:
 	static Ptr<RenderPass> Create(const Ptr<Device> &device, const RenderPassState &state);
 	static Ptr<RenderPass> Create(const Ptr<Device> &device, const RenderPassState2 &state);
 
+	// Returns an existing render pass with identical create info if one is alive,
+	// create infos with unrecognized pNext chains are not cached
+	static Ptr<RenderPass> CreateCached(const Ptr<Device> &device, const VkRenderPassCreateInfo2 &create_info);
+	static Ptr<RenderPass> CreateCached(const Ptr<Device> &device, const RenderPassState2 &state);
+
 	VkRenderPass GetHandle() const { return m_render_pass; }
 
 	const Ptr<Device> &GetDevicePtr() const override { return m_device_ptr; }
@@ -13,6 +13,12 @@ private:
 public:
 	static Ptr<Sampler> Create(const Ptr<Device> &device, const VkSamplerCreateInfo &create_info);
 
+	// Returns an existing sampler with identical create info if one is alive,
+	// create infos with pNext chains other than VkSamplerReductionModeCreateInfo are not cached
+	static Ptr<Sampler> CreateCached(const Ptr<Device> &device, const VkSamplerCreateInfo &create_info);
+
+	// The following helpers are cached
+
 	static Ptr<Sampler> Create(const Ptr<Device> &device, VkFilter filter, VkSamplerAddressMode address_mode,
 	                           VkSamplerMipmapMode mipmap_mode = VK_SAMPLER_MIPMAP_MODE_LINEAR,
 	                           float max_lod = VK_LOD_CLAMP_NONE, bool request_anisotropy = false, float max_anisotropy = 1.0f);
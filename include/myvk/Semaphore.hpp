@@ -23,6 +23,31 @@ public:
 	~Semaphore() override;
 };
 
+class TimelineSemaphore : public DeviceObjectBase {
+private:
+	Ptr<Device> m_device_ptr;
+
+	VkSemaphore m_semaphore{VK_NULL_HANDLE};
+
+public:
+	static Ptr<TimelineSemaphore> Create(const Ptr<Device> &device, uint64_t initial_value = 0);
+
+	VkSemaphore GetHandle() const { return m_semaphore; }
+
+	const Ptr<Device> &GetDevicePtr() const override { return m_device_ptr; }
+
+	uint64_t GetValue() const;
+
+	VkResult Wait(uint64_t value, uint64_t timeout = UINT64_MAX) const;
+
+	VkResult Signal(uint64_t value) const;
+
+	VkSemaphoreSubmitInfo GetSubmitInfo(uint64_t value,
+	                                    VkPipelineStageFlags2 stages = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT) const;
+
+	~TimelineSemaphore() override;
+};
+
 class SemaphoreGroup {
 private:
 	std::vector<VkSemaphore> m_semaphores;
@@ -2,6 +2,7 @@
 #define MYVK_SHADER_MODULE_HPP
 
 #include "DeviceObjectBase.hpp"
+#include "ShaderReflection.hpp"
 #include "volk.h"
 #include <memory>
 
@@ -9,7 +10,9 @@ namespace myvk {
 class ShaderModule : public DeviceObjectBase {
 private:
 	Ptr<Device> m_device_ptr;
+	Ptr<ShaderModule> m_owner_ptr; // Cached module owning m_shader_module, if shared
 	VkShaderModule m_shader_module{VK_NULL_HANDLE};
+	std::optional<ShaderReflection> m_reflection;
 
 	std::vector<uint32_t> m_specialization_data;
 	std::vector<VkSpecializationMapEntry> m_specialization_entries;
@@ -25,8 +28,13 @@ private:
 
 public:
 	static Ptr<ShaderModule> Create(const Ptr<Device> &device, const uint32_t *code, uint32_t code_size);
+	// Shares the VkShaderModule of an existing module with identical SPIR-V if one is alive,
+	// the returned object is the caller's own, so its specializations are not seen by other users
+	static Ptr<ShaderModule> CreateCached(const Ptr<Device> &device, const uint32_t *code, uint32_t code_size);
 
 	VkShaderModule GetHandle() const { return m_shader_module; }
+	// Reflection of the first entry point, empty if the SPIR-V could not be parsed
+	inline const std::optional<ShaderReflection> &GetReflection() const { return m_reflection; }
 
 	template <typename T> inline void AddSpecialization(uint32_t constant_id, T value) {
 		static_assert(sizeof(T) == sizeof(uint32_t));
@@ -48,6 +56,8 @@ public:
 
 	VkPipelineShaderStageCreateInfo GetPipelineShaderStageCreateInfo(VkShaderStageFlagBits stage,
 	                                                                 VkPipelineShaderStageCreateFlags flags = 0) const;
+	// Appends the module handle, entry point and current specialization values
+	void AppendCacheKey(CacheKey *p_key, VkShaderStageFlagBits stage, VkPipelineShaderStageCreateFlags flags = 0) const;
 
 	~ShaderModule() override;
 };
@@ -0,0 +1,68 @@
+#ifndef MYVK_SHADER_REFLECTION_HPP
+#define MYVK_SHADER_REFLECTION_HPP
+
+#include "volk.h"
+
+#include <array>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace myvk {
+
+// Interface of a SPIR-V entry point, parsed directly from the binary
+class ShaderReflection {
+public:
+	inline static constexpr uint32_t kNoSpecId = -1;
+
+	struct Binding {
+		uint32_t set, binding;
+		VkDescriptorType descriptor_type;
+		uint32_t descriptor_count; // 0 for runtime arrays
+	};
+	struct SpecConstant {
+		uint32_t constant_id;
+		uint32_t size;          // In bytes, booleans are 4 bytes (VkBool32)
+		uint64_t default_value; // Bit pattern of the default value
+	};
+	struct VertexInput {
+		uint32_t location;
+		VkFormat format;
+	};
+
+private:
+	VkShaderStageFlagBits m_stage{};
+	std::string m_entry_point;
+	std::vector<Binding> m_bindings;
+	std::optional<VkPushConstantRange> m_push_constant_range;
+	std::vector<SpecConstant> m_spec_constants;
+	std::array<uint32_t, 3> m_workgroup_size{};
+	std::array<uint32_t, 3> m_workgroup_size_spec_ids{kNoSpecId, kNoSpecId, kNoSpecId};
+	std::vector<VertexInput> m_vertex_inputs;
+
+	friend class ShaderReflectionParser;
+
+public:
+	// code_size is in bytes, returns std::nullopt if the binary is malformed or has no entry point,
+	// only the first entry point is reflected if entry_point is nullptr
+	static std::optional<ShaderReflection> Reflect(const uint32_t *code, std::size_t code_size,
+	                                               const char *entry_point = nullptr);
+
+	inline VkShaderStageFlagBits GetStage() const { return m_stage; }
+	inline const std::string &GetEntryPoint() const { return m_entry_point; }
+	// Sorted by (set, binding)
+	inline const std::vector<Binding> &GetBindings() const { return m_bindings; }
+	// Covers all push constant members, stageFlags is the stage of the entry point
+	inline const std::optional<VkPushConstantRange> &GetPushConstantRange() const { return m_push_constant_range; }
+	// Sorted by constant_id
+	inline const std::vector<SpecConstant> &GetSpecConstants() const { return m_spec_constants; }
+	// Zero for non-compute-like stages, dimensions given by specialization constants report their default values
+	inline const std::array<uint32_t, 3> &GetWorkgroupSize() const { return m_workgroup_size; }
+	inline const std::array<uint32_t, 3> &GetWorkgroupSizeSpecIds() const { return m_workgroup_size_spec_ids; }
+	// Vertex stage only, built-in inputs are excluded, sorted by location
+	inline const std::vector<VertexInput> &GetVertexInputs() const { return m_vertex_inputs; }
+};
+
+} // namespace myvk
+
+#endif
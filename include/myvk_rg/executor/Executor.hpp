@@ -3,17 +3,47 @@
 #define MYVK_RG_DEFAULT_EXECUTOR_HPP
 
 #include <myvk/CommandBuffer.hpp>
+#include <myvk/MemoryBudget.hpp>
 #include <myvk_rg/interface/Object.hpp>
 #include <myvk_rg/interface/Pass.hpp>
 #include <myvk_rg/interface/Resource.hpp>
 
+#include "Profiler.hpp"
+#include "TransientHeap.hpp"
+
+#include <span>
+
 namespace myvk_rg::executor {
 
+// Validation barriers induced by memory aliasing in the last compile
+struct AliasBarrierStats {
+	std::size_t barrier_count{}; // Ordered pairs of aliased resources, each orders the later one after the earlier
+	double serialization{};      // Sum of 1 / (pass distance) over the pairs, 1 for adjacent passes
+};
+
 class Executor final : public interface::ObjectBase {
 private:
 	struct CompileInfo;
 	uint8_t m_compile_flags{};
 	CompileInfo *m_p_compile_info;
+	myvk::UPtr<Profiler> m_profiler;
+	std::map<interface::GlobalKey, PipelineCreationRecord> m_pipeline_creation_records;
+	std::size_t m_plan_cache_capacity{2};
+	myvk::Ptr<TransientHeap> m_transient_heap;
+	uint64_t m_transient_heap_generation{};
+	VkDeviceSize m_buffer_pack_max_size{};
+	bool m_alias_mapped_buffers{false};
+	float m_alias_barrier_weight{};
+	uint32_t m_resource_pool_max_idle_frames{};
+	myvk::Ptr<myvk::MemoryBudget> m_memory_budget;
+	myvk::MemoryBudget::Pressure m_memory_pressure{myvk::MemoryBudget::Pressure::kNormal};
+	bool m_debug_utils{false}, m_vk_objects_named{false};
+
+	// Settings in effect under the current memory pressure
+	float get_alias_barrier_weight() const;
+	std::size_t get_plan_cache_capacity() const;
+	uint32_t get_resource_pool_max_idle_frames() const;
+	void apply_memory_pressure();
 
 	void compile(const interface::RenderGraphBase *p_render_graph, const myvk::Ptr<myvk::Queue> &queue);
 
@@ -25,6 +55,76 @@ public:
 	void CmdExecute(const interface::RenderGraphBase *p_render_graph,
 	                const myvk::Ptr<myvk::CommandBuffer> &command_buffer);
 
+	// GPU Profiling (Opt-in)
+	void EnableProfiler(uint32_t frame_latency, std::size_t window = 128,
+	                    VkQueryPipelineStatisticFlags statistic_flags = 0);
+	void DisableProfiler();
+	inline const Profiler *GetProfiler() const { return m_profiler.get(); }
+
+	// Pipeline creation statistics of each pass (always collected)
+	inline const std::map<interface::GlobalKey, PipelineCreationRecord> &GetPipelineCreationRecords() const {
+		return m_pipeline_creation_records;
+	}
+	inline void ClearPipelineCreationRecords() { m_pipeline_creation_records.clear(); }
+
+	// LRU of compiled allocation layouts keyed by the graph's structural hash, a recompile with a matching hash
+	// (e.g. toggling a pass back off) skips planning and draws the images, buffers and memory it used back from the
+	// resource pool. Cached entries hold no device memory, 0 disables the cache.
+	void SetPlanCacheCapacity(std::size_t capacity);
+	inline std::size_t GetPlanCacheCapacity() const { return m_plan_cache_capacity; }
+	uint64_t GetStructuralHash() const;
+
+	// Images, buffers and memory released by a recompile are pooled and reused by later compiles with matching
+	// create infos, so resizes and toggles do not reallocate everything. Pooled objects unused for more than the
+	// given number of frames are destroyed.
+	void SetResourcePoolMaxIdleFrames(uint32_t frames);
+	uint32_t GetResourcePoolMaxIdleFrames() const;
+
+	// Place the aliased device-local resources in a heap shared with other executors (nullptr for private memory)
+	// The executions of executors sharing a heap must not overlap on the GPU, a full memory barrier is recorded
+	// before each execution to order them
+	void SetTransientHeap(const myvk::Ptr<TransientHeap> &transient_heap);
+	inline const myvk::Ptr<TransientHeap> &GetTransientHeap() const { return m_transient_heap; }
+
+	// Internal buffers up to max_size are packed into shared backing VkBuffers (one per usage set and memory) at
+	// aligned offsets, GetBufferView() then returns the backing buffer with an offset. 0 (default) disables packing.
+	void SetBufferPackMaxSize(VkDeviceSize max_size);
+	inline VkDeviceSize GetBufferPackMaxSize() const { return m_buffer_pack_max_size; }
+
+	// Mapped buffers of disjoint lifetimes share memory, host-written ones from the beginning of the execution and
+	// host-read ones until its end. Their data must then be written before each execution and read back once it
+	// completes. false (default) gives each mapped buffer its own memory, which keeps its content across executions.
+	void SetMappedBufferAliasing(bool alias);
+	inline bool IsMappedBufferAliasing() const { return m_alias_mapped_buffers; }
+
+	// Weight of the serialization of aliasing barriers against memory growth (in units of the placed resource's
+	// size) when placing aliased resources. 0 (default) only minimizes the memory footprint.
+	void SetAliasBarrierWeight(float weight);
+	inline float GetAliasBarrierWeight() const { return m_alias_barrier_weight; }
+	AliasBarrierStats GetAliasBarrierStats() const;
+
+	// Adapts to the pressure of the device-local heaps of the budget (nullptr to ignore it), which its owner updates
+	// each frame. Under high pressure, aliasing ignores the barrier weight, the plan cache keeps one entry and pooled
+	// objects live one idle frame; under critical pressure or overcommit, the plan cache and the pool keep nothing.
+	// Placement only changes with a nonzero barrier weight, as the default one already minimizes memory; mapped
+	// aliasing and buffer packing are left to the caller since they change what the passes may assume.
+	void SetMemoryBudget(const myvk::Ptr<myvk::MemoryBudget> &memory_budget);
+	inline const myvk::Ptr<myvk::MemoryBudget> &GetMemoryBudget() const { return m_memory_budget; }
+	inline myvk::MemoryBudget::Pressure GetMemoryPressure() const { return m_memory_pressure; }
+
+	// Compile plan (pass groups, barriers and memory placements) of the last compile, tagged with the structural
+	// hash, empty before the first compile. A loaded plan replaces scheduling and memory placement from the next
+	// compile on, as long as the structural hash matches.
+	std::vector<uint8_t> SerializePlan() const;
+	bool LoadPlan(std::span<const uint8_t> data); // Returns false if the data is malformed
+
+	// VK_EXT_debug_utils labels and object names (Opt-in)
+	inline void SetDebugUtilsEnabled(bool enable) {
+		m_debug_utils = enable && myvk::Device::IsDebugUtilsAvailable();
+		m_vk_objects_named = false;
+	}
+	inline bool IsDebugUtilsEnabled() const { return m_debug_utils; }
+
 	static const myvk::Ptr<myvk::ImageView> &GetVkImageView(const interface::ManagedImage *p_managed_image);
 	static const myvk::Ptr<myvk::ImageView> &GetVkImageView(const interface::CombinedImage *p_combined_image);
 	static const myvk_rg::interface::BufferView &GetBufferView(const interface::ManagedBuffer *p_managed_buffer);
@@ -0,0 +1,134 @@
+#pragma once
+#ifndef MYVK_RG_DEFAULT_PROFILER_HPP
+#define MYVK_RG_DEFAULT_PROFILER_HPP
+
+#include <myvk/CommandBuffer.hpp>
+#include <myvk/PipelineBase.hpp>
+#include <myvk/QueryPool.hpp>
+#include <myvk_rg/interface/Key.hpp>
+
+#include <bit>
+#include <map>
+#include <vector>
+
+namespace myvk_rg::executor {
+
+enum class ProfileScope : uint8_t {
+	kPass,       // A pass (subpass of a render pass, or a compute / transfer pass), keyed by the pass
+	kRenderPass, // A whole render pass instance (including load / store operations), keyed by its first subpass
+	kBarrier,    // A pipeline barrier batch, keyed by the first subpass of the following pass (empty key if post)
+};
+inline constexpr std::size_t kProfileScopeCount = 3;
+
+struct ProfileStats {
+	uint32_t sample_count{};
+	double last_ms{}, average_ms{}, min_ms{}, max_ms{}, p50_ms{}, p95_ms{}, p99_ms{};
+};
+
+// Rolling window of GPU time samples (in milliseconds)
+class ProfileRecord {
+private:
+	std::vector<double> m_samples;
+	std::size_t m_window{}, m_next{};
+	double m_last{};
+
+public:
+	inline explicit ProfileRecord(std::size_t window = 128) : m_window{window} { m_samples.reserve(window); }
+	void Push(double ms);
+	inline void Clear() {
+		m_samples.clear();
+		m_next = 0;
+	}
+	inline uint32_t GetSampleCount() const { return m_samples.size(); }
+	double GetAverage() const;
+	double GetPercentile(double percentile) const;
+	ProfileStats GetStats() const;
+};
+
+// Pipeline statistics of the last read back frame
+class PipelineStatistics {
+private:
+	VkQueryPipelineStatisticFlags m_flags{};
+	std::vector<uint64_t> m_values; // One value per bit set in m_flags, in bit order
+
+public:
+	inline PipelineStatistics() = default;
+	inline PipelineStatistics(VkQueryPipelineStatisticFlags flags, std::vector<uint64_t> &&values)
+	    : m_flags{flags}, m_values{std::move(values)} {}
+	inline VkQueryPipelineStatisticFlags GetFlags() const { return m_flags; }
+	inline const std::vector<uint64_t> &GetValues() const { return m_values; }
+	// Returns 0 if the statistic is not queried
+	uint64_t Get(VkQueryPipelineStatisticFlagBits statistic) const;
+};
+
+// Pipeline (re-)creations of a pass, the CPU time covers the whole CreatePipeline() call of the pass
+// A pipeline that existed before the call (returned by an object cache) is counted as reused, with an empty feedback
+struct PipelineCreationRecord {
+	uint32_t creation_count{}, cache_hit_count{}, reuse_count{};
+	double total_ms{}, max_ms{}, last_ms{};
+	bool last_reused{};
+	myvk::PipelineCreationFeedback last_feedback; // Of the pipeline created by the last CreatePipeline()
+};
+
+// GPU timestamp profiler, results are read back frame_latency frames later without waiting on the GPU
+class Profiler {
+private:
+	inline static constexpr uint32_t kNoQuery = -1;
+	struct ScopeQuery {
+		ProfileScope scope;
+		interface::GlobalKey key;
+		uint32_t statistics_query;
+	};
+	struct Frame {
+		myvk::Ptr<myvk::QueryPool> query_pool, statistics_query_pool;
+		uint32_t statistics_query_count{};
+		uint64_t trace_begin_us{};
+		std::vector<ScopeQuery> scope_queries; // Scope #i writes query (2i, 2i + 1), scope #0 is the whole frame
+		bool pending{false};
+	};
+
+	std::vector<Frame> m_frames;
+	uint32_t m_frame_index{};
+	Frame *m_p_frame{};
+
+	uint64_t m_timestamp_mask{};
+	double m_timestamp_period{};
+	std::size_t m_window;
+	VkQueryPipelineStatisticFlags m_statistic_flags;
+	uint32_t m_statistic_count;
+
+	std::map<interface::GlobalKey, ProfileRecord> m_records[kProfileScopeCount];
+	ProfileRecord m_frame_record;
+	std::map<interface::GlobalKey, PipelineStatistics> m_pass_statistics;
+	std::vector<uint64_t> m_results;
+
+	bool fetch_frame(Frame *p_frame);
+
+public:
+	// statistic_flags: pipeline statistics queried for each pass (0 to disable)
+	explicit Profiler(uint32_t frame_latency, std::size_t window = 128,
+	                  VkQueryPipelineStatisticFlags statistic_flags = 0);
+
+	// Used by the executor
+	void CmdBeginFrame(const myvk::Ptr<myvk::CommandBuffer> &command_buffer, uint32_t max_scope_count);
+	uint32_t CmdBeginScope(const myvk::Ptr<myvk::CommandBuffer> &command_buffer, ProfileScope scope,
+	                       const interface::GlobalKey &key);
+	void CmdEndScope(const myvk::Ptr<myvk::CommandBuffer> &command_buffer, uint32_t scope_id);
+	void CmdEndFrame(const myvk::Ptr<myvk::CommandBuffer> &command_buffer);
+	inline bool IsFrameActive() const { return m_p_frame; }
+
+	void Clear();
+	inline const std::map<interface::GlobalKey, ProfileRecord> &GetRecords(ProfileScope scope) const {
+		return m_records[static_cast<std::size_t>(scope)];
+	}
+	// Time from the start of the first barrier to the end of the post barriers
+	inline const ProfileRecord &GetFrameRecord() const { return m_frame_record; }
+	inline VkQueryPipelineStatisticFlags GetStatisticFlags() const { return m_statistic_flags; }
+	inline const std::map<interface::GlobalKey, PipelineStatistics> &GetPassStatistics() const {
+		return m_pass_statistics;
+	}
+};
+
+} // namespace myvk_rg::executor
+
+#endif
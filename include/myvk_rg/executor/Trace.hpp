@@ -0,0 +1,82 @@
+#pragma once
+#ifndef MYVK_RG_DEFAULT_TRACE_HPP
+#define MYVK_RG_DEFAULT_TRACE_HPP
+
+#include <myvk_rg/interface/Key.hpp>
+
+#include <atomic>
+#include <cinttypes>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+
+namespace myvk_rg::executor {
+
+// Records CPU / GPU spans into per-thread buffers and writes them as Chrome trace JSON (chrome://tracing, Perfetto)
+// Appending a span is lock-free, only Flush() and the first span of each thread take a lock
+class TraceRecorder {
+public:
+	enum class Track : uint8_t { kCPU, kGPU };
+
+private:
+	inline static std::atomic_bool s_enabled{false};
+
+	static void add_span(const char *category, std::string &&name, uint64_t begin_us, uint64_t end_us, Track track);
+
+public:
+	inline static bool IsEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+	inline static void Enable() { s_enabled.store(true, std::memory_order_relaxed); }
+	inline static void Disable() { s_enabled.store(false, std::memory_order_relaxed); }
+
+	// Microseconds since the recorder epoch
+	static uint64_t GetTimeUs();
+
+	inline static void AddSpan(const char *category, std::string name, uint64_t begin_us, uint64_t end_us,
+	                           Track track = Track::kCPU) {
+		if (IsEnabled())
+			add_span(category, std::move(name), begin_us, end_us, track);
+	}
+
+	// Writes all spans recorded since the last flush to a JSON file and releases them
+	static bool Flush(const char *filename);
+	// Same, to an open file which is left open
+	static void Flush(std::FILE *p_file);
+
+	// Number of per-thread buffers, those of exited threads are freed by the next Flush()
+	static std::size_t GetThreadBufferCount();
+};
+
+// RAII CPU span, does nothing if the recorder is disabled when constructed
+class TraceSpan {
+private:
+	const char *m_category{};
+	std::string m_name;
+	uint64_t m_begin_us{};
+	bool m_enabled;
+
+public:
+	inline TraceSpan(const char *category, const char *name) : m_enabled{TraceRecorder::IsEnabled()} {
+		if (m_enabled) {
+			m_category = category;
+			m_name = name;
+			m_begin_us = TraceRecorder::GetTimeUs();
+		}
+	}
+	inline TraceSpan(const char *category, const interface::GlobalKey &key) : m_enabled{TraceRecorder::IsEnabled()} {
+		if (m_enabled) {
+			m_category = category;
+			m_name = key.Format();
+			m_begin_us = TraceRecorder::GetTimeUs();
+		}
+	}
+	inline ~TraceSpan() {
+		if (m_enabled)
+			TraceRecorder::AddSpan(m_category, std::move(m_name), m_begin_us, TraceRecorder::GetTimeUs());
+	}
+	TraceSpan(const TraceSpan &) = delete;
+	TraceSpan &operator=(const TraceSpan &) = delete;
+};
+
+} // namespace myvk_rg::executor
+
+#endif
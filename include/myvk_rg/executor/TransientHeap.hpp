@@ -0,0 +1,61 @@
+#pragma once
+#ifndef MYVK_RG_DEFAULT_TRANSIENT_HEAP_HPP
+#define MYVK_RG_DEFAULT_TRANSIENT_HEAP_HPP
+
+#include <myvk/Device.hpp>
+
+#include <map>
+
+namespace myvk_rg_executor {
+class RGMemoryAllocation;
+class ResourcePool;
+class VkAllocation;
+} // namespace myvk_rg_executor
+
+namespace myvk_rg::executor {
+
+// Device-local memory shared by the aliased (transient) resources of several executors
+// Bound executors place the resources of each memory bucket (memory type and tiling) from offset 0 of the bucket's
+// allocation, so their executions must be serialized on the queue timeline (e.g. recorded in order into one command
+// buffer or submitted to one queue)
+class TransientHeap final {
+private:
+	struct Bucket {
+		myvk::Ptr<myvk_rg_executor::RGMemoryAllocation> alloc_ptr;
+		// Merged requirements of all the executors the allocation served
+		VkMemoryRequirements requirements{};
+		VmaAllocationCreateInfo create_info{};
+	};
+	std::map<uint32_t, Bucket> m_buckets;
+	uint64_t m_generation{};
+
+	// Returns the shared allocation of the bucket, reallocated from resource_pool if it cannot hold the requirements
+	// (the previous one returns to the pool it came from), or nullptr if the requirements cannot share memory with
+	// the others
+	myvk::Ptr<myvk_rg_executor::RGMemoryAllocation> acquire(const myvk::Ptr<myvk::Device> &device, uint32_t bucket,
+	                                                        const VkMemoryRequirements &memory_requirements,
+	                                                        const VmaAllocationCreateInfo &create_info,
+	                                                        myvk_rg_executor::ResourcePool &resource_pool);
+
+	friend class myvk_rg_executor::VkAllocation;
+
+public:
+	static myvk::Ptr<TransientHeap> Create();
+
+	// Total size of the current allocations, 0 if no executor is compiled yet
+	VkDeviceSize GetSize() const;
+	inline std::size_t GetBucketCount() const { return m_buckets.size(); }
+	// Increased on each reallocation, bound executors recompile their allocation to follow it
+	inline uint64_t GetGeneration() const { return m_generation; }
+
+	// Merges the requirements of another executor into *p_requirements and *p_create_info, the heap is reallocated
+	// with the merged ones so that executors disagreeing on alignment or memory types do not reallocate it in turn.
+	// Returns false if they cannot share memory.
+	static bool MergeRequirements(VkMemoryRequirements *p_requirements, VmaAllocationCreateInfo *p_create_info,
+	                              const VkMemoryRequirements &memory_requirements,
+	                              const VmaAllocationCreateInfo &create_info);
+};
+
+} // namespace myvk_rg::executor
+
+#endif
@@ -35,11 +35,15 @@ class AliasBase {
 private:
 	AliasClass m_class{};
 	GlobalKey m_source;
+	KeyInterner::Ref m_source_ref, m_source_pass_ref;
 
 public:
 	inline virtual ~AliasBase() = default;
 	inline AliasBase() = default;
-	inline AliasBase(AliasClass alias_class, GlobalKey key) : m_class{alias_class}, m_source{std::move(key)} {}
+	inline AliasBase(AliasClass alias_class, GlobalKey key, KeyInterner::Ref source_ref,
+	                 KeyInterner::Ref source_pass_ref)
+	    : m_class{alias_class}, m_source{std::move(key)}, m_source_ref{source_ref},
+	      m_source_pass_ref{source_pass_ref} {}
 
 	inline ResourceType GetType() const { return GetResourceType(m_class); }
 	inline AliasState GetState() const { return GetAliasState(m_class); }
@@ -48,6 +52,10 @@ public:
 	inline explicit operator bool() const { return !Empty(); }
 
 	inline const GlobalKey &GetSourceKey() const { return m_source; }
+	// Interned keys of the source when the alias was made, the source may have been removed since
+	inline KeyInterner::Ref GetSourceRef() const { return m_source_ref; }
+	// Key of the source pass, only valid for output aliases
+	inline KeyInterner::Ref GetSourcePassRef() const { return m_source_pass_ref; }
 
 	template <typename Visitor>
 	inline std::invoke_result_t<Visitor, const RawImageAlias *> Visit(Visitor &&visitor) const;
@@ -59,8 +67,9 @@ class ImageAliasBase : public AliasBase {
 public:
 	inline ~ImageAliasBase() override = default;
 	inline ImageAliasBase() = default;
-	inline ImageAliasBase(AliasState state, GlobalKey source)
-	    : AliasBase(MakeAliasClass(ResourceType::kImage, state), std::move(source)) {}
+	inline ImageAliasBase(AliasState state, GlobalKey source, KeyInterner::Ref source_ref,
+	                      KeyInterner::Ref source_pass_ref)
+	    : AliasBase(MakeAliasClass(ResourceType::kImage, state), std::move(source), source_ref, source_pass_ref) {}
 
 	inline ResourceType GetType() const { return ResourceType::kImage; }
 
@@ -98,8 +107,9 @@ class BufferAliasBase : public AliasBase {
 public:
 	inline ~BufferAliasBase() override = default;
 	inline BufferAliasBase() = default;
-	inline BufferAliasBase(AliasState state, GlobalKey source)
-	    : AliasBase(MakeAliasClass(ResourceType::kBuffer, state), std::move(source)) {}
+	inline BufferAliasBase(AliasState state, GlobalKey source, KeyInterner::Ref source_ref,
+	                       KeyInterner::Ref source_pass_ref)
+	    : AliasBase(MakeAliasClass(ResourceType::kBuffer, state), std::move(source), source_ref, source_pass_ref) {}
 
 	inline ResourceType GetType() const { return ResourceType::kBuffer; }
 
@@ -0,0 +1,193 @@
+#pragma once
+#ifndef MYVK_RG_FLAT_POOL_MAP_HPP
+#define MYVK_RG_FLAT_POOL_MAP_HPP
+
+#include "Key.hpp"
+
+#include <bit>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace myvk_rg::interface {
+
+// Open-addressing (linear probing) hash map from PoolKey to Value
+// Entries live in fixed-size chunks and never move, so pointers to keys and values stay valid until erased
+template <typename Value> class FlatPoolMap {
+public:
+	using Entry = std::pair<const PoolKey, Value>;
+
+private:
+	inline static constexpr uint32_t kChunkSize = 32, kMinBucketCount = 16;
+	inline static constexpr uint32_t kEmpty = -1, kTombstone = -2;
+
+	struct Slot {
+		alignas(Entry) std::byte storage[sizeof(Entry)];
+		bool alive;
+		inline Entry *Get() { return std::launder(reinterpret_cast<Entry *>(storage)); }
+		inline const Entry *Get() const { return std::launder(reinterpret_cast<const Entry *>(storage)); }
+	};
+	struct Bucket {
+		uint32_t slot{kEmpty}, tag{};
+	};
+
+	std::vector<std::unique_ptr<Slot[]>> m_chunks;
+	std::vector<uint32_t> m_free_slots;
+	uint32_t m_slot_count{};
+	std::vector<Bucket> m_buckets;
+	uint32_t m_size{}, m_tombstone_count{};
+
+	inline Slot &get_slot(uint32_t slot) { return m_chunks[slot / kChunkSize][slot % kChunkSize]; }
+	inline const Slot &get_slot(uint32_t slot) const { return m_chunks[slot / kChunkSize][slot % kChunkSize]; }
+
+	inline static uint32_t get_tag(std::size_t hash) { return uint32_t(uint64_t(hash) >> 32u); }
+
+	// Index of the bucket holding the key, or kEmpty
+	inline uint32_t find_bucket(const PoolKey &key, std::size_t hash) const {
+		if (m_buckets.empty())
+			return kEmpty;
+		uint32_t mask = m_buckets.size() - 1, tag = get_tag(hash);
+		for (uint32_t i = hash & mask;; i = (i + 1) & mask) {
+			const Bucket &bucket = m_buckets[i];
+			if (bucket.slot == kEmpty)
+				return kEmpty;
+			if (bucket.slot != kTombstone && bucket.tag == tag && get_slot(bucket.slot).Get()->first == key)
+				return i;
+		}
+	}
+	inline void insert_bucket(uint32_t slot, std::size_t hash) {
+		uint32_t mask = m_buckets.size() - 1;
+		uint32_t i = hash & mask;
+		while (m_buckets[i].slot != kEmpty && m_buckets[i].slot != kTombstone)
+			i = (i + 1) & mask;
+		if (m_buckets[i].slot == kTombstone)
+			--m_tombstone_count;
+		m_buckets[i] = {.slot = slot, .tag = get_tag(hash)};
+	}
+	inline void rehash(uint32_t min_size) {
+		uint32_t bucket_count = std::max(kMinBucketCount, std::bit_ceil(min_size * 2u));
+		m_buckets.assign(bucket_count, Bucket{});
+		m_tombstone_count = 0;
+		for (uint32_t slot = 0; slot < m_slot_count; ++slot)
+			if (get_slot(slot).alive)
+				insert_bucket(slot, PoolKey::Hash{}(get_slot(slot).Get()->first));
+	}
+	inline uint32_t alloc_slot() {
+		if (!m_free_slots.empty()) {
+			uint32_t slot = m_free_slots.back();
+			m_free_slots.pop_back();
+			return slot;
+		}
+		if (m_slot_count % kChunkSize == 0)
+			m_chunks.push_back(std::make_unique<Slot[]>(kChunkSize));
+		return m_slot_count++;
+	}
+
+public:
+	template <bool Const> class Iterator {
+	private:
+		using Map = std::conditional_t<Const, const FlatPoolMap, FlatPoolMap>;
+		Map *m_p_map{};
+		uint32_t m_slot{};
+
+		inline void skip() {
+			while (m_slot < m_p_map->m_slot_count && !m_p_map->get_slot(m_slot).alive)
+				++m_slot;
+		}
+
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = Entry;
+		using difference_type = std::ptrdiff_t;
+		using pointer = std::conditional_t<Const, const Entry *, Entry *>;
+		using reference = std::conditional_t<Const, const Entry &, Entry &>;
+
+		inline Iterator() = default;
+		inline Iterator(Map *p_map, uint32_t slot) : m_p_map{p_map}, m_slot{slot} { skip(); }
+		inline reference operator*() const { return *m_p_map->get_slot(m_slot).Get(); }
+		inline pointer operator->() const { return m_p_map->get_slot(m_slot).Get(); }
+		inline Iterator &operator++() {
+			++m_slot;
+			skip();
+			return *this;
+		}
+		inline Iterator operator++(int) {
+			Iterator it = *this;
+			++*this;
+			return it;
+		}
+		inline bool operator==(const Iterator &r) const { return m_slot == r.m_slot; }
+	};
+
+	inline FlatPoolMap() = default;
+	inline ~FlatPoolMap() { Clear(); }
+	FlatPoolMap(const FlatPoolMap &) = delete;
+	FlatPoolMap &operator=(const FlatPoolMap &) = delete;
+
+	inline Iterator<false> begin() { return {this, 0}; }
+	inline Iterator<false> end() { return {this, m_slot_count}; }
+	inline Iterator<true> begin() const { return {this, 0}; }
+	inline Iterator<true> end() const { return {this, m_slot_count}; }
+
+	inline std::size_t GetSize() const { return m_size; }
+	inline bool Empty() const { return m_size == 0; }
+
+	inline Entry *Find(const PoolKey &key) {
+		uint32_t bucket = find_bucket(key, PoolKey::Hash{}(key));
+		return bucket == kEmpty ? nullptr : get_slot(m_buckets[bucket].slot).Get();
+	}
+	inline const Entry *Find(const PoolKey &key) const {
+		uint32_t bucket = find_bucket(key, PoolKey::Hash{}(key));
+		return bucket == kEmpty ? nullptr : get_slot(m_buckets[bucket].slot).Get();
+	}
+	// Returns the entry of the key (value-initialized if new) and whether it is inserted
+	inline std::pair<Entry *, bool> Emplace(const PoolKey &key) {
+		std::size_t hash = PoolKey::Hash{}(key);
+		if (uint32_t bucket = find_bucket(key, hash); bucket != kEmpty)
+			return {get_slot(m_buckets[bucket].slot).Get(), false};
+
+		if ((m_size + m_tombstone_count + 1) * 2 > m_buckets.size())
+			rehash(m_size + 1);
+
+		uint32_t slot = alloc_slot();
+		Slot &s = get_slot(slot);
+		new (s.storage) Entry(std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple());
+		s.alive = true;
+		insert_bucket(slot, hash);
+		++m_size;
+		return {s.Get(), true};
+	}
+	inline bool Erase(const PoolKey &key) {
+		uint32_t bucket = find_bucket(key, PoolKey::Hash{}(key));
+		if (bucket == kEmpty)
+			return false;
+		uint32_t slot = m_buckets[bucket].slot;
+		m_buckets[bucket].slot = kTombstone;
+		++m_tombstone_count;
+		--m_size;
+
+		Slot &s = get_slot(slot);
+		s.alive = false;
+		s.Get()->~Entry();
+		m_free_slots.push_back(slot);
+		return true;
+	}
+	inline void Clear() {
+		for (uint32_t slot = 0; slot < m_slot_count; ++slot)
+			if (Slot &s = get_slot(slot); s.alive) {
+				s.alive = false;
+				s.Get()->~Entry();
+			}
+		m_chunks.clear();
+		m_free_slots.clear();
+		m_buckets.clear();
+		m_slot_count = m_size = m_tombstone_count = 0;
+	}
+};
+
+} // namespace myvk_rg::interface
+
+#endif
@@ -9,6 +9,7 @@
 #include <string>
 #include <string_view>
 #include <tuple>
+#include <unordered_map>
 #include <vector>
 
 namespace myvk_rg::interface {
@@ -64,9 +65,18 @@ public:
 	inline bool operator!=(const PoolKey &r) const { return _32_ != r._32_; }
 	struct Hash {
 		inline std::size_t operator()(PoolKey const &r) const noexcept {
-			return std::get<0>(r._32_) ^ std::get<1>(r._32_) ^ std::get<2>(r._32_) ^ std::get<3>(r._32_);
-			// return ((std::get<0>(r._32_) * 37 + std::get<1>(r._32_)) * 37 + std::get<2>(r._32_)) * 37 +
-			//        std::get<3>(r._32_);
+			// Mix every word (splitmix64 finalizer), plain XOR collides on permuted or repeated words
+			const auto mix = [](uint64_t x) {
+				x = (x ^ (x >> 30u)) * 0xbf58476d1ce4e5b9ull;
+				x = (x ^ (x >> 27u)) * 0x94d049bb133111ebull;
+				return x ^ (x >> 31u);
+			};
+			uint64_t hash = 0;
+			hash = mix(hash + std::get<0>(r._32_) + 0x9e3779b97f4a7c15ull);
+			hash = mix(hash + std::get<1>(r._32_) + 0x9e3779b97f4a7c15ull);
+			hash = mix(hash + std::get<2>(r._32_) + 0x9e3779b97f4a7c15ull);
+			hash = mix(hash + std::get<3>(r._32_) + 0x9e3779b97f4a7c15ull);
+			return hash;
 		}
 	};
 };
@@ -90,10 +100,19 @@ public:
 		return m_keys.empty() ? GlobalKey{} : GlobalKey{{m_keys.begin(), m_keys.end() - 1}};
 	}
 	inline bool Empty() const { return m_keys.empty(); }
+	inline const std::vector<PoolKey> &GetPoolKeys() const { return m_keys; }
 	inline bool operator<(const GlobalKey &r) const { return m_keys < r.m_keys; }
 	inline bool operator>(const GlobalKey &r) const { return m_keys > r.m_keys; }
 	inline bool operator==(const GlobalKey &r) const { return m_keys == r.m_keys; }
 	inline bool operator!=(const GlobalKey &r) const { return m_keys != r.m_keys; }
+	struct Hash {
+		inline std::size_t operator()(GlobalKey const &r) const noexcept {
+			std::size_t hash = r.m_keys.size();
+			for (const PoolKey &key : r.m_keys)
+				hash ^= PoolKey::Hash{}(key) + 0x9e3779b97f4a7c15ull + (hash << 6u) + (hash >> 2u);
+			return hash;
+		}
+	};
 	inline std::string Format() const {
 		auto str =
 		    std::accumulate(m_keys.begin(), m_keys.end(), std::string{}, [](std::string &&f, const PoolKey &key) {
@@ -107,6 +126,84 @@ public:
 };
 static_assert(std::is_move_constructible_v<GlobalKey>);
 
+// Assigns each live GlobalKey a dense ID, so that executors can index flat arrays instead of searching by key
+// Keys are interned as (parent ID, PoolKey), so no GlobalKey is built. The ID of a key is released when its last
+// object is destroyed and reused with a new generation, references to a released key can then be resolved by Find()
+class KeyInterner {
+public:
+	using IDType = uint32_t;
+	inline constexpr static const IDType kInvalidID = std::numeric_limits<IDType>::max();
+
+	struct Ref {
+		IDType id{kInvalidID};
+		uint32_t generation{};
+		inline bool operator==(const Ref &r) const = default;
+	};
+
+private:
+	struct Key {
+		IDType parent_id;
+		PoolKey pool_key;
+		inline bool operator==(const Key &r) const = default;
+		struct Hash {
+			inline std::size_t operator()(const Key &key) const noexcept {
+				return PoolKey::Hash{}(key.pool_key) ^ (std::size_t(key.parent_id) * 0x9e3779b97f4a7c15ull);
+			}
+		};
+	};
+	struct Entry {
+		Key key;
+		uint32_t generation{}, ref_count{};
+	};
+
+	std::unordered_map<Key, IDType, Key::Hash> m_ids;
+	std::vector<Entry> m_entries; // Indexed by ID
+	std::vector<IDType> m_free_ids;
+
+public:
+	// parent_id is kInvalidID for top-level keys, every Intern() is paired with a Release()
+	inline Ref Intern(IDType parent_id, const PoolKey &pool_key) {
+		auto [it, inserted] = m_ids.try_emplace({parent_id, pool_key}, kInvalidID);
+		if (inserted) {
+			if (m_free_ids.empty()) {
+				it->second = m_entries.size();
+				m_entries.push_back({.key = it->first});
+			} else {
+				it->second = m_free_ids.back();
+				m_free_ids.pop_back();
+				Entry &entry = m_entries[it->second];
+				entry.key = it->first;
+				++entry.generation;
+			}
+		}
+		Entry &entry = m_entries[it->second];
+		++entry.ref_count;
+		return {it->second, entry.generation};
+	}
+	inline void Retain(IDType id) { ++m_entries[id].ref_count; }
+	inline void Release(IDType id) {
+		Entry &entry = m_entries[id];
+		if (--entry.ref_count)
+			return;
+		m_ids.erase(entry.key);
+		m_free_ids.push_back(id);
+	}
+	// Current reference of a live key, an invalid Ref if no object holds it
+	inline Ref Find(const GlobalKey &global_key) const {
+		IDType id = kInvalidID;
+		for (const PoolKey &pool_key : global_key.GetPoolKeys()) {
+			auto it = m_ids.find({id, pool_key});
+			if (it == m_ids.end())
+				return {};
+			id = it->second;
+		}
+		return id == kInvalidID ? Ref{} : Ref{id, m_entries[id].generation};
+	}
+	// Upper bound of the IDs, bounded by the peak number of live keys
+	inline IDType GetCount() const { return m_entries.size(); }
+	inline IDType GetLiveCount() const { return m_ids.size(); }
+};
+
 } // namespace myvk_rg::interface
 
 #endif // MYVK_RG_KEY_HPP
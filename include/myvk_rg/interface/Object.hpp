@@ -15,6 +15,7 @@ template <class... Ts> overloaded(Ts...) -> overloaded<Ts...>;
 
 class RenderGraphBase;
 class ObjectBase;
+class ObjectArena;
 struct Parent {
 	const PoolKey *p_pool_key;
 	std::variant<RenderGraphBase *, const ObjectBase *> p_var_parent;
@@ -25,25 +26,32 @@ private:
 	RenderGraphBase *m_p_render_graph{};
 	const ObjectBase *m_p_parent_object{};
 	const PoolKey *m_p_key{};
+	KeyInterner::Ref m_key_ref;
 	mutable void *m_p_executor_info{};
 
+	friend class RenderGraphBase;
+
 public:
-	inline explicit ObjectBase(Parent parent) : m_p_key{parent.p_pool_key} {
-		std::visit(overloaded([this](RenderGraphBase *p_rg) { m_p_render_graph = p_rg; },
-		                      [this](const ObjectBase *p_obj) {
-			                      m_p_render_graph = p_obj->GetRenderGraphPtr();
-			                      m_p_parent_object = p_obj;
-		                      }),
-		           parent.p_var_parent);
-	}
-	inline virtual ~ObjectBase() = default;
+	explicit ObjectBase(Parent parent);
+	virtual ~ObjectBase();
+	// Copies hold the key as well
+	ObjectBase(const ObjectBase &r);
+	ObjectBase &operator=(const ObjectBase &r);
 
 	inline RenderGraphBase *GetRenderGraphPtr() const { return m_p_render_graph; }
 	inline const PoolKey &GetKey() const { return *m_p_key; }
+	// Dense ID of the GlobalKey, interned by the RenderGraph on creation
+	inline KeyInterner::IDType GetKeyID() const { return m_key_ref.id; }
+	inline KeyInterner::Ref GetKeyRef() const { return m_key_ref; }
+	inline KeyInterner::Ref GetParentKeyRef() const {
+		return m_p_parent_object ? m_p_parent_object->GetKeyRef() : KeyInterner::Ref{};
+	}
 	inline GlobalKey GetGlobalKey() const {
 		return m_p_parent_object ? GlobalKey{m_p_parent_object->GetGlobalKey(), *m_p_key} : GlobalKey{*m_p_key};
 	}
 	void EmitEvent(Event event) ;
+	// Arena of the render graph that child objects are constructed in, nullptr without a render graph
+	ObjectArena *GetObjectArenaPtr() const;
 
 	inline void __SetPExecutorInfo(void *p_info) const { m_p_executor_info = p_info; }
 	template <typename T> inline T *__GetPExecutorInfo() const { return (T *)m_p_executor_info; }
@@ -0,0 +1,107 @@
+#pragma once
+#ifndef MYVK_RG_OBJECT_ARENA_HPP
+#define MYVK_RG_OBJECT_ARENA_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace myvk_rg::interface {
+
+// Size-classed free-list allocator for the objects of a render graph, shared by all of its pools
+// Memory is carved from geometrically growing chunks and only returned to the system when the arena is destroyed
+class ObjectArena {
+private:
+	inline static constexpr std::size_t kGranularity = 64, kMaxSize = 1024;
+	inline static constexpr std::size_t kMinChunkSize = 1024, kMaxChunkSize = 65536;
+
+	struct FreeNode {
+		FreeNode *p_next;
+	};
+	std::array<FreeNode *, kMaxSize / kGranularity> m_free_lists{};
+	std::vector<std::unique_ptr<std::byte[]>> m_chunks;
+	std::byte *m_p_begin{}, *m_p_end{};
+	std::size_t m_next_chunk_size{kMinChunkSize};
+
+	inline static constexpr bool use_arena(std::size_t size, std::size_t alignment) {
+		return size <= kMaxSize && alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+	}
+	inline static constexpr std::size_t get_class(std::size_t size) { return (size - 1) / kGranularity; }
+
+public:
+	inline ObjectArena() = default;
+	ObjectArena(const ObjectArena &) = delete;
+	ObjectArena &operator=(const ObjectArena &) = delete;
+
+	inline void *Allocate(std::size_t size, std::size_t alignment) {
+		if (!use_arena(size, alignment))
+			return ::operator new(size, std::align_val_t{alignment});
+
+		FreeNode *&p_free = m_free_lists[get_class(size)];
+		if (p_free) {
+			void *p_memory = p_free;
+			p_free = p_free->p_next;
+			return p_memory;
+		}
+		std::size_t class_size = (get_class(size) + 1) * kGranularity;
+		if (std::size_t(m_p_end - m_p_begin) < class_size) {
+			// The remaining tail of the previous chunk is dropped
+			m_chunks.push_back(std::make_unique<std::byte[]>(m_next_chunk_size));
+			m_p_begin = m_chunks.back().get();
+			m_p_end = m_p_begin + m_next_chunk_size;
+			m_next_chunk_size = std::min(m_next_chunk_size * 2, kMaxChunkSize);
+		}
+		void *p_memory = m_p_begin;
+		m_p_begin += class_size;
+		return p_memory;
+	}
+	inline void Deallocate(void *p_memory, std::size_t size, std::size_t alignment) {
+		if (!use_arena(size, alignment)) {
+			::operator delete(p_memory, std::align_val_t{alignment});
+			return;
+		}
+		FreeNode *&p_free = m_free_lists[get_class(size)];
+		p_free = new (p_memory) FreeNode{p_free};
+	}
+	inline std::size_t GetChunkCount() const { return m_chunks.size(); }
+
+	// Deleter of objects constructed in an arena (or with plain new when p_arena is nullptr)
+	struct Deleter {
+		ObjectArena *p_arena{};
+		uint32_t size{}, alignment{};
+
+		template <typename T> inline void operator()(T *ptr) const {
+			if (p_arena == nullptr) {
+				delete ptr;
+				return;
+			}
+			// A base pointer may not point to the beginning of the allocation
+			void *p_memory;
+			if constexpr (std::is_polymorphic_v<T>)
+				p_memory = dynamic_cast<void *>(ptr);
+			else
+				p_memory = ptr;
+			ptr->~T();
+			p_arena->Deallocate(p_memory, size, alignment);
+		}
+	};
+	template <typename T, typename... Args> inline std::unique_ptr<T, Deleter> Make(Args &&...args) {
+		void *p_memory = Allocate(sizeof(T), alignof(T));
+		T *ptr;
+		try {
+			ptr = new (p_memory) T(std::forward<Args>(args)...);
+		} catch (...) {
+			Deallocate(p_memory, sizeof(T), alignof(T));
+			throw;
+		}
+		return std::unique_ptr<T, Deleter>{ptr, Deleter{.p_arena = this, .size = sizeof(T), .alignment = alignof(T)}};
+	}
+};
+
+} // namespace myvk_rg::interface
+
+#endif
@@ -1,7 +1,9 @@
 #ifndef MYVK_RG_POOL_HPP
 #define MYVK_RG_POOL_HPP
 
+#include "FlatPoolMap.hpp"
 #include "Object.hpp"
+#include "ObjectArena.hpp"
 
 #include <cinttypes>
 #include <cstdio>
@@ -9,7 +11,6 @@
 #include <optional>
 #include <tuple>
 #include <type_traits>
-#include <unordered_map>
 #include <variant>
 
 namespace myvk_rg::interface {
@@ -19,7 +20,7 @@ template <typename Type> class Value {
 private:
 	inline constexpr static bool kUPtr = !std::is_final_v<Type>;
 
-	mutable std::conditional_t<kUPtr, std::unique_ptr<Type>, std::optional<Type>> m_value;
+	mutable std::conditional_t<kUPtr, std::unique_ptr<Type, ObjectArena::Deleter>, std::optional<Type>> m_value;
 
 public:
 	template <typename TypeToCons>
@@ -31,18 +32,24 @@ public:
 	             std::is_same_v<Type, TypeToGet>)
 	          : (std::is_base_of_v<TypeToGet, Type> || std::is_same_v<Type, TypeToGet>);
 
+	// Construct the value in p_arena (or with plain new if p_arena is nullptr)
 	template <typename TypeToCons, typename... Args, typename = std::enable_if_t<kCanConstruct<TypeToCons>>>
-	inline TypeToCons *Construct(Args &&...args) {
+	inline TypeToCons *ConstructIn(ObjectArena *p_arena, Args &&...args) {
 		if constexpr (kUPtr) {
-			auto ptr = std::make_unique<TypeToCons>(std::forward<Args>(args)...);
+			auto ptr = p_arena ? p_arena->template Make<TypeToCons>(std::forward<Args>(args)...)
+			                   : std::unique_ptr<TypeToCons, ObjectArena::Deleter>{
+			                         new TypeToCons(std::forward<Args>(args)...)};
 			TypeToCons *ret = ptr.get();
 			m_value = std::move(ptr);
 			return ret;
 		} else {
-			m_value = TypeToCons(std::forward<Args>(args)...);
-			return std::addressof(*m_value);
+			return std::addressof(m_value.emplace(std::forward<Args>(args)...));
 		}
 	}
+	template <typename TypeToCons, typename... Args, typename = std::enable_if_t<kCanConstruct<TypeToCons>>>
+	inline TypeToCons *Construct(Args &&...args) {
+		return ConstructIn<TypeToCons>(nullptr, std::forward<Args>(args)...);
+	}
 	template <typename TypeToGet = Type, typename = std::enable_if_t<kCanGet<TypeToGet>>>
 	inline TypeToGet *Get() const {
 		Type *ptr = std::addressof(*m_value);
@@ -85,18 +92,22 @@ public:
 	template <typename TypeToGet> inline constexpr static bool kCanGet = CanGet<TypeToGet>();
 
 	template <typename TypeToCons, typename... Args, typename = std::enable_if_t<kCanConstruct<TypeToCons>>>
-	inline TypeToCons *Construct(Args &&...args) {
+	inline TypeToCons *ConstructIn(ObjectArena *p_arena, Args &&...args) {
 		constexpr auto kIndex = GetConstructIndex<TypeToCons>();
 		m_variant.template emplace<Value<TypeAt<kIndex>>>();
 		return std::visit(
 		    [&](auto &v) -> TypeToCons * {
 			    if constexpr (std::decay_t<decltype(v)>::template kCanConstruct<TypeToCons>)
-				    return v.template Construct<TypeToCons>(std::forward<Args>(args)...);
+				    return v.template ConstructIn<TypeToCons>(p_arena, std::forward<Args>(args)...);
 			    else
 				    return nullptr;
 		    },
 		    m_variant);
 	}
+	template <typename TypeToCons, typename... Args, typename = std::enable_if_t<kCanConstruct<TypeToCons>>>
+	inline TypeToCons *Construct(Args &&...args) {
+		return ConstructIn<TypeToCons>(nullptr, std::forward<Args>(args)...);
+	}
 	template <typename TypeToGet, typename = std::enable_if_t<kCanGet<TypeToGet>>> inline TypeToGet *Get() const {
 		return std::visit(
 		    [](const auto &v) -> TypeToGet * {
@@ -122,7 +133,7 @@ template <typename... Types> struct WrapperAux<Variant<Types...>> {
 template <typename Type> using Wrapper = typename WrapperAux<Type>::T;
 
 // Pool Data
-template <typename Type> using PoolData = std::unordered_map<PoolKey, Wrapper<Type>, PoolKey::Hash>;
+template <typename Type> using PoolData = FlatPoolMap<Wrapper<Type>>;
 
 template <typename Derived, typename Type> class Pool {
 private:
@@ -136,23 +147,26 @@ protected:
 	inline const PoolData<Type> &GetPoolData() const { return m_data; }
 
 	template <typename TypeToCons, typename... Args> inline TypeToCons *Construct(const PoolKey &key, Args &&...args) {
-		auto it = m_data.emplace(key, Wrapper<Type>{});
+		static_assert(std::is_base_of_v<ObjectBase, Derived>);
+		auto *p_entry = m_data.Emplace(key).first;
+		// Objects of the whole render graph share its arena
+		ObjectArena *p_arena = static_cast<const Derived *>(this)->GetObjectArenaPtr();
 		if constexpr (std::is_base_of_v<ObjectBase, TypeToCons>) {
-			static_assert(std::is_base_of_v<ObjectBase, Derived>);
-			return it.first->second.template Construct<TypeToCons>(
-			    Parent{.p_pool_key = &it.first->first,
+			return p_entry->second.template ConstructIn<TypeToCons>(
+			    p_arena,
+			    Parent{.p_pool_key = &p_entry->first,
 			           .p_var_parent = (ObjectBase *)static_cast<const Derived *>(this)},
 			    std::forward<Args>(args)...);
 		} else
-			return it.first->second.template Construct<TypeToCons>(std::forward<Args>(args)...);
+			return p_entry->second.template ConstructIn<TypeToCons>(p_arena, std::forward<Args>(args)...);
 	}
-	inline bool Exist(const PoolKey &key) const { return m_data.count(key); }
-	inline void Delete(const PoolKey &key) { m_data.erase(key); }
+	inline bool Exist(const PoolKey &key) const { return m_data.Find(key); }
+	inline void Delete(const PoolKey &key) { m_data.Erase(key); }
 	template <typename TypeToGet> inline TypeToGet *Get(const PoolKey &key) const {
-		auto it = m_data.find(key);
-		return it == m_data.end() ? nullptr : it->second.template Get<TypeToGet>();
+		auto *p_entry = m_data.Find(key);
+		return p_entry ? p_entry->second.template Get<TypeToGet>() : nullptr;
 	}
-	inline void Clear() { m_data.clear(); }
+	inline void Clear() { m_data.Clear(); }
 };
 
 } // namespace myvk_rg::interface
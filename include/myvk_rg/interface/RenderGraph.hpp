@@ -21,6 +21,8 @@ private:
 	inline static const interface::PoolKey kEXEKey = {"[EXE]"};
 
 	VkExtent2D m_canvas_size{};
+	ObjectArena m_object_arena; // Child objects are cleared in the destructor body, before the arena goes
+	KeyInterner m_key_interner; // Constructed before any child object (including the executor)
 	myvk::UPtr<executor::Executor> m_executor{};
 	myvk::Ptr<myvk::Device> m_device_ptr;
 
@@ -29,8 +31,17 @@ private:
 public:
 	inline explicit RenderGraphBase(myvk::Ptr<myvk::Device> device_ptr)
 	    : ObjectBase({.p_pool_key = &kRGKey, .p_var_parent = this}), m_device_ptr{std::move(device_ptr)},
-	      m_executor(myvk::MakeUPtr<executor::Executor>(Parent{.p_pool_key = &kEXEKey, .p_var_parent = this})) {}
-	inline ~RenderGraphBase() override = default;
+	      m_executor(myvk::MakeUPtr<executor::Executor>(Parent{.p_pool_key = &kEXEKey, .p_var_parent = this})) {
+		m_key_ref = m_key_interner.Intern(KeyInterner::kInvalidID, kRGKey);
+	}
+	inline ~RenderGraphBase() override {
+		// Child objects release their keys, so they go before the interner
+		PassPool<RenderGraphBase>::Clear();
+		ResourcePool<RenderGraphBase>::Clear();
+		ResultPool<RenderGraphBase>::Clear();
+		m_key_interner.Release(m_key_ref.id);
+		m_key_ref = {};
+	}
 
 	RenderGraphBase(const RenderGraphBase &) = delete;
 	RenderGraphBase &operator=(const RenderGraphBase &) = delete;
@@ -48,6 +59,22 @@ public:
 		return Float(m_canvas_size.width) / Float(m_canvas_size.height);
 	}
 	inline const executor::Executor *GetExecutor() const { return m_executor.get(); }
+	inline const KeyInterner &GetKeyInterner() const { return m_key_interner; }
+
+	// frame_latency: number of frames before the GPU timestamps are read back (at least the frames in flight)
+	// statistic_flags: pipeline statistics queried for each pass (requires pipelineStatisticsQuery)
+	inline void EnableProfiler(uint32_t frame_latency, std::size_t window = 128,
+	                           VkQueryPipelineStatisticFlags statistic_flags = 0) {
+		m_executor->EnableProfiler(frame_latency, window, statistic_flags);
+	}
+	inline void DisableProfiler() { m_executor->DisableProfiler(); }
+	inline const executor::Profiler *GetProfiler() const { return m_executor->GetProfiler(); }
+	// Per-pass pipeline creation cost and cache hits, to find the pipelines worth pre-warming
+	inline const std::map<GlobalKey, executor::PipelineCreationRecord> &GetPipelineCreationRecords() const {
+		return m_executor->GetPipelineCreationRecords();
+	}
+	// Debug labels per pass (group) and object names, requires VK_EXT_debug_utils
+	inline void SetDebugUtilsEnabled(bool enable) { m_executor->SetDebugUtilsEnabled(enable); }
 
 	virtual void PreExecute() const {}
 	void CmdExecute(const myvk::Ptr<myvk::CommandBuffer> &command_buffer) {
@@ -271,6 +271,9 @@ public:
 	}
 	~ManagedBuffer() override = default;
 
+	// Mapped buffers keep their content across executions unless the executor aliases them (see
+	// Executor::SetMappedBufferAliasing). Like other internal resources, each frame in flight needs its own render
+	// graph.
 	void SetMapped(bool mapped) {
 		if (m_mapped != mapped) {
 			m_mapped = mapped;
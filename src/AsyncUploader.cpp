@@ -0,0 +1,218 @@
+#include "myvk/AsyncUploader.hpp"
+
+#include <cstring>
+
+namespace myvk {
+
+Ptr<AsyncUploader> AsyncUploader::Create(const Ptr<Queue> &transfer_queue, const Ptr<Queue> &dst_queue) {
+	auto ret = std::make_shared<AsyncUploader>();
+	ret->m_transfer_queue_ptr = transfer_queue;
+	ret->m_dst_queue_ptr = dst_queue;
+	ret->m_command_pool_ptr = CommandPool::Create(transfer_queue, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+	ret->m_semaphore_ptr = TimelineSemaphore::Create(transfer_queue->GetDevicePtr());
+	if (!ret->m_command_pool_ptr || !ret->m_semaphore_ptr)
+		return nullptr;
+	return ret;
+}
+
+Ptr<Buffer> AsyncUploader::create_staging(const void *data, VkDeviceSize size) const {
+	auto staging =
+	    Buffer::Create(GetDevicePtr(), size,
+	                   VMA_ALLOCATION_CREATE_MAPPED_BIT | VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT,
+	                   VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
+	if (staging)
+		std::memcpy(staging->GetMappedData(), data, size);
+	return staging;
+}
+
+bool AsyncUploader::EnqueueBuffer(const Ptr<BufferBase> &dst_buffer, VkDeviceSize dst_offset, const void *data,
+                                  VkDeviceSize size, const BufferSyncState &dst_state) {
+	auto staging = create_staging(data, size);
+	if (!staging)
+		return false;
+
+	std::scoped_lock lock{m_mutex};
+	m_pending_buffer_uploads.push_back({.staging = std::move(staging),
+	                                    .dst = dst_buffer,
+	                                    .region = {.srcOffset = 0, .dstOffset = dst_offset, .size = size},
+	                                    .dst_state = dst_state});
+	return true;
+}
+
+bool AsyncUploader::EnqueueImage(const Ptr<ImageBase> &dst_image, const VkImageSubresourceLayers &subresource,
+                                 const VkOffset3D &offset, const VkExtent3D &extent, const void *data,
+                                 VkDeviceSize size, const ImageSyncState &dst_state) {
+	auto staging = create_staging(data, size);
+	if (!staging)
+		return false;
+
+	std::scoped_lock lock{m_mutex};
+	m_pending_image_uploads.push_back({.staging = std::move(staging),
+	                                   .dst = dst_image,
+	                                   .region = {.bufferOffset = 0,
+	                                              .bufferRowLength = 0,
+	                                              .bufferImageHeight = 0,
+	                                              .imageSubresource = subresource,
+	                                              .imageOffset = offset,
+	                                              .imageExtent = extent},
+	                                   .dst_state = dst_state});
+	return true;
+}
+
+void AsyncUploader::collect() {
+	uint64_t completed_value = m_semaphore_ptr->GetValue();
+	for (auto &batch : m_batches) {
+		if (batch.completed || batch.value > completed_value)
+			continue;
+		batch.completed = true;
+		batch.command_buffer = nullptr;
+		for (auto &upload : batch.buffer_uploads)
+			upload.staging = nullptr;
+		for (auto &upload : batch.image_uploads)
+			upload.staging = nullptr;
+	}
+	bool transfer_ownership = need_ownership_transfer();
+	while (!m_batches.empty() &&
+	       IsBatchRetired(m_batches.front().completed, m_batches.front().acquired, transfer_ownership))
+		m_batches.pop_front();
+}
+
+uint64_t AsyncUploader::Flush() {
+	std::scoped_lock lock{m_mutex};
+	collect();
+
+	if (m_pending_buffer_uploads.empty() && m_pending_image_uploads.empty())
+		return m_value;
+
+	auto command_buffer = CommandBuffer::Create(m_command_pool_ptr);
+	if (!command_buffer)
+		return m_value;
+	command_buffer->Begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+
+	// Transition images to TRANSFER_DST
+	if (!m_pending_image_uploads.empty()) {
+		std::vector<VkImageMemoryBarrier2> image_barriers;
+		image_barriers.reserve(m_pending_image_uploads.size());
+		for (const auto &upload : m_pending_image_uploads)
+			image_barriers.push_back(upload.dst->GetMemoryBarrier2(
+			    ImageBase::GetCopySubresourceRange(upload.region), VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE,
+			    VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_UNDEFINED,
+			    VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL));
+		command_buffer->CmdPipelineBarrier2({}, {}, image_barriers);
+	}
+
+	for (const auto &upload : m_pending_buffer_uploads)
+		command_buffer->CmdCopy(upload.staging, upload.dst, {upload.region});
+	for (const auto &upload : m_pending_image_uploads)
+		command_buffer->CmdCopy(upload.staging, upload.dst, {upload.region});
+
+	// Release barriers (queue family ownership transfer & layout transition)
+	// The memory dependency to the destination queue is covered by the timeline semaphore
+	{
+		bool transfer_ownership = need_ownership_transfer();
+		uint32_t src_family = transfer_ownership ? m_transfer_queue_ptr->GetFamilyIndex() : VK_QUEUE_FAMILY_IGNORED;
+		uint32_t dst_family = transfer_ownership ? m_dst_queue_ptr->GetFamilyIndex() : VK_QUEUE_FAMILY_IGNORED;
+
+		std::vector<VkBufferMemoryBarrier2> buffer_barriers;
+		std::vector<VkImageMemoryBarrier2> image_barriers;
+		if (transfer_ownership)
+			for (const auto &upload : m_pending_buffer_uploads)
+				buffer_barriers.push_back(GetReleaseBarrier(*upload.dst, upload.region, src_family, dst_family));
+		for (const auto &upload : m_pending_image_uploads)
+			image_barriers.push_back(
+			    GetReleaseBarrier(*upload.dst, upload.region, upload.dst_state, src_family, dst_family));
+		if (!buffer_barriers.empty() || !image_barriers.empty())
+			command_buffer->CmdPipelineBarrier2({}, buffer_barriers, image_barriers);
+	}
+
+	command_buffer->End();
+
+	uint64_t value = m_value + 1;
+	if (command_buffer->Submit2({}, {m_semaphore_ptr->GetSubmitInfo(value)}) != VK_SUCCESS)
+		return m_value;
+	m_value = value;
+
+	m_batches.push_back({.value = value,
+	                     .command_buffer = std::move(command_buffer),
+	                     .buffer_uploads = std::move(m_pending_buffer_uploads),
+	                     .image_uploads = std::move(m_pending_image_uploads)});
+	m_pending_buffer_uploads.clear();
+	m_pending_image_uploads.clear();
+	return value;
+}
+
+uint64_t AsyncUploader::CmdAcquire(const Ptr<CommandBuffer> &dst_command_buffer) {
+	std::scoped_lock lock{m_mutex};
+	collect();
+
+	bool transfer_ownership = need_ownership_transfer();
+	uint32_t src_family = m_transfer_queue_ptr->GetFamilyIndex(), dst_family = m_dst_queue_ptr->GetFamilyIndex();
+
+	uint64_t wait_value = 0;
+	std::vector<VkBufferMemoryBarrier2> buffer_barriers;
+	std::vector<VkImageMemoryBarrier2> image_barriers;
+	for (auto &batch : m_batches) {
+		if (batch.acquired)
+			continue;
+		batch.acquired = true;
+		wait_value = batch.value;
+
+		if (!transfer_ownership)
+			continue;
+		for (const auto &upload : batch.buffer_uploads)
+			buffer_barriers.push_back(
+			    GetAcquireBarrier(*upload.dst, upload.region, upload.dst_state, src_family, dst_family));
+		for (const auto &upload : batch.image_uploads)
+			image_barriers.push_back(
+			    GetAcquireBarrier(*upload.dst, upload.region, upload.dst_state, src_family, dst_family));
+	}
+	if (!buffer_barriers.empty() || !image_barriers.empty())
+		dst_command_buffer->CmdPipelineBarrier2({}, buffer_barriers, image_barriers);
+
+	collect();
+	return wait_value;
+}
+
+VkBufferMemoryBarrier2 AsyncUploader::GetReleaseBarrier(const BufferBase &dst_buffer, const VkBufferCopy &region,
+                                                        uint32_t src_family, uint32_t dst_family) {
+	return dst_buffer.GetMemoryBarrier2(BufferBase::GetCopyDstSubresourceRange(region), VK_PIPELINE_STAGE_2_COPY_BIT,
+	                                    VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE,
+	                                    src_family, dst_family);
+}
+
+VkBufferMemoryBarrier2 AsyncUploader::GetAcquireBarrier(const BufferBase &dst_buffer, const VkBufferCopy &region,
+                                                        const BufferSyncState &dst_state, uint32_t src_family,
+                                                        uint32_t dst_family) {
+	return dst_buffer.GetMemoryBarrier2(BufferBase::GetCopyDstSubresourceRange(region), VK_PIPELINE_STAGE_2_NONE,
+	                                    VK_ACCESS_2_NONE, dst_state.stage_mask, dst_state.access_mask, src_family,
+	                                    dst_family);
+}
+
+VkImageMemoryBarrier2 AsyncUploader::GetReleaseBarrier(const ImageBase &dst_image, const VkBufferImageCopy &region,
+                                                       const ImageSyncState &dst_state, uint32_t src_family,
+                                                       uint32_t dst_family) {
+	return dst_image.GetMemoryBarrier2(ImageBase::GetCopySubresourceRange(region), VK_PIPELINE_STAGE_2_COPY_BIT,
+	                                   VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE,
+	                                   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, dst_state.layout, src_family,
+	                                   dst_family);
+}
+
+VkImageMemoryBarrier2 AsyncUploader::GetAcquireBarrier(const ImageBase &dst_image, const VkBufferImageCopy &region,
+                                                       const ImageSyncState &dst_state, uint32_t src_family,
+                                                       uint32_t dst_family) {
+	return dst_image.GetMemoryBarrier2(ImageBase::GetCopySubresourceRange(region), VK_PIPELINE_STAGE_2_NONE,
+	                                   VK_ACCESS_2_NONE, dst_state.stage_mask, dst_state.access_mask,
+	                                   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, dst_state.layout, src_family,
+	                                   dst_family);
+}
+
+VkResult AsyncUploader::WaitIdle(uint64_t timeout) const {
+	uint64_t value;
+	{
+		std::scoped_lock lock{m_mutex};
+		value = m_value;
+	}
+	return m_semaphore_ptr->Wait(value, timeout);
+}
+
+} // namespace myvk
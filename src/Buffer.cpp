@@ -48,6 +48,13 @@ Ptr<Buffer> Buffer::Create(const Ptr<Device> &device, const VkBufferCreateInfo &
 		return nullptr;
 	ret->m_mapped_ptr = allocation_info.pMappedData;
 
+	ret->m_create_info = new_info;
+	ret->m_create_info.pNext = nullptr;
+	ret->m_create_info.pQueueFamilyIndices = nullptr;
+	ret->m_queue_families = std::move(queue_families);
+	// Device addresses are baked into shader data, so such buffers stay in place
+	ret->m_movable = !create_info.pNext && !(create_info.usage & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT);
+
 	if (ret->get_allocator_handle() == device->GetDeviceAddressAllocatorHandle()) {
 		VkBufferDeviceAddressInfo device_address_info = {.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
 		                                                 .buffer = ret->m_buffer};
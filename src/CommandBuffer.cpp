@@ -85,6 +85,25 @@ VkResult CommandBuffer::Submit(const Ptr<Fence> &fence) const {
 	                     fence ? fence->GetHandle() : VK_NULL_HANDLE);
 }
 
+VkResult CommandBuffer::Submit2(const std::vector<VkSemaphoreSubmitInfo> &wait_semaphore_infos,
+                                const std::vector<VkSemaphoreSubmitInfo> &signal_semaphore_infos,
+                                const Ptr<Fence> &fence) const {
+	VkCommandBufferSubmitInfo command_buffer_info = {};
+	command_buffer_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO;
+	command_buffer_info.commandBuffer = m_command_buffer;
+
+	VkSubmitInfo2 info = {};
+	info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2;
+	info.commandBufferInfoCount = 1;
+	info.pCommandBufferInfos = &command_buffer_info;
+	info.waitSemaphoreInfoCount = wait_semaphore_infos.size();
+	info.pWaitSemaphoreInfos = wait_semaphore_infos.data();
+	info.signalSemaphoreInfoCount = signal_semaphore_infos.size();
+	info.pSignalSemaphoreInfos = signal_semaphore_infos.data();
+
+	return m_command_pool_ptr->GetQueuePtr()->Submit2(info, fence ? fence->GetHandle() : VK_NULL_HANDLE);
+}
+
 VkResult CommandBuffer::Begin(VkCommandBufferUsageFlags usage) const {
 	VkCommandBufferBeginInfo begin_info = {};
 	begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
@@ -450,6 +469,29 @@ void CommandBuffer::CmdWriteTimestamp(VkPipelineStageFlagBits pipeline_stage, co
 	vkCmdWriteTimestamp(m_command_buffer, pipeline_stage, query_pool->GetHandle(), query);
 }
 
+void CommandBuffer::CmdBeginQuery(const Ptr<QueryPool> &query_pool, uint32_t query, VkQueryControlFlags flags) const {
+	vkCmdBeginQuery(m_command_buffer, query_pool->GetHandle(), query, flags);
+}
+
+void CommandBuffer::CmdEndQuery(const Ptr<QueryPool> &query_pool, uint32_t query) const {
+	vkCmdEndQuery(m_command_buffer, query_pool->GetHandle(), query);
+}
+
+void CommandBuffer::CmdBeginDebugLabel(const char *name, const std::array<float, 4> &color) const {
+	if (!vkCmdBeginDebugUtilsLabelEXT)
+		return;
+	VkDebugUtilsLabelEXT label = {};
+	label.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT;
+	label.pLabelName = name;
+	std::copy(color.begin(), color.end(), label.color);
+	vkCmdBeginDebugUtilsLabelEXT(m_command_buffer, &label);
+}
+
+void CommandBuffer::CmdEndDebugLabel() const {
+	if (vkCmdEndDebugUtilsLabelEXT)
+		vkCmdEndDebugUtilsLabelEXT(m_command_buffer);
+}
+
 /*CommandBufferGroup::CommandBufferGroup(const std::vector<Ptr<CommandBuffer>> &command_buffers) {
     Initialize(command_buffers);
 }
@@ -1,5 +1,7 @@
 #include "myvk/ComputePipeline.hpp"
 
+#include <cstring>
+
 namespace myvk {
 
 Ptr<ComputePipeline> ComputePipeline::Create(const Ptr<PipelineLayout> &pipeline_layout,
@@ -10,9 +12,7 @@ Ptr<ComputePipeline> ComputePipeline::Create(const Ptr<PipelineLayout> &pipeline
 	VkComputePipelineCreateInfo new_info = create_info;
 	new_info.layout = pipeline_layout->GetHandle();
 
-	if (vkCreateComputePipelines(pipeline_layout->GetDevicePtr()->GetHandle(),
-	                             pipeline_layout->GetDevicePtr()->GetPipelineCacheHandle(), 1, &new_info, nullptr,
-	                             &ret->m_pipeline) != VK_SUCCESS)
+	if (ret->create_pipeline(new_info) != VK_SUCCESS)
 		return nullptr;
 	return ret;
 }
@@ -27,9 +27,7 @@ Ptr<ComputePipeline> ComputePipeline::Create(const Ptr<PipelineLayout> &pipeline
 	create_info.layout = pipeline_layout->GetHandle();
 	create_info.stage = shader_stage_create_info;
 
-	if (vkCreateComputePipelines(pipeline_layout->GetDevicePtr()->GetHandle(),
-	                             pipeline_layout->GetDevicePtr()->GetPipelineCacheHandle(), 1, &create_info, nullptr,
-	                             &ret->m_pipeline) != VK_SUCCESS)
+	if (ret->create_pipeline(create_info) != VK_SUCCESS)
 		return nullptr;
 	return ret;
 }
@@ -38,4 +36,49 @@ Ptr<ComputePipeline> ComputePipeline::Create(const Ptr<PipelineLayout> &pipeline
                                              const Ptr<ShaderModule> &shader_module) {
 	return Create(pipeline_layout, shader_module->GetPipelineShaderStageCreateInfo(VK_SHADER_STAGE_COMPUTE_BIT));
 }
+
+Ptr<ComputePipeline> ComputePipeline::CreateCached(const Ptr<PipelineLayout> &pipeline_layout,
+                                                   const Ptr<ShaderModule> &shader_module) {
+	// Handles are unique while alive, and the pipeline keeps its layout and shader module alive
+	VkComputePipelineCreateInfo create_info = {};
+	create_info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+	create_info.layout = pipeline_layout->GetHandle();
+	create_info.stage = shader_module->GetPipelineShaderStageCreateInfo(VK_SHADER_STAGE_COMPUTE_BIT);
+	CacheKey key;
+	AppendCacheKey(&key, create_info);
+	return pipeline_layout->GetDevicePtr()->GetComputePipelineCache().GetOrCreate(std::move(key), [&] {
+		auto ret = Create(pipeline_layout, create_info);
+		if (ret)
+			ret->m_shader_module_ptr = shader_module;
+		return ret;
+	});
+}
+
+bool ComputePipeline::AppendCacheKey(CacheKey *p_key, const VkComputePipelineCreateInfo &create_info) {
+	CacheKey &key = *p_key;
+	const VkPipelineShaderStageCreateInfo &stage = create_info.stage;
+	key << create_info.flags << create_info.layout << stage.flags << stage.stage << stage.module;
+	key.Append(stage.pName, stage.pName ? std::strlen(stage.pName) : 0);
+	if (const VkSpecializationInfo *p_spec = stage.pSpecializationInfo) {
+		key.AppendArray(p_spec->pMapEntries, p_spec->mapEntryCount,
+		                [](CacheKey &key, const VkSpecializationMapEntry &entry) {
+			                key << entry.constantID << entry.offset << entry.size;
+		                });
+		key.Append(p_spec->pData, p_spec->dataSize);
+	} else
+		key << uint32_t(0);
+	return create_info.pNext == nullptr && stage.pNext == nullptr;
+}
+
+std::size_t ComputePipeline::CreateInfoHash::operator()(const VkComputePipelineCreateInfo &create_info) const {
+	CacheKey key;
+	AppendCacheKey(&key, create_info);
+	return CacheKey::Hash{}(key);
+}
+
+bool ComputePipeline::CreateInfoEqual::operator()(const VkComputePipelineCreateInfo &l,
+                                                  const VkComputePipelineCreateInfo &r) const {
+	CacheKey l_key, r_key;
+	return AppendCacheKey(&l_key, l) && AppendCacheKey(&r_key, r) && l_key == r_key;
+}
 } // namespace myvk
@@ -0,0 +1,312 @@
+#include "myvk/Defragmenter.hpp"
+
+#include <algorithm>
+
+namespace myvk {
+
+Ptr<Defragmenter> Defragmenter::Create(const Ptr<Queue> &queue, VkDeviceSize max_bytes_per_pass,
+                                       uint32_t max_allocations_per_pass) {
+	auto ret = std::make_shared<Defragmenter>();
+	ret->m_queue_ptr = queue;
+	ret->m_command_pool_ptr = CommandPool::Create(queue, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+	ret->m_semaphore_ptr = TimelineSemaphore::Create(queue->GetDevicePtr());
+	if (!ret->m_command_pool_ptr || !ret->m_semaphore_ptr)
+		return nullptr;
+	ret->m_info = {.flags = VMA_DEFRAGMENTATION_FLAG_ALGORITHM_BALANCED_BIT,
+	               .maxBytesPerPass = max_bytes_per_pass,
+	               .maxAllocationsPerPass = max_allocations_per_pass};
+	return ret;
+}
+
+bool Defragmenter::Register(const Ptr<Image> &image, const ImageSyncState &state) {
+	constexpr VkImageUsageFlags kCopyUsages = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+	if (!image->m_movable || (image->GetUsage() & kCopyUsages) != kCopyUsages ||
+	    image->GetDevicePtr() != GetDevicePtr())
+		return false;
+	m_images[image->m_allocation] = {.image = image, .state = state};
+	return true;
+}
+
+bool Defragmenter::Register(const Ptr<Buffer> &buffer, const BufferSyncState &state) {
+	constexpr VkBufferUsageFlags kCopyUsages = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+	// The host could write a persistently mapped buffer through its old mapping while the pass is applied
+	if (!buffer->m_movable || buffer->m_mapped_ptr || (buffer->GetUsage() & kCopyUsages) != kCopyUsages ||
+	    buffer->GetDevicePtr() != GetDevicePtr())
+		return false;
+	m_buffers[buffer->m_allocation] = {.buffer = buffer, .state = state};
+	return true;
+}
+
+bool Defragmenter::create_moves() {
+	VkDevice device = GetDevicePtr()->GetHandle();
+	VmaAllocator allocator = get_allocator_handle();
+
+	for (uint32_t i = 0; i < m_pass.moveCount; ++i) {
+		auto &move = m_pass.pMoves[i];
+		move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+
+		if (auto it = m_images.find(move.srcAllocation); it != m_images.end()) {
+			Ptr<Image> image = it->second.image.lock();
+			if (!image)
+				continue;
+			VkImageCreateInfo create_info = image->m_create_info;
+			create_info.pQueueFamilyIndices = image->m_queue_families.data();
+			VkImage vk_image;
+			if (vkCreateImage(device, &create_info, nullptr, &vk_image) != VK_SUCCESS)
+				continue;
+			if (vmaBindImageMemory(allocator, move.dstTmpAllocation, vk_image) != VK_SUCCESS) {
+				vkDestroyImage(device, vk_image, nullptr);
+				continue;
+			}
+			move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_COPY;
+			m_image_moves.push_back({.image = std::move(image), .state = it->second.state, .vk_image = vk_image});
+		} else if (auto it = m_buffers.find(move.srcAllocation); it != m_buffers.end()) {
+			Ptr<Buffer> buffer = it->second.buffer.lock();
+			if (!buffer)
+				continue;
+			VkBufferCreateInfo create_info = buffer->m_create_info;
+			create_info.pQueueFamilyIndices = buffer->m_queue_families.data();
+			VkBuffer vk_buffer;
+			if (vkCreateBuffer(device, &create_info, nullptr, &vk_buffer) != VK_SUCCESS)
+				continue;
+			if (vmaBindBufferMemory(allocator, move.dstTmpAllocation, vk_buffer) != VK_SUCCESS) {
+				vkDestroyBuffer(device, vk_buffer, nullptr);
+				continue;
+			}
+			move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_COPY;
+			m_buffer_moves.push_back({.buffer = std::move(buffer), .state = it->second.state, .vk_buffer = vk_buffer});
+		}
+	}
+	return !m_image_moves.empty() || !m_buffer_moves.empty();
+}
+
+void Defragmenter::destroy_moves() {
+	VkDevice device = GetDevicePtr()->GetHandle();
+	for (const auto &move : m_image_moves)
+		vkDestroyImage(device, move.vk_image, nullptr);
+	for (const auto &move : m_buffer_moves)
+		vkDestroyBuffer(device, move.vk_buffer, nullptr);
+	m_image_moves.clear();
+	m_buffer_moves.clear();
+}
+
+bool Defragmenter::submit_copies() {
+	auto command_buffer = CommandBuffer::Create(m_command_pool_ptr);
+	if (!command_buffer)
+		return false;
+	command_buffer->Begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+
+	// Old resources to copy sources after their last uses, new ones to copy destinations
+	// Images in UNDEFINED layout hold no meaningful contents and are not copied
+	{
+		std::vector<VkBufferMemoryBarrier2> buffer_barriers;
+		std::vector<VkImageMemoryBarrier2> image_barriers;
+		for (const auto &move : m_image_moves) {
+			if (move.state.layout == VK_IMAGE_LAYOUT_UNDEFINED)
+				continue;
+			auto range = move.image->GetSubresourceRange(move.image->GetAllAspects());
+			image_barriers.push_back(move.image->GetMemoryBarrier2(
+			    range, move.state.stage_mask, move.state.access_mask, VK_PIPELINE_STAGE_2_COPY_BIT,
+			    VK_ACCESS_2_TRANSFER_READ_BIT, move.state.layout, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL));
+			image_barriers.push_back(move.image->GetMemoryBarrier2(
+			    range, VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE, VK_PIPELINE_STAGE_2_COPY_BIT,
+			    VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL));
+			image_barriers.back().image = move.vk_image;
+		}
+		for (const auto &move : m_buffer_moves)
+			buffer_barriers.push_back(move.buffer->GetMemoryBarrier2(move.state.stage_mask, move.state.access_mask,
+			                                                         VK_PIPELINE_STAGE_2_COPY_BIT,
+			                                                         VK_ACCESS_2_TRANSFER_READ_BIT));
+		command_buffer->CmdPipelineBarrier2({}, buffer_barriers, image_barriers);
+	}
+
+	for (const auto &move : m_image_moves) {
+		if (move.state.layout == VK_IMAGE_LAYOUT_UNDEFINED)
+			continue;
+		const auto &image = move.image;
+		std::vector<VkImageCopy> regions(image->GetMipLevels());
+		for (uint32_t mip = 0; mip < image->GetMipLevels(); ++mip) {
+			VkImageSubresourceLayers subresource = {image->GetAllAspects(), mip, 0, image->GetArrayLayers()};
+			const VkExtent3D &extent = image->GetExtent();
+			regions[mip] = {.srcSubresource = subresource,
+			                .dstSubresource = subresource,
+			                .extent = {std::max(extent.width >> mip, 1u), std::max(extent.height >> mip, 1u),
+			                           std::max(extent.depth >> mip, 1u)}};
+		}
+		vkCmdCopyImage(command_buffer->GetHandle(), image->GetHandle(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+		               move.vk_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, regions.size(), regions.data());
+	}
+	for (const auto &move : m_buffer_moves) {
+		VkBufferCopy region = {.srcOffset = 0, .dstOffset = 0, .size = move.buffer->GetSize()};
+		vkCmdCopyBuffer(command_buffer->GetHandle(), move.buffer->GetHandle(), move.vk_buffer, 1, &region);
+	}
+
+	// Both old and new resources are left in their registered sync state, frames submitted before the pass is applied
+	// keep using the old ones
+	{
+		std::vector<VkBufferMemoryBarrier2> buffer_barriers;
+		std::vector<VkImageMemoryBarrier2> image_barriers;
+		for (const auto &move : m_image_moves) {
+			if (move.state.layout == VK_IMAGE_LAYOUT_UNDEFINED)
+				continue;
+			auto range = move.image->GetSubresourceRange(move.image->GetAllAspects());
+			image_barriers.push_back(move.image->GetMemoryBarrier2(
+			    range, VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_NONE, move.state.stage_mask, move.state.access_mask,
+			    VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, move.state.layout));
+			image_barriers.push_back(move.image->GetMemoryBarrier2(
+			    range, VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, move.state.stage_mask,
+			    move.state.access_mask, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, move.state.layout));
+			image_barriers.back().image = move.vk_image;
+		}
+		for (const auto &move : m_buffer_moves) {
+			buffer_barriers.push_back(move.buffer->GetMemoryBarrier2(VK_PIPELINE_STAGE_2_COPY_BIT,
+			                                                         VK_ACCESS_2_TRANSFER_WRITE_BIT,
+			                                                         move.state.stage_mask, move.state.access_mask));
+			buffer_barriers.back().buffer = move.vk_buffer;
+		}
+		command_buffer->CmdPipelineBarrier2({}, buffer_barriers, image_barriers);
+	}
+
+	command_buffer->End();
+
+	if (command_buffer->Submit2({}, {m_semaphore_ptr->GetSubmitInfo(m_value + 1)}) != VK_SUCCESS)
+		return false;
+	++m_value;
+	m_command_buffer = std::move(command_buffer);
+	return true;
+}
+
+void Defragmenter::apply_moves() {
+	MoveEvent event;
+	for (auto &move : m_image_moves) {
+		std::swap(move.image->m_image, move.vk_image);
+		event.images.push_back(move.image);
+	}
+	for (auto &move : m_buffer_moves) {
+		std::swap(move.buffer->m_buffer, move.vk_buffer);
+		event.buffers.push_back(move.buffer);
+	}
+	for (const auto &listener : m_listeners)
+		listener(event);
+}
+
+void Defragmenter::end_pass() {
+	// Old resources are destroyed before their memory is released
+	destroy_moves();
+	m_command_buffer = nullptr;
+	m_pass_state = PassState::kIdle;
+
+	if (vmaEndDefragmentationPass(get_allocator_handle(), m_context, &m_pass) != VK_INCOMPLETE)
+		end_defragmentation();
+}
+
+void Defragmenter::cancel_pass() {
+	destroy_moves();
+	m_command_buffer = nullptr;
+	m_pass_state = PassState::kIdle;
+	for (uint32_t i = 0; i < m_pass.moveCount; ++i)
+		m_pass.pMoves[i].operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+	vmaEndDefragmentationPass(get_allocator_handle(), m_context, &m_pass);
+}
+
+void Defragmenter::end_defragmentation() {
+	vmaEndDefragmentation(get_allocator_handle(), m_context, &m_stats);
+	m_context = VK_NULL_HANDLE;
+}
+
+Defragmenter::PassAction Defragmenter::GetPassAction(PassState state, bool submission_completed, bool abandon) {
+	if (state == PassState::kIdle)
+		return PassAction::kBegin;
+	if (!submission_completed)
+		return PassAction::kWait;
+	if (state == PassState::kCopying)
+		return abandon ? PassAction::kCancel : PassAction::kApply;
+	return PassAction::kEnd;
+}
+
+uint64_t Defragmenter::Flush() {
+	if (m_pass_state != PassState::kIdle)
+		return m_value;
+
+	std::erase_if(m_images, [](const auto &it) { return it.second.image.expired(); });
+	std::erase_if(m_buffers, [](const auto &it) { return it.second.buffer.expired(); });
+
+	if (!m_context && vmaBeginDefragmentation(get_allocator_handle(), &m_info, &m_context) != VK_SUCCESS) {
+		m_context = VK_NULL_HANDLE;
+		return 0;
+	}
+
+	// Passes only moving unregistered allocations are ignored as a whole
+	for (;;) {
+		if (vmaBeginDefragmentationPass(get_allocator_handle(), m_context, &m_pass) != VK_INCOMPLETE) {
+			end_defragmentation();
+			return 0;
+		}
+		if (create_moves())
+			break;
+		if (vmaEndDefragmentationPass(get_allocator_handle(), m_context, &m_pass) != VK_INCOMPLETE) {
+			end_defragmentation();
+			return 0;
+		}
+	}
+
+	if (!submit_copies()) {
+		cancel_pass();
+		end_defragmentation();
+		return 0;
+	}
+	m_pass_state = PassState::kCopying;
+	return m_value;
+}
+
+bool Defragmenter::Update() {
+	switch (GetPassAction(m_pass_state, m_semaphore_ptr->GetValue() >= m_value)) {
+	case PassAction::kBegin:
+		return true;
+	case PassAction::kWait:
+		return false;
+	case PassAction::kApply: {
+		apply_moves();
+
+		// Work submitted until now may still use the old resources, wait for it on the queue before freeing them
+		VkSemaphoreSubmitInfo signal_info = m_semaphore_ptr->GetSubmitInfo(m_value + 1);
+		VkSubmitInfo2 submit_info = {.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
+		                             .signalSemaphoreInfoCount = 1,
+		                             .pSignalSemaphoreInfos = &signal_info};
+		if (m_queue_ptr->Submit2(submit_info) != VK_SUCCESS) {
+			m_queue_ptr->WaitIdle();
+			end_pass();
+			return true;
+		}
+		++m_value;
+		m_pass_state = PassState::kRetiring;
+		return false;
+	}
+	case PassAction::kCancel:
+		cancel_pass();
+		return true;
+	case PassAction::kEnd:
+		end_pass();
+		return true;
+	}
+	return true;
+}
+
+Defragmenter::~Defragmenter() {
+	if (m_pass_state != PassState::kIdle)
+		m_semaphore_ptr->Wait(m_value);
+	switch (GetPassAction(m_pass_state, true, true)) {
+	case PassAction::kCancel:
+		cancel_pass();
+		break;
+	case PassAction::kEnd:
+		end_pass();
+		break;
+	default:
+		break;
+	}
+	if (m_context)
+		end_defragmentation();
+}
+
+} // namespace myvk
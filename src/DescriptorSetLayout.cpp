@@ -42,6 +42,21 @@ Ptr<DescriptorSetLayout> DescriptorSetLayout::Create(const Ptr<Device> &device,
 	return ret;
 }
 
+Ptr<DescriptorSetLayout> DescriptorSetLayout::CreateCached(const Ptr<Device> &device,
+                                                           const std::vector<VkDescriptorSetLayoutBinding> &bindings,
+                                                           VkDescriptorSetLayoutCreateFlags flags) {
+	CacheKey key;
+	key << flags;
+	key.AppendArray(bindings.data(), bindings.size(), [](CacheKey &key, const VkDescriptorSetLayoutBinding &binding) {
+		key << binding.binding << binding.descriptorType << binding.descriptorCount << binding.stageFlags
+		    << bool(binding.pImmutableSamplers);
+		if (binding.pImmutableSamplers)
+			key.Append(binding.pImmutableSamplers, binding.descriptorCount * sizeof(VkSampler));
+	});
+	return device->GetDescriptorSetLayoutCache().GetOrCreate(std::move(key),
+	                                                         [&] { return Create(device, bindings, flags); });
+}
+
 DescriptorSetLayout::~DescriptorSetLayout() {
 	if (m_descriptor_set_layout)
 		vkDestroyDescriptorSetLayout(m_device_ptr->GetHandle(), m_descriptor_set_layout, nullptr);
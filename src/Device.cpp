@@ -48,15 +48,30 @@ Ptr<Device> Device::Create(const Ptr<PhysicalDevice> &physical_device, const Que
 		return nullptr;
 	volkLoadDevice(ret->m_device);
 
-	ret->m_allocator = Allocator::CreateHandle(ret, {});
+	ret->m_memory_budget = std::ranges::any_of(extensions, [](const char *extension) {
+		return std::string_view{extension} == VK_EXT_MEMORY_BUDGET_EXTENSION_NAME;
+	});
+	VmaAllocatorCreateFlags allocator_flags = ret->m_memory_budget ? VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT : 0;
+	ret->m_allocator = Allocator::CreateHandle(ret, {.flags = allocator_flags});
 	if (ret->m_allocator == VK_NULL_HANDLE)
 		return nullptr;
-	ret->m_dev_addr_allocator = Allocator::CreateHandle(ret, {.flags = VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT});
+	ret->m_dev_addr_allocator =
+	    Allocator::CreateHandle(ret, {.flags = allocator_flags | VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT});
 	if (ret->m_dev_addr_allocator == VK_NULL_HANDLE)
 		return nullptr;
 	if (ret->create_pipeline_cache() != VK_SUCCESS)
 		return nullptr;
 	ret->m_features = features;
+	if (std::ranges::any_of(extensions, [](const char *extension) {
+		    return std::string_view{extension} == VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME;
+	    })) {
+		for (auto *p_next = static_cast<const VkBaseInStructure *>(features.vk13.pNext); p_next;
+		     p_next = p_next->pNext)
+			if (p_next->sType == VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT)
+				ret->m_graphics_pipeline_library =
+				    reinterpret_cast<const VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT *>(p_next)
+				        ->graphicsPipelineLibrary;
+	}
 	queue_resolver.FetchDeviceQueues(ret);
 	return ret;
 }
@@ -86,6 +101,17 @@ VkResult Device::create_pipeline_cache() {
 
 VkResult Device::WaitIdle() const { return vkDeviceWaitIdle(m_device); }
 
+VkResult Device::SetObjectName(VkObjectType object_type, uint64_t object_handle, const char *name) const {
+	if (!IsDebugUtilsAvailable())
+		return VK_ERROR_EXTENSION_NOT_PRESENT;
+	VkDebugUtilsObjectNameInfoEXT info = {};
+	info.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT;
+	info.objectType = object_type;
+	info.objectHandle = object_handle;
+	info.pObjectName = name;
+	return vkSetDebugUtilsObjectNameEXT(m_device, &info);
+}
+
 QueueSelectionResolver::QueueSelectionResolver(const Ptr<PhysicalDevice> &physical_device,
                                                std::vector<QueueSelection> &&queue_selections)
     : m_queue_selections{std::move(queue_selections)} {
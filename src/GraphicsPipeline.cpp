@@ -1,5 +1,7 @@
 #include "myvk/GraphicsPipeline.hpp"
 
+#include <algorithm>
+
 namespace myvk {
 
 std::vector<VkPipelineShaderStageCreateInfo> GraphicsPipelineShaderModules::GetShaderStages() const {
@@ -16,6 +18,18 @@ std::vector<VkPipelineShaderStageCreateInfo> GraphicsPipelineShaderModules::GetS
 		shader_stages.push_back(frag->GetPipelineShaderStageCreateInfo(VK_SHADER_STAGE_FRAGMENT_BIT));
 	return shader_stages;
 }
+void GraphicsPipelineShaderModules::AppendCacheKey(CacheKey *p_key) const {
+	const auto append = [p_key](const Ptr<ShaderModule> &module, VkShaderStageFlagBits stage) {
+		*p_key << bool(module);
+		if (module)
+			module->AppendCacheKey(p_key, stage);
+	};
+	append(vert, VK_SHADER_STAGE_VERTEX_BIT);
+	append(tesc, VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT);
+	append(tese, VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT);
+	append(geom, VK_SHADER_STAGE_GEOMETRY_BIT);
+	append(frag, VK_SHADER_STAGE_FRAGMENT_BIT);
+}
 
 Ptr<GraphicsPipeline> GraphicsPipeline::Create(const Ptr<PipelineLayout> &pipeline_layout,
                                                const Ptr<RenderPass> &render_pass,
@@ -28,9 +42,7 @@ Ptr<GraphicsPipeline> GraphicsPipeline::Create(const Ptr<PipelineLayout> &pipeli
 	new_info.renderPass = render_pass->GetHandle();
 	new_info.layout = pipeline_layout->GetHandle();
 
-	if (vkCreateGraphicsPipelines(pipeline_layout->GetDevicePtr()->GetHandle(),
-	                              pipeline_layout->GetDevicePtr()->GetPipelineCacheHandle(), 1, &new_info, nullptr,
-	                              &ret->m_pipeline) != VK_SUCCESS)
+	if (ret->create_pipeline(new_info) != VK_SUCCESS)
 		return nullptr;
 	return ret;
 }
@@ -51,9 +63,7 @@ Ptr<GraphicsPipeline> GraphicsPipeline::Create(const Ptr<PipelineLayout> &pipeli
 	pipeline_state.PopGraphicsPipelineCreateInfo(&create_info);
 	create_info.subpass = subpass;
 
-	if (vkCreateGraphicsPipelines(pipeline_layout->GetDevicePtr()->GetHandle(),
-	                              pipeline_layout->GetDevicePtr()->GetPipelineCacheHandle(), 1, &create_info, nullptr,
-	                              &ret->m_pipeline) != VK_SUCCESS)
+	if (ret->create_pipeline(create_info) != VK_SUCCESS)
 		return nullptr;
 	return ret;
 }
@@ -63,6 +73,25 @@ Ptr<GraphicsPipeline> GraphicsPipeline::Create(const Ptr<PipelineLayout> &pipeli
                                                const GraphicsPipelineState &pipeline_state, uint32_t subpass) {
 	return Create(pipeline_layout, render_pass, shader_modules.GetShaderStages(), pipeline_state, subpass);
 }
+Ptr<GraphicsPipeline> GraphicsPipeline::CreateCached(const Ptr<PipelineLayout> &pipeline_layout,
+                                                     const Ptr<RenderPass> &render_pass,
+                                                     const GraphicsPipelineShaderModules &shader_modules,
+                                                     const GraphicsPipelineState &pipeline_state, uint32_t subpass) {
+	const auto create = [&] {
+		auto ret = Create(pipeline_layout, render_pass, shader_modules, pipeline_state, subpass);
+		if (ret)
+			ret->m_shader_modules = shader_modules;
+		return ret;
+	};
+
+	// Handles are unique while alive, and the pipeline keeps its layout, render pass and shader modules alive
+	CacheKey key;
+	key << pipeline_layout->GetHandle() << render_pass->GetHandle() << subpass;
+	shader_modules.AppendCacheKey(&key);
+	if (!pipeline_state.AppendCacheKey(&key))
+		return create();
+	return pipeline_layout->GetDevicePtr()->GetGraphicsPipelineCache().GetOrCreate(std::move(key), create);
+}
 
 void GraphicsPipelineState::RasterizationState::Initialize(VkPolygonMode polygon_mode, VkFrontFace front_face,
                                                            VkCullModeFlags cull_mode) {
@@ -170,4 +199,143 @@ void GraphicsPipelineState::PopGraphicsPipelineCreateInfo(VkGraphicsPipelineCrea
 	info->pColorBlendState = m_color_blend_state.m_enable ? &m_color_blend_state.m_create_info : nullptr;
 	info->pDynamicState = m_dynamic_state.m_enable ? &m_dynamic_state.m_create_info : nullptr;
 }
+
+bool GraphicsPipelineState::AppendCacheKey(CacheKey *p_key, VkGraphicsPipelineLibraryFlagsEXT parts) const {
+	CacheKey &key = *p_key;
+	const auto is_dynamic = [this](VkDynamicState state) {
+		return m_dynamic_state.m_enable && std::find(m_dynamic_state.m_dynamic_states.begin(),
+		                                             m_dynamic_state.m_dynamic_states.end(),
+		                                             state) != m_dynamic_state.m_dynamic_states.end();
+	};
+	const bool vertex_input = parts & VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT,
+	           pre_rasterization = parts & VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT,
+	           fragment_shader = parts & VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT,
+	           fragment_output = parts & VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT;
+	bool ok = true;
+	key << parts;
+
+	if (pre_rasterization) {
+		const auto &info = m_rasterization_state.m_create_info;
+		ok &= info.pNext == nullptr;
+		key << info.flags << info.depthClampEnable << info.rasterizerDiscardEnable << info.polygonMode
+		    << info.cullMode << info.frontFace << info.depthBiasEnable;
+		if (info.depthBiasEnable && !is_dynamic(VK_DYNAMIC_STATE_DEPTH_BIAS))
+			key << info.depthBiasConstantFactor << info.depthBiasClamp << info.depthBiasSlopeFactor;
+		if (!is_dynamic(VK_DYNAMIC_STATE_LINE_WIDTH))
+			key << info.lineWidth;
+	}
+	if (vertex_input)
+		key << m_vertex_input_state.m_enable << m_input_assembly_state.m_enable;
+	if (vertex_input && m_vertex_input_state.m_enable) {
+		const auto &info = m_vertex_input_state.m_create_info;
+		ok &= info.pNext == nullptr;
+		key << info.flags;
+		key.AppendArray(info.pVertexBindingDescriptions, info.vertexBindingDescriptionCount,
+		                [](CacheKey &key, const VkVertexInputBindingDescription &binding) {
+			                key << binding.binding << binding.stride << binding.inputRate;
+		                });
+		key.AppendArray(info.pVertexAttributeDescriptions, info.vertexAttributeDescriptionCount,
+		                [](CacheKey &key, const VkVertexInputAttributeDescription &attribute) {
+			                key << attribute.location << attribute.binding << attribute.format << attribute.offset;
+		                });
+	}
+	if (vertex_input && m_input_assembly_state.m_enable) {
+		const auto &info = m_input_assembly_state.m_create_info;
+		ok &= info.pNext == nullptr;
+		key << info.flags << info.topology << info.primitiveRestartEnable;
+	}
+	if (pre_rasterization)
+		key << m_tessellation_state.m_enable << m_viewport_state.m_enable;
+	if (pre_rasterization && m_tessellation_state.m_enable) {
+		const auto &info = m_tessellation_state.m_create_info;
+		ok &= info.pNext == nullptr;
+		key << info.flags << info.patchControlPoints;
+	}
+	if (pre_rasterization && m_viewport_state.m_enable) {
+		const auto &info = m_viewport_state.m_create_info;
+		ok &= info.pNext == nullptr;
+		key << info.flags << info.viewportCount << info.scissorCount;
+		bool static_viewports = info.pViewports && !is_dynamic(VK_DYNAMIC_STATE_VIEWPORT);
+		key << static_viewports;
+		if (static_viewports)
+			key.AppendArray(info.pViewports, info.viewportCount, [](CacheKey &key, const VkViewport &viewport) {
+				key << viewport.x << viewport.y << viewport.width << viewport.height << viewport.minDepth
+				    << viewport.maxDepth;
+			});
+		bool static_scissors = info.pScissors && !is_dynamic(VK_DYNAMIC_STATE_SCISSOR);
+		key << static_scissors;
+		if (static_scissors)
+			key.AppendArray(info.pScissors, info.scissorCount, [](CacheKey &key, const VkRect2D &scissor) {
+				key << scissor.offset.x << scissor.offset.y << scissor.extent.width << scissor.extent.height;
+			});
+	}
+	if (fragment_shader || fragment_output)
+		key << m_multisample_state.m_enable;
+	if ((fragment_shader || fragment_output) && m_multisample_state.m_enable) {
+		const auto &info = m_multisample_state.m_create_info;
+		ok &= info.pNext == nullptr;
+		key << info.flags << info.rasterizationSamples << info.sampleShadingEnable << info.minSampleShading
+		    << info.alphaToCoverageEnable << info.alphaToOneEnable << bool(info.pSampleMask);
+		if (info.pSampleMask)
+			key.Append(info.pSampleMask, (info.rasterizationSamples + 31) / 32 * sizeof(VkSampleMask));
+	}
+	if (fragment_shader)
+		key << m_depth_stencil_state.m_enable;
+	if (fragment_shader && m_depth_stencil_state.m_enable) {
+		const auto &info = m_depth_stencil_state.m_create_info;
+		ok &= info.pNext == nullptr;
+		const auto append_stencil_op = [&](const VkStencilOpState &op) {
+			key << op.failOp << op.passOp << op.depthFailOp << op.compareOp << op.compareMask << op.writeMask
+			    << op.reference;
+		};
+		key << info.flags << info.depthTestEnable << info.depthWriteEnable << info.depthCompareOp
+		    << info.depthBoundsTestEnable << info.stencilTestEnable;
+		if (info.stencilTestEnable) {
+			append_stencil_op(info.front);
+			append_stencil_op(info.back);
+		}
+		if (info.depthBoundsTestEnable && !is_dynamic(VK_DYNAMIC_STATE_DEPTH_BOUNDS))
+			key << info.minDepthBounds << info.maxDepthBounds;
+	}
+	if (fragment_output)
+		key << m_color_blend_state.m_enable;
+	if (fragment_output && m_color_blend_state.m_enable) {
+		const auto &info = m_color_blend_state.m_create_info;
+		ok &= info.pNext == nullptr;
+		key << info.flags << info.logicOpEnable;
+		if (info.logicOpEnable)
+			key << info.logicOp;
+		key.AppendArray(info.pAttachments, info.attachmentCount,
+		                [](CacheKey &key, const VkPipelineColorBlendAttachmentState &att) {
+			                key << att.blendEnable << att.colorWriteMask;
+			                if (att.blendEnable)
+				                key << att.srcColorBlendFactor << att.dstColorBlendFactor << att.colorBlendOp
+				                    << att.srcAlphaBlendFactor << att.dstAlphaBlendFactor << att.alphaBlendOp;
+		                });
+		if (!is_dynamic(VK_DYNAMIC_STATE_BLEND_CONSTANTS))
+			for (float constant : info.blendConstants)
+				key << constant;
+	}
+	// Dynamic states are shared by all parts
+	key << m_dynamic_state.m_enable;
+	if (m_dynamic_state.m_enable) {
+		ok &= m_dynamic_state.m_create_info.pNext == nullptr;
+		std::vector<VkDynamicState> dynamic_states = m_dynamic_state.m_dynamic_states;
+		std::sort(dynamic_states.begin(), dynamic_states.end());
+		key.AppendArray(dynamic_states.data(), dynamic_states.size(),
+		                [](CacheKey &key, VkDynamicState state) { key << state; });
+	}
+	return ok;
+}
+std::size_t GraphicsPipelineState::GetHash() const {
+	CacheKey key;
+	AppendCacheKey(&key);
+	return CacheKey::Hash{}(key);
+}
+bool GraphicsPipelineState::operator==(const GraphicsPipelineState &r) const {
+	if (this == &r)
+		return true;
+	CacheKey l_key, r_key;
+	return AppendCacheKey(&l_key) && r.AppendCacheKey(&r_key) && l_key == r_key;
+}
 } // namespace myvk
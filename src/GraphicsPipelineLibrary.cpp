@@ -0,0 +1,124 @@
+#include "myvk/GraphicsPipelineLibrary.hpp"
+
+namespace myvk {
+
+Ptr<GraphicsPipelineLibrary>
+GraphicsPipelineLibrary::CreateCached(VkGraphicsPipelineLibraryFlagBitsEXT part,
+                                      const Ptr<PipelineLayout> &pipeline_layout, const Ptr<RenderPass> &render_pass,
+                                      const GraphicsPipelineShaderModules &shader_modules,
+                                      const GraphicsPipelineState &pipeline_state, uint32_t subpass) {
+	GraphicsPipelineShaderModules part_shader_modules{};
+	if (part == VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT)
+		part_shader_modules = {shader_modules.vert, shader_modules.tesc, shader_modules.tese, shader_modules.geom};
+	else if (part == VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT)
+		part_shader_modules.frag = shader_modules.frag;
+	// The vertex input interface does not depend on the render pass
+	bool use_render_pass = part != VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT;
+
+	const auto create = [&]() -> Ptr<GraphicsPipelineLibrary> {
+		auto ret = std::make_shared<GraphicsPipelineLibrary>();
+		ret->m_pipeline_layout_ptr = pipeline_layout;
+		ret->m_part = part;
+		ret->m_shader_modules = part_shader_modules;
+		if (use_render_pass)
+			ret->m_render_pass_ptr = render_pass;
+
+		auto shader_stages = part_shader_modules.GetShaderStages();
+		VkGraphicsPipelineLibraryCreateInfoEXT library_info = {
+		    VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT};
+		library_info.flags = part;
+
+		// States not consumed by the part are ignored by the implementation
+		VkGraphicsPipelineCreateInfo create_info = {VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO};
+		create_info.pNext = &library_info;
+		create_info.flags =
+		    VK_PIPELINE_CREATE_LIBRARY_BIT_KHR | VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT;
+		create_info.layout = pipeline_layout->GetHandle();
+		create_info.renderPass = use_render_pass ? render_pass->GetHandle() : VK_NULL_HANDLE;
+		create_info.subpass = use_render_pass ? subpass : 0;
+		create_info.stageCount = shader_stages.size();
+		create_info.pStages = shader_stages.data();
+		pipeline_state.PopGraphicsPipelineCreateInfo(&create_info);
+
+		if (ret->create_pipeline(create_info) != VK_SUCCESS)
+			return nullptr;
+		return ret;
+	};
+
+	CacheKey key;
+	key << pipeline_layout->GetHandle();
+	if (use_render_pass)
+		key << render_pass->GetHandle() << subpass;
+	part_shader_modules.AppendCacheKey(&key);
+	if (!pipeline_state.AppendCacheKey(&key, part))
+		return create();
+	return pipeline_layout->GetDevicePtr()->GetGraphicsPipelineLibraryCache().GetOrCreate(std::move(key), create);
+}
+
+namespace {
+Ptr<GraphicsPipeline> link_libraries(const Ptr<PipelineLayout> &pipeline_layout, const Ptr<RenderPass> &render_pass,
+                                     const std::array<Ptr<GraphicsPipelineLibrary>, 4> &libraries, uint32_t subpass,
+                                     bool optimize) {
+	std::array<VkPipeline, 4> library_handles{};
+	for (std::size_t i = 0; i < libraries.size(); ++i)
+		library_handles[i] = libraries[i]->GetHandle();
+
+	VkPipelineLibraryCreateInfoKHR library_info = {VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR};
+	library_info.libraryCount = library_handles.size();
+	library_info.pLibraries = library_handles.data();
+
+	VkGraphicsPipelineCreateInfo create_info = {VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO};
+	create_info.pNext = &library_info;
+	create_info.flags = optimize ? VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT : 0;
+	create_info.subpass = subpass;
+	return GraphicsPipeline::Create(pipeline_layout, render_pass, create_info);
+}
+} // namespace
+
+Ptr<LinkedGraphicsPipeline> LinkedGraphicsPipeline::Create(const Ptr<PipelineLayout> &pipeline_layout,
+                                                           const Ptr<RenderPass> &render_pass,
+                                                           const GraphicsPipelineShaderModules &shader_modules,
+                                                           const GraphicsPipelineState &pipeline_state,
+                                                           uint32_t subpass, bool background_optimize) {
+	auto ret = std::make_shared<LinkedGraphicsPipeline>();
+
+	if (pipeline_layout->GetDevicePtr()->IsGraphicsPipelineLibraryEnabled()) {
+		static constexpr VkGraphicsPipelineLibraryFlagBitsEXT kParts[] = {
+		    VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT,
+		    VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT,
+		    VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT,
+		    VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT,
+		};
+		bool libraries_created = true;
+		for (std::size_t i = 0; i < 4; ++i) {
+			ret->m_library_ptrs[i] = GraphicsPipelineLibrary::CreateCached(kParts[i], pipeline_layout, render_pass,
+			                                                               shader_modules, pipeline_state, subpass);
+			libraries_created &= ret->m_library_ptrs[i] != nullptr;
+		}
+		if (libraries_created)
+			ret->m_pipeline_ptr = link_libraries(pipeline_layout, render_pass, ret->m_library_ptrs, subpass, false);
+		if (ret->m_pipeline_ptr && background_optimize)
+			ret->m_optimized_future =
+			    std::async(std::launch::async, link_libraries, pipeline_layout, render_pass, ret->m_library_ptrs,
+			               subpass, true);
+	}
+
+	if (!ret->m_pipeline_ptr) {
+		// No library support or library creation failed, build a monolithic pipeline
+		ret->m_library_ptrs = {};
+		ret->m_pipeline_ptr =
+		    GraphicsPipeline::CreateCached(pipeline_layout, render_pass, shader_modules, pipeline_state, subpass);
+		if (!ret->m_pipeline_ptr)
+			return nullptr;
+	}
+	return ret;
+}
+
+const Ptr<GraphicsPipeline> &LinkedGraphicsPipeline::GetPipelinePtr() {
+	if (m_optimized_future.valid() &&
+	    m_optimized_future.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+		m_optimized_pipeline_ptr = m_optimized_future.get();
+	return m_optimized_pipeline_ptr ? m_optimized_pipeline_ptr : m_pipeline_ptr;
+}
+
+} // namespace myvk
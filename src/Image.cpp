@@ -36,6 +36,12 @@ Ptr<Image> Image::Create(const Ptr<Device> &device, const VkImageCreateInfo &cre
 	if (vmaCreateImage(device->GetAllocatorHandle(), &new_info, &alloc_info, &ret->m_image, &ret->m_allocation,
 	                   nullptr) != VK_SUCCESS)
 		return nullptr;
+
+	ret->m_create_info = new_info;
+	ret->m_create_info.pNext = nullptr;
+	ret->m_create_info.pQueueFamilyIndices = nullptr;
+	ret->m_queue_families = std::move(queue_families);
+	ret->m_movable = !create_info.pNext;
 	return ret;
 }
 
@@ -17,7 +17,7 @@ Ptr<ImageView> ImageView::Create(const Ptr<ImageBase> &image, VkImageViewType vi
 	create_info.subresourceRange.layerCount = layer_count;
 	create_info.components = components;
 
-	return Create(image, create_info);
+	return CreateCached(image, create_info);
 }
 
 Ptr<ImageView> ImageView::Create(const Ptr<ImageBase> &image, VkImageViewType view_type,
@@ -45,6 +45,27 @@ Ptr<ImageView> ImageView::Create(const Ptr<ImageBase> &image, const VkImageViewC
 	return ret;
 }
 
+Ptr<ImageView> ImageView::CreateCached(const Ptr<ImageBase> &image, const VkImageViewCreateInfo &create_info) {
+	// The image handle is unique while it is alive, and the view keeps it alive
+	// The image object is keyed too, since a Defragmenter may replace the handle of a living image
+	const auto &range = create_info.subresourceRange;
+	CacheKey key;
+	key << image.get() << image->GetHandle() << create_info.flags << create_info.viewType << create_info.format
+	    << create_info.components.r << create_info.components.g << create_info.components.b
+	    << create_info.components.a << range.aspectMask << range.baseMipLevel << range.levelCount
+	    << range.baseArrayLayer << range.layerCount;
+
+	const auto *p_usage = static_cast<const VkImageViewUsageCreateInfo *>(create_info.pNext);
+	key << bool(p_usage);
+	if (p_usage) {
+		if (p_usage->sType != VK_STRUCTURE_TYPE_IMAGE_VIEW_USAGE_CREATE_INFO || p_usage->pNext)
+			return Create(image, create_info);
+		key << p_usage->usage;
+	}
+	return image->GetDevicePtr()->GetImageViewCache().GetOrCreate(std::move(key),
+	                                                              [&] { return Create(image, create_info); });
+}
+
 ImageView::~ImageView() {
 	if (m_image_view)
 		vkDestroyImageView(m_image_ptr->GetDevicePtr()->GetHandle(), m_image_view, nullptr);
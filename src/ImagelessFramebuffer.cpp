@@ -58,4 +58,24 @@ ImagelessFramebuffer::Create(const Ptr<RenderPass> &render_pass,
 	return ret;
 }
 
+Ptr<ImagelessFramebuffer>
+ImagelessFramebuffer::CreateCached(const Ptr<RenderPass> &render_pass,
+                                   const std::vector<VkFramebufferAttachmentImageInfo> &attachment_image_infos,
+                                   const VkExtent2D &extent, uint32_t layers) {
+	// The render pass handle is unique while it is alive, and the framebuffer keeps it alive
+	CacheKey key;
+	key << render_pass->GetHandle() << extent.width << extent.height << layers;
+	bool ok = true;
+	key.AppendArray(attachment_image_infos.data(), attachment_image_infos.size(),
+	                [&](CacheKey &key, const VkFramebufferAttachmentImageInfo &info) {
+		                ok &= info.pNext == nullptr;
+		                key << info.flags << info.usage << info.width << info.height << info.layerCount;
+		                key.Append(info.pViewFormats, info.viewFormatCount * sizeof(VkFormat));
+	                });
+	if (!ok)
+		return Create(render_pass, attachment_image_infos, extent, layers);
+	return render_pass->GetDevicePtr()->GetImagelessFramebufferCache().GetOrCreate(
+	    std::move(key), [&] { return Create(render_pass, attachment_image_infos, extent, layers); });
+}
+
 } // namespace myvk
@@ -0,0 +1,75 @@
+#include "myvk/MemoryBudget.hpp"
+
+#include <algorithm>
+#include <array>
+
+namespace myvk {
+
+Ptr<MemoryBudget> MemoryBudget::Create(const Ptr<Device> &device, const Thresholds &thresholds) {
+	auto ret = std::make_shared<MemoryBudget>();
+	ret->m_device_ptr = device;
+	ret->m_thresholds = thresholds;
+
+	const VkPhysicalDeviceMemoryProperties &memory_properties =
+	    device->GetPhysicalDevicePtr()->GetMemoryProperties();
+	ret->m_heap_states.resize(memory_properties.memoryHeapCount);
+	for (uint32_t i = 0; i < memory_properties.memoryHeapCount; ++i)
+		ret->m_heap_states[i].device_local = memory_properties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT;
+	ret->Update();
+	return ret;
+}
+
+MemoryBudget::Pressure MemoryBudget::GetPressure(VkDeviceSize usage, VkDeviceSize budget,
+                                                 const Thresholds &thresholds, Pressure prev_pressure) {
+	const auto get_pressure = [&](double usage) {
+		if (usage > (double)budget)
+			return Pressure::kOverBudget;
+		if (usage >= (double)budget * thresholds.critical)
+			return Pressure::kCritical;
+		if (usage >= (double)budget * thresholds.high)
+			return Pressure::kHigh;
+		return Pressure::kNormal;
+	};
+	// Dropping below prev_pressure is judged on the usage raised by the release margin
+	return std::max(get_pressure((double)usage),
+	                std::min(prev_pressure, get_pressure((double)usage + (double)budget * thresholds.release)));
+}
+
+MemoryBudget::Pressure MemoryBudget::GetPressure() const {
+	Pressure pressure = Pressure::kNormal;
+	for (const auto &state : m_heap_states)
+		if (state.device_local)
+			pressure = std::max(pressure, state.pressure);
+	return pressure;
+}
+
+void MemoryBudget::Update() {
+	VmaAllocator allocator = m_device_ptr->GetAllocatorHandle(),
+	             dev_addr_allocator = m_device_ptr->GetDeviceAddressAllocatorHandle();
+	// The budgets are refetched from the driver when the frame index changes
+	++m_frame_index;
+	vmaSetCurrentFrameIndex(allocator, m_frame_index);
+	vmaSetCurrentFrameIndex(dev_addr_allocator, m_frame_index);
+
+	std::array<VmaBudget, VK_MAX_MEMORY_HEAPS> budgets{}, dev_addr_budgets{};
+	vmaGetHeapBudgets(allocator, budgets.data());
+	vmaGetHeapBudgets(dev_addr_allocator, dev_addr_budgets.data());
+
+	for (uint32_t i = 0; i < m_heap_states.size(); ++i) {
+		auto &state = m_heap_states[i];
+		// The driver reports the usage of the whole process to both allocators, the fallback counts their own blocks
+		state.usage = m_device_ptr->IsMemoryBudgetEnabled() ? std::max(budgets[i].usage, dev_addr_budgets[i].usage)
+		                                                    : budgets[i].usage + dev_addr_budgets[i].usage;
+		state.budget = budgets[i].budget;
+
+		Pressure prev_pressure = state.pressure;
+		state.pressure = GetPressure(state.usage, state.budget, m_thresholds, prev_pressure);
+		if (state.pressure == prev_pressure)
+			continue;
+
+		for (const auto &callback : m_callbacks)
+			callback(i, state, prev_pressure);
+	}
+}
+
+} // namespace myvk
@@ -56,6 +56,8 @@ PhysicalDeviceFeatures PhysicalDevice::GetDefaultFeatures() const {
 	ret.vk10 = m_features.vk10;
 	ret.vk10.robustBufferAccess = VK_FALSE;
 	ret.vk12.imagelessFramebuffer = VK_TRUE;
+	ret.vk12.timelineSemaphore = VK_TRUE;
+	ret.vk12.hostQueryReset = VK_TRUE;
 	ret.vk13.synchronization2 = VK_TRUE;
 	return ret;
 }
@@ -1,6 +1,62 @@
 #include "myvk/PipelineBase.hpp"
 
+#include <chrono>
+
 namespace myvk {
+namespace {
+template <typename CreateInfo, typename CreateFunc>
+VkResult create_with_feedback(CreateInfo *p_create_info, const VkPipelineShaderStageCreateInfo *p_stages,
+                              uint32_t stage_count, PipelineCreationFeedback *p_feedback, CreateFunc &&create_func) {
+	VkPipelineCreationFeedback pipeline_feedback{};
+	std::vector<VkPipelineCreationFeedback> stage_feedbacks(stage_count);
+	VkPipelineCreationFeedbackCreateInfo feedback_info = {VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO};
+	feedback_info.pNext = p_create_info->pNext;
+	feedback_info.pPipelineCreationFeedback = &pipeline_feedback;
+	feedback_info.pipelineStageCreationFeedbackCount = stage_count;
+	feedback_info.pPipelineStageCreationFeedbacks = stage_feedbacks.data();
+	p_create_info->pNext = &feedback_info;
+
+	auto begin = std::chrono::steady_clock::now();
+	VkResult result = create_func();
+	p_feedback->end_time = std::chrono::steady_clock::now();
+	p_feedback->wall_time_ns =
+	    std::chrono::duration_cast<std::chrono::nanoseconds>(p_feedback->end_time - begin).count();
+
+	const auto get_flag = [](const VkPipelineCreationFeedback &feedback, VkPipelineCreationFeedbackFlags flag) {
+		return bool(feedback.flags & flag);
+	};
+	p_feedback->valid = get_flag(pipeline_feedback, VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT);
+	p_feedback->cache_hit =
+	    get_flag(pipeline_feedback, VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT);
+	p_feedback->duration_ns = pipeline_feedback.duration;
+	p_feedback->stages.resize(stage_count);
+	for (uint32_t i = 0; i < stage_count; ++i)
+		p_feedback->stages[i] = {
+		    .stage = p_stages[i].stage,
+		    .valid = get_flag(stage_feedbacks[i], VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT),
+		    .cache_hit = get_flag(stage_feedbacks[i], VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT),
+		    .duration_ns = stage_feedbacks[i].duration,
+		};
+	return result;
+}
+} // namespace
+
+VkResult PipelineBase::create_pipeline(VkGraphicsPipelineCreateInfo create_info) {
+	const auto &device = m_pipeline_layout_ptr->GetDevicePtr();
+	return create_with_feedback(&create_info, create_info.pStages, create_info.stageCount, &m_creation_feedback, [&] {
+		return vkCreateGraphicsPipelines(device->GetHandle(), device->GetPipelineCacheHandle(), 1, &create_info,
+		                                 nullptr, &m_pipeline);
+	});
+}
+
+VkResult PipelineBase::create_pipeline(VkComputePipelineCreateInfo create_info) {
+	const auto &device = m_pipeline_layout_ptr->GetDevicePtr();
+	return create_with_feedback(&create_info, &create_info.stage, 1, &m_creation_feedback, [&] {
+		return vkCreateComputePipelines(device->GetHandle(), device->GetPipelineCacheHandle(), 1, &create_info,
+		                                nullptr, &m_pipeline);
+	});
+}
+
 PipelineBase::~PipelineBase() {
 	if (m_pipeline)
 		vkDestroyPipeline(m_pipeline_layout_ptr->GetDevicePtr()->GetHandle(), m_pipeline, nullptr);
@@ -1,5 +1,8 @@
 #include "myvk/PipelineLayout.hpp"
 
+#include <algorithm>
+#include <map>
+
 namespace myvk {
 
 Ptr<PipelineLayout> PipelineLayout::Create(const Ptr<Device> &device,
@@ -28,6 +31,89 @@ Ptr<PipelineLayout> PipelineLayout::Create(const Ptr<Device> &device,
 	return ret;
 }
 
+Ptr<PipelineLayout> PipelineLayout::CreateCached(const Ptr<Device> &device,
+                                                 const std::vector<Ptr<DescriptorSetLayout>> &descriptor_layouts,
+                                                 const std::vector<VkPushConstantRange> &push_constant_ranges) {
+	// Set layout handles are unique while alive, and the pipeline layout keeps them alive
+	CacheKey key;
+	key.AppendArray(descriptor_layouts.data(), descriptor_layouts.size(),
+	                [](CacheKey &key, const Ptr<DescriptorSetLayout> &layout) { key << layout->GetHandle(); });
+	key.AppendArray(push_constant_ranges.data(), push_constant_ranges.size(),
+	                [](CacheKey &key, const VkPushConstantRange &range) {
+		                key << range.stageFlags << range.offset << range.size;
+	                });
+	return device->GetPipelineLayoutCache().GetOrCreate(
+	    std::move(key), [&] { return Create(device, descriptor_layouts, push_constant_ranges); });
+}
+
+Ptr<PipelineLayout> PipelineLayout::CreateReflected(const Ptr<Device> &device,
+                                                    const std::vector<Ptr<ShaderModule>> &shader_modules,
+                                                    const std::vector<Ptr<DescriptorSetLayout>> &descriptor_layouts) {
+	std::map<uint32_t, std::map<uint32_t, VkDescriptorSetLayoutBinding>> set_bindings;
+	std::optional<VkPushConstantRange> push_constant_range;
+
+	for (const auto &shader_module : shader_modules) {
+		const auto &reflection = shader_module->GetReflection();
+		if (!reflection)
+			return nullptr;
+		VkShaderStageFlagBits stage = reflection->GetStage();
+
+		for (const auto &binding : reflection->GetBindings()) {
+			if (binding.set < descriptor_layouts.size() && descriptor_layouts[binding.set])
+				continue;
+			if (binding.descriptor_count == 0)
+				return nullptr;
+			auto [it, inserted] = set_bindings[binding.set].insert({binding.binding,
+			                                                        {.binding = binding.binding,
+			                                                         .descriptorType = binding.descriptor_type,
+			                                                         .descriptorCount = binding.descriptor_count,
+			                                                         .stageFlags = (VkShaderStageFlags)stage}});
+			if (!inserted) {
+				if (it->second.descriptorType != binding.descriptor_type)
+					return nullptr;
+				it->second.descriptorCount = std::max(it->second.descriptorCount, binding.descriptor_count);
+				it->second.stageFlags |= stage;
+			}
+		}
+
+		if (const auto &range = reflection->GetPushConstantRange(); range) {
+			if (!push_constant_range)
+				push_constant_range = *range;
+			else {
+				uint32_t begin = std::min(push_constant_range->offset, range->offset),
+				         end = std::max(push_constant_range->offset + push_constant_range->size,
+				                        range->offset + range->size);
+				push_constant_range = VkPushConstantRange{push_constant_range->stageFlags | range->stageFlags,
+				                                          begin, end - begin};
+			}
+		}
+	}
+
+	std::size_t set_count = descriptor_layouts.size();
+	if (!set_bindings.empty())
+		set_count = std::max(set_count, std::size_t(set_bindings.rbegin()->first) + 1);
+
+	std::vector<Ptr<DescriptorSetLayout>> set_layouts(set_count);
+	for (uint32_t set = 0; set < set_count; ++set) {
+		if (set < descriptor_layouts.size() && descriptor_layouts[set]) {
+			set_layouts[set] = descriptor_layouts[set];
+			continue;
+		}
+		std::vector<VkDescriptorSetLayoutBinding> bindings;
+		if (auto it = set_bindings.find(set); it != set_bindings.end())
+			for (const auto &[_, binding] : it->second)
+				bindings.push_back(binding);
+		set_layouts[set] = DescriptorSetLayout::CreateCached(device, bindings);
+		if (!set_layouts[set])
+			return nullptr;
+	}
+
+	std::vector<VkPushConstantRange> push_constant_ranges;
+	if (push_constant_range)
+		push_constant_ranges.push_back(*push_constant_range);
+	return CreateCached(device, set_layouts, push_constant_ranges);
+}
+
 PipelineLayout::~PipelineLayout() {
 	if (m_pipeline_layout)
 		vkDestroyPipelineLayout(m_device_ptr->GetHandle(), m_pipeline_layout, nullptr);
@@ -21,6 +21,11 @@ VkResult Queue::WaitIdle() const {
 	return vkQueueWaitIdle(m_unique_queue_ptr->m_queue);
 }
 
+VkResult Queue::Submit2(const VkSubmitInfo2 &submit_info, VkFence fence) const {
+	std::lock_guard<std::mutex> lock_guard{GetMutex()};
+	return vkQueueSubmit2(m_unique_queue_ptr->m_queue, 1, &submit_info, fence);
+}
+
 Ptr<PresentQueue> PresentQueue::Create(const Ptr<UniqueQueue> &unique_queue, const Ptr<Surface> &surface) {
 	auto ret = std::make_shared<PresentQueue>();
 	ret->m_unique_queue_ptr = unique_queue;
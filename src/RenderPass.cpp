@@ -20,6 +20,66 @@ Ptr<RenderPass> RenderPass::Create(const Ptr<Device> &device, const VkRenderPass
 		return nullptr;
 	return ret;
 }
+namespace {
+// Serializes every field that affects render pass compatibility and behavior,
+// returns false if some pNext chain is not understood
+bool make_render_pass_cache_key(const VkRenderPassCreateInfo2 &info, CacheKey *p_key) {
+	if (info.pNext)
+		return false;
+	CacheKey &key = *p_key;
+	key << info.flags;
+
+	bool ok = true;
+	key.AppendArray(info.pAttachments, info.attachmentCount, [&](CacheKey &key, const VkAttachmentDescription2 &att) {
+		ok &= att.pNext == nullptr;
+		key << att.flags << att.format << att.samples << att.loadOp << att.storeOp << att.stencilLoadOp
+		    << att.stencilStoreOp << att.initialLayout << att.finalLayout;
+	});
+	const auto append_ref = [&](CacheKey &key, const VkAttachmentReference2 &ref) {
+		ok &= ref.pNext == nullptr;
+		key << ref.attachment << ref.layout << ref.aspectMask;
+	};
+	key.AppendArray(info.pSubpasses, info.subpassCount, [&](CacheKey &key, const VkSubpassDescription2 &subpass) {
+		ok &= subpass.pNext == nullptr;
+		key << subpass.flags << subpass.pipelineBindPoint << subpass.viewMask;
+		key.AppendArray(subpass.pInputAttachments, subpass.inputAttachmentCount, append_ref);
+		key.AppendArray(subpass.pColorAttachments, subpass.colorAttachmentCount, append_ref);
+		key << bool(subpass.pResolveAttachments);
+		if (subpass.pResolveAttachments)
+			key.AppendArray(subpass.pResolveAttachments, subpass.colorAttachmentCount, append_ref);
+		key << bool(subpass.pDepthStencilAttachment);
+		if (subpass.pDepthStencilAttachment)
+			append_ref(key, *subpass.pDepthStencilAttachment);
+		key.Append(subpass.pPreserveAttachments, subpass.preserveAttachmentCount * sizeof(uint32_t));
+	});
+	key.AppendArray(info.pDependencies, info.dependencyCount, [&](CacheKey &key, const VkSubpassDependency2 &dep) {
+		key << dep.srcSubpass << dep.dstSubpass << dep.srcStageMask << dep.dstStageMask << dep.srcAccessMask
+		    << dep.dstAccessMask << dep.dependencyFlags << dep.viewOffset;
+		// Synchronization2 masks chained by VkMemoryBarrier2 override the ones above
+		const auto *p_barrier = static_cast<const VkMemoryBarrier2 *>(dep.pNext);
+		key << bool(p_barrier);
+		if (p_barrier) {
+			ok &= p_barrier->sType == VK_STRUCTURE_TYPE_MEMORY_BARRIER_2 && p_barrier->pNext == nullptr;
+			key << p_barrier->srcStageMask << p_barrier->dstStageMask << p_barrier->srcAccessMask
+			    << p_barrier->dstAccessMask;
+		}
+	});
+	key.Append(info.pCorrelatedViewMasks, info.correlatedViewMaskCount * sizeof(uint32_t));
+	return ok;
+}
+} // namespace
+
+Ptr<RenderPass> RenderPass::CreateCached(const Ptr<Device> &device, const VkRenderPassCreateInfo2 &create_info) {
+	CacheKey key;
+	if (!make_render_pass_cache_key(create_info, &key))
+		return Create(device, create_info);
+	return device->GetRenderPassCache().GetOrCreate(std::move(key),
+	                                                [&] { return Create(device, create_info); });
+}
+Ptr<RenderPass> RenderPass::CreateCached(const Ptr<Device> &device, const RenderPassState2 &state) {
+	return CreateCached(device, state.GetRenderPassCreateInfo());
+}
+
 Ptr<RenderPass> RenderPass::Create(const Ptr<Device> &device, const RenderPassState &state) {
 	VkRenderPassCreateInfo info = {VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO};
 	state.PopRenderPassCreateInfo(&info);
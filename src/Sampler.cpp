@@ -1,6 +1,24 @@
 #include "myvk/Sampler.hpp"
 
 namespace myvk {
+Ptr<Sampler> Sampler::CreateCached(const Ptr<Device> &device, const VkSamplerCreateInfo &create_info) {
+	CacheKey key;
+	key << create_info.flags << create_info.magFilter << create_info.minFilter << create_info.mipmapMode
+	    << create_info.addressModeU << create_info.addressModeV << create_info.addressModeW << create_info.mipLodBias
+	    << create_info.anisotropyEnable << create_info.maxAnisotropy << create_info.compareEnable
+	    << create_info.compareOp << create_info.minLod << create_info.maxLod << create_info.borderColor
+	    << create_info.unnormalizedCoordinates;
+
+	const auto *p_reduction = static_cast<const VkSamplerReductionModeCreateInfo *>(create_info.pNext);
+	key << bool(p_reduction);
+	if (p_reduction) {
+		if (p_reduction->sType != VK_STRUCTURE_TYPE_SAMPLER_REDUCTION_MODE_CREATE_INFO || p_reduction->pNext)
+			return Create(device, create_info);
+		key << p_reduction->reductionMode;
+	}
+	return device->GetSamplerCache().GetOrCreate(std::move(key), [&] { return Create(device, create_info); });
+}
+
 Ptr<Sampler> Sampler::Create(const Ptr<Device> &device, const VkSamplerCreateInfo &create_info) {
 	auto ret = std::make_shared<Sampler>();
 	ret->m_device_ptr = device;
@@ -34,7 +52,7 @@ Ptr<Sampler> Sampler::Create(const Ptr<Device> &device, VkFilter filter, VkSampl
 	}
 	create_info.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
 
-	return Create(device, create_info);
+	return CreateCached(device, create_info);
 }
 
 Sampler::~Sampler() {
@@ -66,6 +84,6 @@ Ptr<Sampler> Sampler::CreateClampToBorder(const Ptr<Device> &device, VkFilter fi
 		create_info.anisotropyEnable = VK_FALSE;
 	}
 
-	return Create(device, create_info);
+	return CreateCached(device, create_info);
 }
 } // namespace myvk
@@ -17,6 +17,60 @@ Semaphore::~Semaphore() {
 		vkDestroySemaphore(m_device_ptr->GetHandle(), m_semaphore, nullptr);
 }
 
+Ptr<TimelineSemaphore> TimelineSemaphore::Create(const Ptr<Device> &device, uint64_t initial_value) {
+	auto ret = std::make_shared<TimelineSemaphore>();
+	ret->m_device_ptr = device;
+
+	VkSemaphoreTypeCreateInfo type_info = {};
+	type_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+	type_info.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+	type_info.initialValue = initial_value;
+
+	VkSemaphoreCreateInfo info = {};
+	info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+	info.pNext = &type_info;
+	if (vkCreateSemaphore(device->GetHandle(), &info, nullptr, &ret->m_semaphore) != VK_SUCCESS)
+		return nullptr;
+	return ret;
+}
+
+uint64_t TimelineSemaphore::GetValue() const {
+	uint64_t value = 0;
+	vkGetSemaphoreCounterValue(m_device_ptr->GetHandle(), m_semaphore, &value);
+	return value;
+}
+
+VkResult TimelineSemaphore::Wait(uint64_t value, uint64_t timeout) const {
+	VkSemaphoreWaitInfo info = {};
+	info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+	info.semaphoreCount = 1;
+	info.pSemaphores = &m_semaphore;
+	info.pValues = &value;
+	return vkWaitSemaphores(m_device_ptr->GetHandle(), &info, timeout);
+}
+
+VkResult TimelineSemaphore::Signal(uint64_t value) const {
+	VkSemaphoreSignalInfo info = {};
+	info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SIGNAL_INFO;
+	info.semaphore = m_semaphore;
+	info.value = value;
+	return vkSignalSemaphore(m_device_ptr->GetHandle(), &info);
+}
+
+VkSemaphoreSubmitInfo TimelineSemaphore::GetSubmitInfo(uint64_t value, VkPipelineStageFlags2 stages) const {
+	VkSemaphoreSubmitInfo info = {};
+	info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+	info.semaphore = m_semaphore;
+	info.value = value;
+	info.stageMask = stages;
+	return info;
+}
+
+TimelineSemaphore::~TimelineSemaphore() {
+	if (m_semaphore)
+		vkDestroySemaphore(m_device_ptr->GetHandle(), m_semaphore, nullptr);
+}
+
 SemaphoreGroup::SemaphoreGroup(const std::initializer_list<Ptr<Semaphore>> &semaphores) { Initialize(semaphores); }
 
 SemaphoreGroup::SemaphoreGroup(const std::vector<Ptr<Semaphore>> &semaphores) { Initialize(semaphores); }
@@ -12,11 +12,28 @@ Ptr<ShaderModule> ShaderModule::Create(const Ptr<Device> &device, const uint32_t
 	info.codeSize = code_size;
 	if (vkCreateShaderModule(device->GetHandle(), &info, nullptr, &ret->m_shader_module) != VK_SUCCESS)
 		return nullptr;
+	ret->m_reflection = ShaderReflection::Reflect(code, code_size);
+	return ret;
+}
+
+Ptr<ShaderModule> ShaderModule::CreateCached(const Ptr<Device> &device, const uint32_t *code, uint32_t code_size) {
+	CacheKey key;
+	key.Append(code, code_size);
+	auto owner = device->GetShaderModuleCache().GetOrCreate(std::move(key),
+	                                                        [&] { return Create(device, code, code_size); });
+	if (!owner)
+		return nullptr;
+
+	auto ret = std::make_shared<ShaderModule>();
+	ret->m_device_ptr = device;
+	ret->m_shader_module = owner->m_shader_module;
+	ret->m_reflection = owner->m_reflection;
+	ret->m_owner_ptr = std::move(owner);
 	return ret;
 }
 
 ShaderModule::~ShaderModule() {
-	if (m_shader_module)
+	if (m_shader_module && !m_owner_ptr)
 		vkDestroyShaderModule(m_device_ptr->GetHandle(), m_shader_module, nullptr);
 }
 
@@ -32,4 +49,15 @@ ShaderModule::GetPipelineShaderStageCreateInfo(VkShaderStageFlagBits stage,
 	ret.flags = flags;
 	return ret;
 }
+
+void ShaderModule::AppendCacheKey(CacheKey *p_key, VkShaderStageFlagBits stage,
+                                  VkPipelineShaderStageCreateFlags flags) const {
+	CacheKey &key = *p_key;
+	key << m_shader_module << stage << flags;
+	key.AppendArray(m_specialization_entries.data(), m_specialization_entries.size(),
+	                [](CacheKey &key, const VkSpecializationMapEntry &entry) {
+		                key << entry.constantID << entry.offset << entry.size;
+	                });
+	key.Append(m_specialization_data.data(), m_specialization_data.size() * sizeof(uint32_t));
+}
 } // namespace myvk
@@ -0,0 +1,510 @@
+#include "myvk/ShaderReflection.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace myvk {
+
+namespace {
+// Subset of the SPIR-V specification used by the reflection
+namespace spv {
+inline constexpr uint32_t kMagic = 0x07230203;
+enum Op : uint32_t {
+	kOpEntryPoint = 15,
+	kOpExecutionMode = 16,
+	kOpTypeBool = 20,
+	kOpTypeInt = 21,
+	kOpTypeFloat = 22,
+	kOpTypeVector = 23,
+	kOpTypeMatrix = 24,
+	kOpTypeImage = 25,
+	kOpTypeSampler = 26,
+	kOpTypeSampledImage = 27,
+	kOpTypeArray = 28,
+	kOpTypeRuntimeArray = 29,
+	kOpTypeStruct = 30,
+	kOpTypePointer = 32,
+	kOpConstantTrue = 41,
+	kOpConstantFalse = 42,
+	kOpConstant = 43,
+	kOpConstantComposite = 44,
+	kOpSpecConstantTrue = 48,
+	kOpSpecConstantFalse = 49,
+	kOpSpecConstant = 50,
+	kOpSpecConstantComposite = 51,
+	kOpVariable = 59,
+	kOpDecorate = 71,
+	kOpMemberDecorate = 72,
+	kOpTypeAccelerationStructureKHR = 5341,
+};
+enum Decoration : uint32_t {
+	kSpecId = 1,
+	kBufferBlock = 3,
+	kArrayStride = 6,
+	kMatrixStride = 7,
+	kBuiltIn = 11,
+	kLocation = 30,
+	kBinding = 33,
+	kDescriptorSet = 34,
+	kOffset = 35,
+};
+enum StorageClass : uint32_t {
+	kUniformConstant = 0,
+	kInput = 1,
+	kUniform = 2,
+	kPushConstant = 9,
+	kStorageBuffer = 12,
+	kPhysicalStorageBuffer = 5349,
+};
+enum ExecutionMode : uint32_t { kLocalSize = 17, kLocalSizeId = 38 };
+inline constexpr uint32_t kDimBuffer = 5, kDimSubpassData = 6;
+inline constexpr uint32_t kBuiltInWorkgroupSize = 25;
+
+VkShaderStageFlagBits get_stage(uint32_t execution_model) {
+	switch (execution_model) {
+	case 0:
+		return VK_SHADER_STAGE_VERTEX_BIT;
+	case 1:
+		return VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
+	case 2:
+		return VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+	case 3:
+		return VK_SHADER_STAGE_GEOMETRY_BIT;
+	case 4:
+		return VK_SHADER_STAGE_FRAGMENT_BIT;
+	case 5:
+		return VK_SHADER_STAGE_COMPUTE_BIT;
+	case 5267:
+	case 5364:
+		return VK_SHADER_STAGE_TASK_BIT_EXT;
+	case 5268:
+	case 5365:
+		return VK_SHADER_STAGE_MESH_BIT_EXT;
+	case 5313:
+		return VK_SHADER_STAGE_RAYGEN_BIT_KHR;
+	case 5314:
+		return VK_SHADER_STAGE_INTERSECTION_BIT_KHR;
+	case 5315:
+		return VK_SHADER_STAGE_ANY_HIT_BIT_KHR;
+	case 5316:
+		return VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR;
+	case 5317:
+		return VK_SHADER_STAGE_MISS_BIT_KHR;
+	case 5318:
+		return VK_SHADER_STAGE_CALLABLE_BIT_KHR;
+	default:
+		return VK_SHADER_STAGE_ALL;
+	}
+}
+} // namespace spv
+
+struct Decorations {
+	uint32_t set{ShaderReflection::kNoSpecId}, binding{ShaderReflection::kNoSpecId};
+	uint32_t location{ShaderReflection::kNoSpecId}, spec_id{ShaderReflection::kNoSpecId};
+	uint32_t builtin{ShaderReflection::kNoSpecId}, array_stride{};
+	bool buffer_block{};
+};
+struct MemberDecorations {
+	uint32_t offset{}, matrix_stride{};
+};
+
+} // namespace
+
+class ShaderReflectionParser {
+private:
+	const uint32_t *m_code;
+	std::size_t m_word_count;
+
+	std::vector<const uint32_t *> m_defs; // Defining instruction of each result id
+	std::vector<Decorations> m_decorations;
+	std::unordered_map<uint32_t, std::vector<MemberDecorations>> m_member_decorations;
+	std::vector<uint32_t> m_variables;
+
+	inline uint32_t op(uint32_t id) const { return m_defs[id] ? m_defs[id][0] & 0xffffu : 0; }
+	inline const uint32_t *def(uint32_t id) const { return m_defs[id]; }
+
+	inline bool valid_id(uint32_t id) const { return id < m_defs.size() && m_defs[id]; }
+
+public:
+	inline ShaderReflectionParser(const uint32_t *code, std::size_t word_count)
+	    : m_code{code}, m_word_count{word_count} {}
+
+	inline uint32_t GetConstant(uint32_t id) const {
+		if (!valid_id(id))
+			return 0;
+		switch (op(id)) {
+		case spv::kOpConstant:
+		case spv::kOpSpecConstant:
+			return def(id)[3];
+		case spv::kOpConstantTrue:
+		case spv::kOpSpecConstantTrue:
+			return 1;
+		default:
+			return 0;
+		}
+	}
+
+	// Size in bytes of a type in an explicitly laid out block
+	uint32_t GetTypeSize(uint32_t type_id, uint32_t matrix_stride = 0) const {
+		if (!valid_id(type_id))
+			return 0;
+		const uint32_t *inst = def(type_id);
+		switch (op(type_id)) {
+		case spv::kOpTypeBool:
+			return 4;
+		case spv::kOpTypeInt:
+		case spv::kOpTypeFloat:
+			return inst[2] / 8;
+		case spv::kOpTypeVector:
+			return inst[3] * GetTypeSize(inst[2]);
+		case spv::kOpTypeMatrix:
+			return inst[3] * (matrix_stride ? matrix_stride : GetTypeSize(inst[2]));
+		case spv::kOpTypeArray: {
+			uint32_t stride = m_decorations[type_id].array_stride;
+			return GetConstant(inst[3]) * (stride ? stride : GetTypeSize(inst[2], matrix_stride));
+		}
+		case spv::kOpTypeStruct: {
+			uint32_t size = 0, member_count = (inst[0] >> 16u) - 2;
+			auto it = m_member_decorations.find(type_id);
+			for (uint32_t i = 0; i < member_count; ++i) {
+				MemberDecorations member{};
+				if (it != m_member_decorations.end() && i < it->second.size())
+					member = it->second[i];
+				size = std::max(size, member.offset + GetTypeSize(inst[2 + i], member.matrix_stride));
+			}
+			return size;
+		}
+		case spv::kOpTypePointer:
+			return 8; // Physical storage buffer pointers
+		default:
+			return 0;
+		}
+	}
+
+	std::optional<VkDescriptorType> GetDescriptorType(uint32_t storage_class, uint32_t type_id) const {
+		if (!valid_id(type_id))
+			return std::nullopt;
+		const uint32_t *inst = def(type_id);
+		switch (storage_class) {
+		case spv::kUniform:
+			return m_decorations[type_id].buffer_block ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER
+			                                           : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		case spv::kStorageBuffer:
+			return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		case spv::kUniformConstant:
+			switch (op(type_id)) {
+			case spv::kOpTypeSampler:
+				return VK_DESCRIPTOR_TYPE_SAMPLER;
+			case spv::kOpTypeSampledImage:
+				return VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			case spv::kOpTypeAccelerationStructureKHR:
+				return VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR;
+			case spv::kOpTypeImage: {
+				uint32_t dim = inst[3], sampled = inst[7];
+				if (dim == spv::kDimBuffer)
+					return sampled == 2 ? VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER
+					                    : VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
+				if (dim == spv::kDimSubpassData)
+					return VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+				return sampled == 2 ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE : VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+			}
+			default:
+				return std::nullopt;
+			}
+		default:
+			return std::nullopt;
+		}
+	}
+
+	static VkFormat GetFormat(uint32_t component_op, uint32_t width, bool is_signed, uint32_t count) {
+		static constexpr VkFormat kFormats[3][3][4] = {
+		    // 16-bit
+		    {{VK_FORMAT_R16_SFLOAT, VK_FORMAT_R16G16_SFLOAT, VK_FORMAT_R16G16B16_SFLOAT, VK_FORMAT_R16G16B16A16_SFLOAT},
+		     {VK_FORMAT_R16_SINT, VK_FORMAT_R16G16_SINT, VK_FORMAT_R16G16B16_SINT, VK_FORMAT_R16G16B16A16_SINT},
+		     {VK_FORMAT_R16_UINT, VK_FORMAT_R16G16_UINT, VK_FORMAT_R16G16B16_UINT, VK_FORMAT_R16G16B16A16_UINT}},
+		    // 32-bit
+		    {{VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32B32A32_SFLOAT},
+		     {VK_FORMAT_R32_SINT, VK_FORMAT_R32G32_SINT, VK_FORMAT_R32G32B32_SINT, VK_FORMAT_R32G32B32A32_SINT},
+		     {VK_FORMAT_R32_UINT, VK_FORMAT_R32G32_UINT, VK_FORMAT_R32G32B32_UINT, VK_FORMAT_R32G32B32A32_UINT}},
+		    // 64-bit
+		    {{VK_FORMAT_R64_SFLOAT, VK_FORMAT_R64G64_SFLOAT, VK_FORMAT_R64G64B64_SFLOAT, VK_FORMAT_R64G64B64A64_SFLOAT},
+		     {VK_FORMAT_R64_SINT, VK_FORMAT_R64G64_SINT, VK_FORMAT_R64G64B64_SINT, VK_FORMAT_R64G64B64A64_SINT},
+		     {VK_FORMAT_R64_UINT, VK_FORMAT_R64G64_UINT, VK_FORMAT_R64G64B64_UINT, VK_FORMAT_R64G64B64A64_UINT}},
+		};
+		uint32_t width_index = width == 16 ? 0 : (width == 32 ? 1 : (width == 64 ? 2 : 3));
+		if (width_index == 3 || count == 0 || count > 4)
+			return VK_FORMAT_UNDEFINED;
+		uint32_t kind = component_op == spv::kOpTypeFloat ? 0 : (is_signed ? 1 : 2);
+		return kFormats[width_index][kind][count - 1];
+	}
+
+	// Appends the vertex inputs of a variable of type_id starting at location
+	void PushVertexInputs(uint32_t type_id, uint32_t location, std::vector<ShaderReflection::VertexInput> *p_inputs) {
+		if (!valid_id(type_id))
+			return;
+		const uint32_t *inst = def(type_id);
+		switch (op(type_id)) {
+		case spv::kOpTypeInt:
+		case spv::kOpTypeFloat:
+			p_inputs->push_back({location, GetFormat(op(type_id), inst[2], op(type_id) == spv::kOpTypeInt && inst[3], 1)});
+			break;
+		case spv::kOpTypeVector: {
+			const uint32_t *comp = def(inst[2]);
+			p_inputs->push_back(
+			    {location, GetFormat(op(inst[2]), comp[2], op(inst[2]) == spv::kOpTypeInt && comp[3], inst[3])});
+			break;
+		}
+		case spv::kOpTypeMatrix:
+		case spv::kOpTypeArray: {
+			uint32_t count = op(type_id) == spv::kOpTypeMatrix ? inst[3] : GetConstant(inst[3]);
+			// 64-bit 3- and 4-component vectors consume two locations
+			uint32_t elem_locations = GetTypeSize(inst[2]) > 16 ? 2 : 1;
+			for (uint32_t i = 0; i < count; ++i)
+				PushVertexInputs(inst[2], location + i * elem_locations, p_inputs);
+			break;
+		}
+		default:
+			break;
+		}
+	}
+
+	bool Run(const char *entry_point, ShaderReflection *p_out) {
+		VkShaderStageFlagBits *p_stage = &p_out->m_stage;
+		std::string *p_entry_point = &p_out->m_entry_point;
+		auto *p_bindings = &p_out->m_bindings;
+		auto *p_push_constant = &p_out->m_push_constant_range;
+		auto *p_spec_constants = &p_out->m_spec_constants;
+		auto *p_workgroup_size = &p_out->m_workgroup_size;
+		auto *p_workgroup_size_spec_ids = &p_out->m_workgroup_size_spec_ids;
+		auto *p_vertex_inputs = &p_out->m_vertex_inputs;
+
+		if (m_word_count < 5 || m_code[0] != spv::kMagic)
+			return false;
+		uint32_t version = m_code[1], bound = m_code[3];
+		m_defs.assign(bound, nullptr);
+		m_decorations.assign(bound, {});
+
+		uint32_t entry_id = 0, execution_model = 0;
+		std::unordered_set<uint32_t> interface_ids;
+		std::vector<const uint32_t *> execution_modes;
+
+		for (std::size_t pos = 5; pos < m_word_count;) {
+			const uint32_t *inst = m_code + pos;
+			uint32_t opcode = inst[0] & 0xffffu, word_count = inst[0] >> 16u;
+			if (word_count == 0 || pos + word_count > m_word_count)
+				return false;
+			pos += word_count;
+
+			const auto set_def = [&](uint32_t id) {
+				if (id < bound)
+					m_defs[id] = inst;
+			};
+
+			switch (opcode) {
+			case spv::kOpEntryPoint: {
+				if (entry_id || word_count < 4)
+					break;
+				const char *name = reinterpret_cast<const char *>(inst + 3);
+				std::size_t name_len = strnlen(name, (word_count - 3) * sizeof(uint32_t));
+				if (entry_point && std::strncmp(name, entry_point, name_len + 1) != 0)
+					break;
+				execution_model = inst[1];
+				entry_id = inst[2];
+				*p_entry_point = std::string(name, name_len);
+				for (uint32_t i = 3 + uint32_t(name_len / sizeof(uint32_t) + 1); i < word_count; ++i)
+					interface_ids.insert(inst[i]);
+			} break;
+			case spv::kOpExecutionMode:
+				execution_modes.push_back(inst);
+				break;
+			case spv::kOpDecorate: {
+				if (word_count < 3 || inst[1] >= bound)
+					break;
+				auto &decorations = m_decorations[inst[1]];
+				uint32_t value = word_count > 3 ? inst[3] : 0;
+				switch (inst[2]) {
+				case spv::kSpecId:
+					decorations.spec_id = value;
+					break;
+				case spv::kBufferBlock:
+					decorations.buffer_block = true;
+					break;
+				case spv::kArrayStride:
+					decorations.array_stride = value;
+					break;
+				case spv::kBuiltIn:
+					decorations.builtin = value;
+					break;
+				case spv::kLocation:
+					decorations.location = value;
+					break;
+				case spv::kBinding:
+					decorations.binding = value;
+					break;
+				case spv::kDescriptorSet:
+					decorations.set = value;
+					break;
+				default:
+					break;
+				}
+			} break;
+			case spv::kOpMemberDecorate: {
+				if (word_count < 5 || (inst[3] != spv::kOffset && inst[3] != spv::kMatrixStride))
+					break;
+				auto &members = m_member_decorations[inst[1]];
+				if (members.size() <= inst[2])
+					members.resize(inst[2] + 1);
+				(inst[3] == spv::kOffset ? members[inst[2]].offset : members[inst[2]].matrix_stride) = inst[4];
+			} break;
+			case spv::kOpTypeBool:
+			case spv::kOpTypeInt:
+			case spv::kOpTypeFloat:
+			case spv::kOpTypeVector:
+			case spv::kOpTypeMatrix:
+			case spv::kOpTypeImage:
+			case spv::kOpTypeSampler:
+			case spv::kOpTypeSampledImage:
+			case spv::kOpTypeArray:
+			case spv::kOpTypeRuntimeArray:
+			case spv::kOpTypeStruct:
+			case spv::kOpTypePointer:
+			case spv::kOpTypeAccelerationStructureKHR:
+				set_def(inst[1]);
+				break;
+			case spv::kOpConstantTrue:
+			case spv::kOpConstantFalse:
+			case spv::kOpConstant:
+			case spv::kOpConstantComposite:
+			case spv::kOpSpecConstantTrue:
+			case spv::kOpSpecConstantFalse:
+			case spv::kOpSpecConstant:
+			case spv::kOpSpecConstantComposite:
+				set_def(inst[2]);
+				break;
+			case spv::kOpVariable:
+				if (word_count < 4 || inst[2] >= bound)
+					break;
+				set_def(inst[2]);
+				m_variables.push_back(inst[2]);
+				break;
+			default:
+				break;
+			}
+		}
+		if (!entry_id)
+			return false;
+		*p_stage = spv::get_stage(execution_model);
+
+		// Since SPIR-V 1.4 the entry point interface lists every global variable it statically uses
+		const auto is_used = [&](uint32_t var_id) { return version < 0x10400 || interface_ids.count(var_id); };
+
+		for (uint32_t var_id : m_variables) {
+			const uint32_t *var = def(var_id);
+			uint32_t storage_class = var[3];
+			if (!valid_id(var[1]) || op(var[1]) != spv::kOpTypePointer)
+				continue;
+			uint32_t type_id = def(var[1])[3];
+			const auto &decorations = m_decorations[var_id];
+
+			if (storage_class == spv::kPushConstant) {
+				if (!is_used(var_id) || !valid_id(type_id) || op(type_id) != spv::kOpTypeStruct)
+					continue;
+				auto it = m_member_decorations.find(type_id);
+				uint32_t member_count = (def(type_id)[0] >> 16u) - 2, begin = UINT32_MAX, end = 0;
+				for (uint32_t i = 0; i < member_count; ++i) {
+					MemberDecorations member{};
+					if (it != m_member_decorations.end() && i < it->second.size())
+						member = it->second[i];
+					begin = std::min(begin, member.offset);
+					end = std::max(end, member.offset + GetTypeSize(def(type_id)[2 + i], member.matrix_stride));
+				}
+				if (end > begin)
+					*p_push_constant = VkPushConstantRange{*p_stage, begin, end - begin};
+			} else if (storage_class == spv::kInput) {
+				if (*p_stage != VK_SHADER_STAGE_VERTEX_BIT || !interface_ids.count(var_id) ||
+				    decorations.builtin != ShaderReflection::kNoSpecId ||
+				    decorations.location == ShaderReflection::kNoSpecId)
+					continue;
+				PushVertexInputs(type_id, decorations.location, p_vertex_inputs);
+			} else if (decorations.set != ShaderReflection::kNoSpecId &&
+			           decorations.binding != ShaderReflection::kNoSpecId && is_used(var_id)) {
+				uint32_t count = 1;
+				while (valid_id(type_id) &&
+				       (op(type_id) == spv::kOpTypeArray || op(type_id) == spv::kOpTypeRuntimeArray)) {
+					count = op(type_id) == spv::kOpTypeArray ? count * GetConstant(def(type_id)[3]) : 0;
+					type_id = def(type_id)[2];
+				}
+				auto descriptor_type = GetDescriptorType(storage_class, type_id);
+				if (descriptor_type)
+					p_bindings->push_back({decorations.set, decorations.binding, *descriptor_type, count});
+			}
+		}
+		std::sort(p_bindings->begin(), p_bindings->end(),
+		          [](const auto &l, const auto &r) { return std::tie(l.set, l.binding) < std::tie(r.set, r.binding); });
+		std::sort(p_vertex_inputs->begin(), p_vertex_inputs->end(),
+		          [](const auto &l, const auto &r) { return l.location < r.location; });
+
+		// Specialization constants and workgroup size
+		for (uint32_t id = 0; id < bound; ++id) {
+			const uint32_t *inst = def(id);
+			if (!inst)
+				continue;
+			const auto &decorations = m_decorations[id];
+			if (decorations.spec_id != ShaderReflection::kNoSpecId) {
+				switch (op(id)) {
+				case spv::kOpSpecConstantTrue:
+				case spv::kOpSpecConstantFalse:
+					p_spec_constants->push_back({decorations.spec_id, 4, op(id) == spv::kOpSpecConstantTrue});
+					break;
+				case spv::kOpSpecConstant: {
+					uint32_t size = GetTypeSize(inst[1]);
+					uint64_t value = inst[3];
+					if (size == 8 && (inst[0] >> 16u) > 4)
+						value |= uint64_t(inst[4]) << 32u;
+					p_spec_constants->push_back({decorations.spec_id, size, value});
+				} break;
+				default:
+					break;
+				}
+			}
+		}
+		std::sort(p_spec_constants->begin(), p_spec_constants->end(),
+		          [](const auto &l, const auto &r) { return l.constant_id < r.constant_id; });
+
+		const auto set_workgroup_size_ids = [&](const uint32_t *p_ids) {
+			for (uint32_t i = 0; i < 3; ++i) {
+				(*p_workgroup_size)[i] = GetConstant(p_ids[i]);
+				uint32_t spec_id = p_ids[i] < bound ? m_decorations[p_ids[i]].spec_id : ShaderReflection::kNoSpecId;
+				(*p_workgroup_size_spec_ids)[i] = spec_id;
+			}
+		};
+		for (const uint32_t *inst : execution_modes) {
+			if ((inst[0] >> 16u) < 6 || inst[1] != entry_id)
+				continue;
+			if (inst[2] == spv::kLocalSize)
+				std::copy(inst + 3, inst + 6, p_workgroup_size->begin());
+			else if (inst[2] == spv::kLocalSizeId)
+				set_workgroup_size_ids(inst + 3);
+		}
+		// A constant decorated with the WorkgroupSize built-in overrides the execution mode
+		for (uint32_t id = 0; id < bound; ++id) {
+			if (m_decorations[id].builtin == spv::kBuiltInWorkgroupSize && valid_id(id) &&
+			    (op(id) == spv::kOpConstantComposite || op(id) == spv::kOpSpecConstantComposite) &&
+			    (def(id)[0] >> 16u) >= 6)
+				set_workgroup_size_ids(def(id) + 3);
+		}
+		return true;
+	}
+};
+
+std::optional<ShaderReflection> ShaderReflection::Reflect(const uint32_t *code, std::size_t code_size,
+                                                          const char *entry_point) {
+	ShaderReflection ret;
+	if (!ShaderReflectionParser{code, code_size / sizeof(uint32_t)}.Run(entry_point, &ret))
+		return std::nullopt;
+	return ret;
+}
+
+} // namespace myvk
@@ -1,9 +1,16 @@
 #include "Collection.hpp"
 
+#include <algorithm>
+
 namespace myvk_rg_executor {
 
 Collection Collection::Create(const RenderGraphBase &rg) {
 	Collection c;
+	c.m_p_key_interner = &rg.GetKeyInterner();
+	std::size_t key_count = c.m_p_key_interner->GetCount();
+	c.m_passes.reserve(key_count);
+	c.m_inputs.reserve(key_count);
+	c.m_resources.reserve(key_count);
 	c.collect_resources(rg);
 	c.collect_passes(rg);
 	c.make_infos();
@@ -11,23 +18,17 @@ Collection Collection::Create(const RenderGraphBase &rg) {
 }
 
 void Collection::make_infos() {
-	m_resource_infos.reserve(m_resources.size());
-	for (const auto &[_, p_resource] : m_resources) {
-		m_resource_infos.emplace_back();
-		p_resource->__SetPExecutorInfo(&m_resource_infos.back());
-	}
-
-	m_input_infos.reserve(m_inputs.size());
-	for (const auto &[_, p_input] : m_inputs) {
-		m_input_infos.emplace_back();
-		p_input->__SetPExecutorInfo(&m_input_infos.back());
-	}
-
-	m_pass_infos.reserve(m_passes.size());
-	for (const auto &[_, p_pass] : m_passes) {
-		m_pass_infos.emplace_back();
-		p_pass->__SetPExecutorInfo(&m_pass_infos.back());
-	}
+	const auto make = [](const auto &objects, auto *p_infos) {
+		p_infos->reserve(std::ranges::count_if(objects, [](auto *p_object) { return p_object != nullptr; }));
+		for (const auto *p_object : objects)
+			if (p_object) {
+				p_infos->emplace_back();
+				p_object->__SetPExecutorInfo(&p_infos->back());
+			}
+	};
+	make(m_resources, &m_resource_infos);
+	make(m_inputs, &m_input_infos);
+	make(m_passes, &m_pass_infos);
 }
 
 template <typename Container> void Collection::collect_resources(const Container &pool) {
@@ -35,7 +36,7 @@ template <typename Container> void Collection::collect_resources(const Container
 		const auto *p_resource = pool_data.template Get<ResourceBase>();
 		if (p_resource == nullptr)
 			Throw(error::NullResource{.parent = pool.GetGlobalKey()});
-		m_resources[p_resource->GetGlobalKey()] = p_resource;
+		insert(&m_resources, p_resource);
 	}
 }
 
@@ -44,7 +45,7 @@ template <typename Container> void Collection::collect_inputs(const Container &p
 		const auto *p_input = pool_data.template Get<InputBase>();
 		if (p_input == nullptr)
 			Throw(error::NullInput{.parent = pool.GetGlobalKey()});
-		m_inputs[p_input->GetGlobalKey()] = p_input;
+		insert(&m_inputs, p_input);
 	}
 }
 
@@ -62,7 +63,7 @@ template <typename Container> void Collection::collect_passes(const Container &p
 		    [this](const auto *p_pass) {
 			    collect_resources(*p_pass);
 			    collect_inputs(*p_pass);
-			    m_passes[p_pass->GetGlobalKey()] = p_pass;
+			    insert(&m_passes, p_pass);
 		    }));
 	}
 }
@@ -2,8 +2,6 @@
 #ifndef MYVK_RG_COLLECTOR_HPP
 #define MYVK_RG_COLLECTOR_HPP
 
-#include <map>
-
 #include "Error.hpp"
 #include <myvk_rg/interface/RenderGraph.hpp>
 
@@ -15,13 +13,32 @@ using namespace myvk_rg::interface;
 
 class Collection {
 private:
-	std::map<GlobalKey, const PassBase *> m_passes;
-	std::map<GlobalKey, const InputBase *> m_inputs;
-	std::map<GlobalKey, const ResourceBase *> m_resources;
+	const KeyInterner *m_p_key_interner{};
+	// Indexed by key ID, nullptr for keys that are not (or no longer) in the graph
+	std::vector<const PassBase *> m_passes;
+	std::vector<const InputBase *> m_inputs;
+	std::vector<const ResourceBase *> m_resources;
 	mutable std::vector<PassInfo> m_pass_infos;
 	mutable std::vector<InputInfo> m_input_infos;
 	mutable std::vector<ResourceInfo> m_resource_infos;
 
+	template <typename T> static void insert(std::vector<const T *> *p_vec, const std::type_identity_t<T> *p_object) {
+		KeyInterner::IDType id = p_object->GetKeyID();
+		if (id >= p_vec->size())
+			p_vec->resize(id + 1);
+		(*p_vec)[id] = p_object;
+	}
+	template <typename T> static const T *find(const std::vector<const T *> &vec, KeyInterner::Ref ref) {
+		const T *p_object = ref.id < vec.size() ? vec[ref.id] : nullptr;
+		return p_object && p_object->GetKeyRef() == ref ? p_object : nullptr;
+	}
+	// Falls back to the key if the source was removed (and possibly re-created) after the alias was made
+	template <typename T, typename GetKey>
+	const T *find(const std::vector<const T *> &vec, KeyInterner::Ref ref, GetKey &&get_key) const {
+		const T *p_object = find(vec, ref);
+		return p_object ? p_object : find(vec, m_p_key_interner->Find(get_key()));
+	}
+
 	template <typename Container> void collect_resources(const Container &pool);
 	template <typename Container> void collect_passes(const Container &pool);
 	template <typename Container> void collect_inputs(const Container &pool);
@@ -30,23 +47,26 @@ private:
 public:
 	static Collection Create(const RenderGraphBase &rg);
 
-	inline const PassBase *FindPass(const GlobalKey &key) const {
-		auto it = m_passes.find(key);
-		if (it == m_passes.end())
-			Throw(error::PassNotFound{.key = key});
-		return it->second;
+	inline const PassBase *FindSourcePass(const OutputAlias auto &output_alias) const {
+		const PassBase *p_pass = find(m_passes, output_alias.GetSourcePassRef(),
+		                              [&] { return output_alias.GetSourcePassKey(); });
+		if (p_pass == nullptr)
+			Throw(error::PassNotFound{.key = output_alias.GetSourcePassKey()});
+		return p_pass;
 	}
-	inline const InputBase *FindInput(const GlobalKey &key) const {
-		auto it = m_inputs.find(key);
-		if (it == m_inputs.end())
-			Throw(error::InputNotFound{.key = key});
-		return it->second;
+	inline const InputBase *FindSourceInput(const OutputAlias auto &output_alias) const {
+		const InputBase *p_input = find(m_inputs, output_alias.GetSourceRef(),
+		                               [&]() -> const GlobalKey & { return output_alias.GetSourceKey(); });
+		if (p_input == nullptr)
+			Throw(error::InputNotFound{.key = output_alias.GetSourceKey()});
+		return p_input;
 	}
-	inline const ResourceBase *FindResource(const GlobalKey &key) const {
-		auto it = m_resources.find(key);
-		if (it == m_resources.end())
-			Throw(error::ResourceNotFound{.key = key});
-		return it->second;
+	inline const ResourceBase *FindSourceResource(const RawAlias auto &raw_alias) const {
+		const ResourceBase *p_resource = find(m_resources, raw_alias.GetSourceRef(),
+		                                     [&]() -> const GlobalKey & { return raw_alias.GetSourceKey(); });
+		if (p_resource == nullptr)
+			Throw(error::ResourceNotFound{.key = raw_alias.GetSourceKey()});
+		return p_resource;
 	}
 
 	void ClearInfo() const {}
@@ -0,0 +1,266 @@
+#include "CompilePlan.hpp"
+
+#include "VkAllocation.hpp"
+
+#include <cstring>
+#include <unordered_map>
+
+namespace myvk_rg_executor {
+
+CompilePlan CompilePlan::Create(const Args &args) {
+	const auto &dependency = args.dependency;
+
+	std::unordered_map<const InputBase *, InputRef> input_refs;
+	for (const PassBase *p_pass : dependency.GetPasses()) {
+		const auto &inputs = Dependency::GetPassInputs(p_pass);
+		for (uint32_t input_id = 0; input_id < inputs.size(); ++input_id)
+			input_refs[inputs[input_id]] = {.pass_topo_id = (uint32_t)Dependency::GetPassTopoID(p_pass),
+			                                .input_id = input_id};
+	}
+	std::unordered_map<const ResourceBase *, uint32_t> resource_ids;
+	for (const ResourceBase *p_resource : dependency.GetResources())
+		resource_ids.insert({p_resource, (uint32_t)resource_ids.size()});
+
+	const auto make_input_refs = [&](std::span<const InputBase *const> inputs) {
+		std::vector<InputRef> refs;
+		refs.reserve(inputs.size());
+		for (const InputBase *p_input : inputs)
+			refs.push_back(input_refs.at(p_input));
+		return refs;
+	};
+
+	CompilePlan plan = {};
+	plan.m_structural_hash = args.metadata.GetStructuralHash();
+
+	for (uint32_t group_id = 0; const auto &pass_group : args.schedule.GetPassGroups()) {
+		plan.m_pass_group_sizes.push_back(pass_group.subpasses.size());
+		for (const auto &subpass_dep : pass_group.subpass_deps)
+			plan.m_subpass_barriers.push_back({.group_id = group_id,
+			                                   .attachment_id = resource_ids.at(subpass_dep.p_attachment),
+			                                   .src = input_refs.at(subpass_dep.p_src),
+			                                   .dst = input_refs.at(subpass_dep.p_dst)});
+		++group_id;
+	}
+	for (const auto &pass_barrier : args.schedule.GetPassBarriers())
+		plan.m_pass_barriers.push_back({.resource_id = resource_ids.at(pass_barrier.p_resource),
+		                                .src_s = make_input_refs(pass_barrier.src_s),
+		                                .dst_s = make_input_refs(pass_barrier.dst_s),
+		                                .type = pass_barrier.type});
+	for (const ResourceBase *p_resource : dependency.GetResources()) {
+		plan.m_first_inputs.push_back(make_input_refs(Schedule::GetFirstInputs(p_resource)));
+		plan.m_last_inputs.push_back(make_input_refs(Schedule::GetLastInputs(p_resource)));
+	}
+
+	if (args.opt_p_vk_allocation) {
+		plan.m_mem_placements.resize(dependency.GetRootResourceCount());
+		for (const ResourceBase *p_resource : args.metadata.GetIntRootResources())
+			if (VkAllocation::IsMemAliased(p_resource))
+				plan.m_mem_placements[Dependency::GetResourceRootID(p_resource)] = MemPlacement{
+				    .offset = VkAllocation::GetMemOffset(p_resource),
+				    .size = VkAllocation::GetMemRequirements(p_resource).size,
+				    .alignment = VkAllocation::GetMemAlignment(p_resource),
+				    .bucket = VkAllocation::GetMemBucket(p_resource),
+				};
+	}
+
+	return plan;
+}
+
+bool CompilePlan::IsCompatible(const Dependency &dependency, const Metadata &metadata) const {
+	if (m_structural_hash != metadata.GetStructuralHash())
+		return false;
+
+	const std::size_t resource_count = dependency.GetResources().size();
+	if (m_first_inputs.size() != resource_count || m_last_inputs.size() != resource_count)
+		return false;
+	if (!m_mem_placements.empty() && m_mem_placements.size() != dependency.GetRootResourceCount())
+		return false;
+
+	std::size_t pass_count = 0;
+	std::vector<std::size_t> group_begins;
+	group_begins.reserve(m_pass_group_sizes.size());
+	for (uint32_t group_size : m_pass_group_sizes) {
+		// Groups are non-empty, only graphics passes are merged into render passes
+		if (group_size == 0)
+			return false;
+		for (std::size_t topo_id = pass_count; group_size > 1 && topo_id < pass_count + group_size; ++topo_id)
+			if (topo_id >= dependency.GetPassCount() ||
+			    dependency.GetTopoIDPass(topo_id)->GetType() != PassType::kGraphics)
+				return false;
+		group_begins.push_back(pass_count);
+		pass_count += group_size;
+	}
+	if (pass_count != dependency.GetPassCount())
+		return false;
+
+	const auto check_input = [&](InputRef ref) {
+		return ref.pass_topo_id < dependency.GetPassCount() &&
+		       ref.input_id < Dependency::GetPassInputs(dependency.GetTopoIDPass(ref.pass_topo_id)).size();
+	};
+	// Inputs all on the given resource (or on a resource of the same root)
+	const auto check_inputs = [&](const std::vector<InputRef> &refs, const ResourceBase *p_resource, bool same_root) {
+		return std::ranges::all_of(refs, [&](InputRef ref) {
+			if (!check_input(ref))
+				return false;
+			const ResourceBase *p_input_resource = Dependency::GetInputResource(GetInput(dependency, ref));
+			return same_root ? Dependency::GetRootResource(p_input_resource) == Dependency::GetRootResource(p_resource)
+			                 : p_input_resource == p_resource;
+		});
+	};
+
+	// Subpass barriers are between the subpasses of their group, on an image attachment
+	const auto check_group_input = [&](uint32_t group_id, InputRef ref) {
+		return ref.pass_topo_id >= group_begins[group_id] &&
+		       ref.pass_topo_id < group_begins[group_id] + m_pass_group_sizes[group_id] && check_input(ref);
+	};
+	const auto check_subpass_barrier = [&](const SubpassBarrier &b) {
+		return b.group_id < m_pass_group_sizes.size() && b.attachment_id < resource_count &&
+		       dependency.GetResources()[b.attachment_id]->GetType() == ResourceType::kImage &&
+		       check_group_input(b.group_id, b.src) && check_group_input(b.group_id, b.dst);
+	};
+	const auto check_pass_barrier = [&](const PassBarrier &b) {
+		if (b.resource_id >= resource_count || b.type > Schedule::BarrierType::kExtOutput)
+			return false;
+		const ResourceBase *p_resource = dependency.GetResources()[b.resource_id];
+		return check_inputs(b.src_s, p_resource, true) && check_inputs(b.dst_s, p_resource, true);
+	};
+	if (!std::ranges::all_of(m_subpass_barriers, check_subpass_barrier) ||
+	    !std::ranges::all_of(m_pass_barriers, check_pass_barrier))
+		return false;
+	// First inputs are on the resource itself (a combined resource is first accessed through its parts), last inputs
+	// on its root
+	for (std::size_t resource_id = 0; resource_id < resource_count; ++resource_id) {
+		const ResourceBase *p_resource = dependency.GetResources()[resource_id];
+		const auto &first_inputs = m_first_inputs[resource_id], &last_inputs = m_last_inputs[resource_id];
+		if ((first_inputs.empty() && p_resource->GetState() != ResourceState::kCombined) ||
+		    !check_inputs(first_inputs, p_resource, false) || last_inputs.empty() ||
+		    !check_inputs(last_inputs, Dependency::GetRootResource(p_resource), false))
+			return false;
+	}
+	return true;
+}
+
+namespace serialize {
+inline static constexpr char kMagic[8] = {'M', 'Y', 'V', 'K', 'P', 'L', 'A', 'N'};
+inline static constexpr uint32_t kVersion = 2;
+
+class Writer {
+private:
+	std::vector<uint8_t> m_data;
+
+public:
+	template <typename T>
+	    requires std::is_arithmetic_v<T> || std::is_enum_v<T>
+	inline Writer &operator<<(T value) {
+		const auto *p_bytes = reinterpret_cast<const uint8_t *>(&value);
+		m_data.insert(m_data.end(), p_bytes, p_bytes + sizeof(T));
+		return *this;
+	}
+	inline Writer &operator<<(CompilePlan::InputRef ref) { return *this << ref.pass_topo_id << ref.input_id; }
+	template <typename T> inline Writer &operator<<(const std::vector<T> &vec) {
+		*this << (uint32_t)vec.size();
+		for (const auto &value : vec)
+			*this << value;
+		return *this;
+	}
+	inline Writer &operator<<(const CompilePlan::SubpassBarrier &b) {
+		return *this << b.group_id << b.attachment_id << b.src << b.dst;
+	}
+	inline Writer &operator<<(const CompilePlan::PassBarrier &b) {
+		return *this << b.resource_id << b.src_s << b.dst_s << b.type;
+	}
+	inline Writer &operator<<(const std::optional<CompilePlan::MemPlacement> &p) {
+		*this << p.has_value();
+		if (p)
+			*this << p->offset << p->size << p->alignment << p->bucket;
+		return *this;
+	}
+	inline std::vector<uint8_t> Get() && { return std::move(m_data); }
+};
+
+class Reader {
+private:
+	std::span<const uint8_t> m_data;
+	bool m_failed{false};
+
+public:
+	inline explicit Reader(std::span<const uint8_t> data) : m_data{data} {}
+
+	template <typename T>
+	    requires std::is_arithmetic_v<T> || std::is_enum_v<T>
+	inline Reader &operator>>(T &value) {
+		if (m_failed || m_data.size() < sizeof(T)) {
+			m_failed = true;
+			return *this;
+		}
+		std::memcpy(&value, m_data.data(), sizeof(T));
+		m_data = m_data.subspan(sizeof(T));
+		return *this;
+	}
+	inline Reader &operator>>(CompilePlan::InputRef &ref) { return *this >> ref.pass_topo_id >> ref.input_id; }
+	template <typename T> inline Reader &operator>>(std::vector<T> &vec) {
+		uint32_t size{};
+		*this >> size;
+		// Each element takes at least one byte, reject sizes that cannot fit before allocating
+		if (m_failed || size > m_data.size()) {
+			m_failed = true;
+			return *this;
+		}
+		vec.resize(size);
+		for (auto &value : vec)
+			*this >> value;
+		return *this;
+	}
+	inline Reader &operator>>(CompilePlan::SubpassBarrier &b) {
+		return *this >> b.group_id >> b.attachment_id >> b.src >> b.dst;
+	}
+	inline Reader &operator>>(CompilePlan::PassBarrier &b) {
+		return *this >> b.resource_id >> b.src_s >> b.dst_s >> b.type;
+	}
+	inline Reader &operator>>(std::optional<CompilePlan::MemPlacement> &p) {
+		uint8_t has_value{};
+		*this >> has_value;
+		if (has_value > 1)
+			m_failed = true;
+		else if (has_value) {
+			p.emplace();
+			*this >> p->offset >> p->size >> p->alignment >> p->bucket;
+		}
+		return *this;
+	}
+	inline bool IsFailed() const { return m_failed; }
+	inline bool IsEnd() const { return m_data.empty(); }
+};
+} // namespace serialize
+
+std::vector<uint8_t> CompilePlan::Serialize() const {
+	serialize::Writer writer;
+	for (char c : serialize::kMagic)
+		writer << c;
+	writer << serialize::kVersion << m_structural_hash << m_pass_group_sizes << m_subpass_barriers << m_pass_barriers
+	       << m_first_inputs << m_last_inputs << m_mem_placements;
+	return std::move(writer).Get();
+}
+
+std::optional<CompilePlan> CompilePlan::Deserialize(std::span<const uint8_t> data) {
+	serialize::Reader reader{data};
+	for (char c : serialize::kMagic) {
+		char r{};
+		reader >> r;
+		if (r != c)
+			return std::nullopt;
+	}
+	uint32_t version{};
+	reader >> version;
+	if (version != serialize::kVersion)
+		return std::nullopt;
+
+	CompilePlan plan = {};
+	reader >> plan.m_structural_hash >> plan.m_pass_group_sizes >> plan.m_subpass_barriers >> plan.m_pass_barriers >>
+	    plan.m_first_inputs >> plan.m_last_inputs >> plan.m_mem_placements;
+	if (reader.IsFailed() || !reader.IsEnd())
+		return std::nullopt;
+	return plan;
+}
+
+} // namespace myvk_rg_executor
@@ -0,0 +1,82 @@
+#pragma once
+#ifndef MYVK_RG_EXE_DEF_COMPILE_PLAN_HPP
+#define MYVK_RG_EXE_DEF_COMPILE_PLAN_HPP
+
+#include "Schedule.hpp"
+
+#include <optional>
+#include <span>
+
+namespace myvk_rg_executor {
+
+class VkAllocation;
+
+// Serializable compile products of a render graph, tagged with its structural hash
+// Passes are referenced by topological ID, resources by their index in Dependency::GetResources()
+class CompilePlan {
+public:
+	struct InputRef {
+		uint32_t pass_topo_id, input_id; // input_id indexes Dependency::GetPassInputs()
+		inline bool operator==(const InputRef &r) const = default;
+	};
+	struct SubpassBarrier {
+		uint32_t group_id, attachment_id;
+		InputRef src, dst;
+		inline bool operator==(const SubpassBarrier &r) const = default;
+	};
+	struct PassBarrier {
+		uint32_t resource_id;
+		std::vector<InputRef> src_s, dst_s;
+		Schedule::BarrierType type;
+		inline bool operator==(const PassBarrier &r) const = default;
+	};
+	// Placement in the aliased memory, only valid with the same memory requirements and bucket
+	struct MemPlacement {
+		VkDeviceSize offset, size, alignment;
+		uint32_t bucket;
+		inline bool operator==(const MemPlacement &r) const = default;
+	};
+
+private:
+	struct Args {
+		const Dependency &dependency;
+		const Metadata &metadata;
+		const Schedule &schedule;
+		const VkAllocation *opt_p_vk_allocation{};
+	};
+
+	uint64_t m_structural_hash{};
+	std::vector<uint32_t> m_pass_group_sizes;
+	std::vector<SubpassBarrier> m_subpass_barriers;
+	std::vector<PassBarrier> m_pass_barriers;
+	std::vector<std::vector<InputRef>> m_first_inputs, m_last_inputs;
+	std::vector<std::optional<MemPlacement>> m_mem_placements; // Indexed by root ID
+
+public:
+	static CompilePlan Create(const Args &args);
+
+	std::vector<uint8_t> Serialize() const;
+	// Returns std::nullopt if the data is malformed or of another version
+	static std::optional<CompilePlan> Deserialize(std::span<const uint8_t> data);
+
+	// Whether the plan can be applied to the compiled dependency (hash, indices and resource types match)
+	bool IsCompatible(const Dependency &dependency, const Metadata &metadata) const;
+
+	inline uint64_t GetStructuralHash() const { return m_structural_hash; }
+	// Subpass counts of pass groups, consecutive in topological order
+	inline const auto &GetPassGroupSizes() const { return m_pass_group_sizes; }
+	inline const auto &GetSubpassBarriers() const { return m_subpass_barriers; }
+	inline const auto &GetPassBarriers() const { return m_pass_barriers; }
+	inline const auto &GetFirstInputs() const { return m_first_inputs; }
+	inline const auto &GetLastInputs() const { return m_last_inputs; }
+	inline const auto &GetMemPlacements() const { return m_mem_placements; }
+	inline static const InputBase *GetInput(const Dependency &dependency, InputRef ref) {
+		return Dependency::GetPassInputs(dependency.GetTopoIDPass(ref.pass_topo_id))[ref.input_id];
+	}
+
+	inline bool operator==(const CompilePlan &r) const = default;
+};
+
+} // namespace myvk_rg_executor
+
+#endif
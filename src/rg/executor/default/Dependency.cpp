@@ -27,8 +27,8 @@ Dependency Dependency::Create(const Args &args) {
 }
 
 const InputBase *Dependency::traverse_output_alias(const Dependency::Args &args, const OutputAlias auto &output_alias) {
-	const PassBase *p_src_pass = args.collection.FindPass(output_alias.GetSourcePassKey());
-	const InputBase *p_src_input = args.collection.FindInput(output_alias.GetSourceKey());
+	const PassBase *p_src_pass = args.collection.FindSourcePass(output_alias);
+	const InputBase *p_src_input = args.collection.FindSourceInput(output_alias);
 	traverse_pass(args, p_src_pass);
 	return p_src_input;
 }
@@ -59,7 +59,7 @@ void Dependency::traverse_pass(const Args &args, const PassBase *p_pass) {
 				    m_pass_graph.AddEdge(p_src_pass, p_pass, PassEdge{p_src_input, p_input, p_resource});
 			    },
 			    [&](const RawAlias auto *p_raw_alias) {
-				    const ResourceBase *p_resource = args.collection.FindResource(p_raw_alias->GetSourceKey());
+				    const ResourceBase *p_resource = args.collection.FindSourceResource(*p_raw_alias);
 				    m_resource_graph.AddVertex(p_resource);
 				    get_dep_info(p_input).p_resource = p_resource;
 
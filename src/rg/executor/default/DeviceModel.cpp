@@ -0,0 +1,58 @@
+#include "DeviceModel.hpp"
+
+#include <algorithm>
+
+namespace myvk_rg_executor {
+
+DeviceModel DeviceModel::FromDevice(const myvk::Ptr<myvk::Device> &device) {
+	const auto &physical_device = device->GetPhysicalDevicePtr();
+	const VkPhysicalDeviceLimits &limits = physical_device->GetProperties().vk10.limits;
+	const VkPhysicalDeviceMemoryProperties &memory_properties = physical_device->GetMemoryProperties();
+
+	DeviceModel model = {
+	    .buffer_image_granularity = limits.bufferImageGranularity,
+	    .min_uniform_buffer_offset_alignment = limits.minUniformBufferOffsetAlignment,
+	    .min_storage_buffer_offset_alignment = limits.minStorageBufferOffsetAlignment,
+	    .min_texel_buffer_offset_alignment = limits.minTexelBufferOffsetAlignment,
+	};
+	for (uint32_t i = 0; i < memory_properties.memoryTypeCount; ++i)
+		model.memory_types.push_back(memory_properties.memoryTypes[i].propertyFlags);
+
+	model.get_image_requirements = [device](const VkImageCreateInfo &create_info) {
+		VkDeviceImageMemoryRequirements info = {VK_STRUCTURE_TYPE_DEVICE_IMAGE_MEMORY_REQUIREMENTS};
+		info.pCreateInfo = &create_info;
+		VkMemoryRequirements2 reqs = {VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2};
+		vkGetDeviceImageMemoryRequirements(device->GetHandle(), &info, &reqs);
+		return reqs.memoryRequirements;
+	};
+	model.get_buffer_requirements = [device](const VkBufferCreateInfo &create_info) {
+		VkDeviceBufferMemoryRequirements info = {VK_STRUCTURE_TYPE_DEVICE_BUFFER_MEMORY_REQUIREMENTS};
+		info.pCreateInfo = &create_info;
+		VkMemoryRequirements2 reqs = {VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2};
+		vkGetDeviceBufferMemoryRequirements(device->GetHandle(), &info, &reqs);
+		return reqs.memoryRequirements;
+	};
+	return model;
+}
+
+uint32_t DeviceModel::FindMemoryType(uint32_t memory_type_bits, VkMemoryPropertyFlags required_flags) const {
+	for (uint32_t i = 0; i < memory_types.size(); ++i)
+		if ((memory_type_bits >> i & 1u) && (memory_types[i] & required_flags) == required_flags)
+			return i;
+	return UINT32_MAX;
+}
+
+VkDeviceSize DeviceModel::GetBufferOffsetAlignment(VkBufferUsageFlags usages) const {
+	VkDeviceSize alignment = 4; // vkCmdFillBuffer and indirect arguments
+	if (usages & VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT)
+		alignment = std::max(alignment, min_uniform_buffer_offset_alignment);
+	if (usages & VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)
+		alignment = std::max(alignment, min_storage_buffer_offset_alignment);
+	if (usages & (VK_BUFFER_USAGE_UNIFORM_TEXEL_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_TEXEL_BUFFER_BIT))
+		alignment = std::max(alignment, min_texel_buffer_offset_alignment);
+	if (usages & VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR)
+		alignment = std::max(alignment, VkDeviceSize{256});
+	return alignment;
+}
+
+} // namespace myvk_rg_executor
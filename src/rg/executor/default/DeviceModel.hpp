@@ -0,0 +1,36 @@
+#pragma once
+#ifndef MYVK_RG_EXE_DEF_DEVICE_MODEL_HPP
+#define MYVK_RG_EXE_DEF_DEVICE_MODEL_HPP
+
+#include <myvk/Device.hpp>
+
+#include <functional>
+#include <vector>
+
+namespace myvk_rg_executor {
+
+// Device properties memory planning depends on, read from a device or given as a mock table to plan without one
+struct DeviceModel {
+	using ImageRequirementsFunc = std::function<VkMemoryRequirements(const VkImageCreateInfo &)>;
+	using BufferRequirementsFunc = std::function<VkMemoryRequirements(const VkBufferCreateInfo &)>;
+
+	VkDeviceSize buffer_image_granularity{1};
+	VkDeviceSize min_uniform_buffer_offset_alignment{1}, min_storage_buffer_offset_alignment{1},
+	    min_texel_buffer_offset_alignment{1};
+	std::vector<VkMemoryPropertyFlags> memory_types; // Property flags of each memory type index
+	ImageRequirementsFunc get_image_requirements;
+	BufferRequirementsFunc get_buffer_requirements;
+
+	// Requirements are queried with vkGetDevice{Image,Buffer}MemoryRequirements, without creating objects
+	static DeviceModel FromDevice(const myvk::Ptr<myvk::Device> &device);
+
+	// The lowest memory type index in memory_type_bits with the required flags, UINT32_MAX if none
+	// Planning pins each allocation to this type, so the real backend selects it too instead of leaving it to VMA
+	uint32_t FindMemoryType(uint32_t memory_type_bits, VkMemoryPropertyFlags required_flags) const;
+	// Alignment of a buffer with the usages at an offset of another buffer
+	VkDeviceSize GetBufferOffsetAlignment(VkBufferUsageFlags usages) const;
+};
+
+} // namespace myvk_rg_executor
+
+#endif
@@ -1,14 +1,20 @@
 #include <myvk_rg/executor/Executor.hpp>
 
 #include "Collection.hpp"
+#include "CompilePlan.hpp"
 #include "Dependency.hpp"
 #include "Metadata.hpp"
+#include "ResourcePool.hpp"
 #include "Schedule.hpp"
 #include "VkAllocation.hpp"
 #include "VkCommand.hpp"
 #include "VkDescriptor.hpp"
 #include "VkRunner.hpp"
 
+#include <myvk_rg/executor/Trace.hpp>
+
+#include <list>
+
 namespace myvk_rg::executor {
 
 enum CompileFlag : uint8_t {
@@ -23,8 +29,10 @@ enum CompileFlag : uint8_t {
 
 using interface::overloaded;
 using myvk_rg_executor::Collection;
+using myvk_rg_executor::CompilePlan;
 using myvk_rg_executor::Dependency;
 using myvk_rg_executor::Metadata;
+using myvk_rg_executor::ResourcePool;
 using myvk_rg_executor::Schedule;
 using myvk_rg_executor::VkAllocation;
 using myvk_rg_executor::VkCommand;
@@ -32,6 +40,9 @@ using myvk_rg_executor::VkDescriptor;
 using myvk_rg_executor::VkRunner;
 
 struct Executor::CompileInfo {
+	// Declared first to outlive everything that recycles into it
+	myvk::Ptr<ResourcePool> resource_pool = ResourcePool::Create();
+
 	Collection collection;
 	Dependency dependency;
 	Metadata metadata;
@@ -39,9 +50,24 @@ struct Executor::CompileInfo {
 	VkAllocation vk_allocation;
 	VkCommand vk_command;
 	VkDescriptor vk_descriptor;
+
+	bool compiled{false};
+	std::optional<CompilePlan> loaded_plan;
+	inline const CompilePlan *GetCompatiblePlan() const {
+		return loaded_plan && loaded_plan->IsCompatible(dependency, metadata) ? &*loaded_plan : nullptr;
+	}
+
+	// Most recently used first
+	std::list<std::pair<uint64_t, VkAllocation::Snapshot>> plan_cache;
+	inline void TrimPlanCache(std::size_t capacity) {
+		while (plan_cache.size() > capacity)
+			plan_cache.pop_back();
+	}
 };
 
-Executor::Executor(interface::Parent parent) : interface::ObjectBase(parent), m_p_compile_info{new CompileInfo{}} {}
+Executor::Executor(interface::Parent parent) : interface::ObjectBase(parent), m_p_compile_info{new CompileInfo{}} {
+	m_resource_pool_max_idle_frames = m_p_compile_info->resource_pool->GetMaxIdleFrames();
+}
 Executor::~Executor() { delete m_p_compile_info; }
 
 void Executor::OnEvent(interface::ObjectBase *p_object, interface::Event event) {
@@ -94,6 +120,8 @@ void Executor::compile(const interface::RenderGraphBase *p_render_graph, const m
 	if (m_compile_flags == 0)
 		return;
 
+	TraceSpan compile_span{"compile", "Compile"};
+
 	uint8_t exe_compile_flags = m_compile_flags;
 	if (m_compile_flags & kCollection)
 		exe_compile_flags |= kDependency | kMetadata | kSchedule | kVkAllocation | kVkCommand | kVkDescriptor;
@@ -107,34 +135,71 @@ void Executor::compile(const interface::RenderGraphBase *p_render_graph, const m
 		exe_compile_flags |= kVkCommand | kVkDescriptor;
 	m_compile_flags = 0u;
 
-	if (exe_compile_flags & kCollection)
+	if (exe_compile_flags & kCollection) {
+		TraceSpan span{"compile", "Collection"};
 		m_p_compile_info->collection = Collection::Create(*p_render_graph);
-	if (exe_compile_flags & kDependency)
+	}
+	if (exe_compile_flags & kDependency) {
+		TraceSpan span{"compile", "Dependency"};
 		m_p_compile_info->dependency =
 		    Dependency::Create({.render_graph = *p_render_graph, .collection = m_p_compile_info->collection});
-	if (exe_compile_flags & kMetadata)
+	}
+	if (exe_compile_flags & kMetadata) {
+		TraceSpan span{"compile", "Metadata"};
 		m_p_compile_info->metadata = Metadata::Create({.render_graph = *p_render_graph,
 		                                               .collection = m_p_compile_info->collection,
 		                                               .dependency = m_p_compile_info->dependency});
-	if (exe_compile_flags & kSchedule)
-		m_p_compile_info->schedule = Schedule::Create({.render_graph = *p_render_graph,
-		                                               .collection = m_p_compile_info->collection,
-		                                               .dependency = m_p_compile_info->dependency,
-		                                               .metadata = m_p_compile_info->metadata});
-	if (exe_compile_flags & kVkAllocation)
-		m_p_compile_info->vk_allocation =
-		    VkAllocation::Create(queue->GetDevicePtr(), {.render_graph = *p_render_graph,
-		                                                 .collection = m_p_compile_info->collection,
-		                                                 .dependency = m_p_compile_info->dependency,
-		                                                 .metadata = m_p_compile_info->metadata});
-	if (exe_compile_flags & kVkDescriptor)
+	}
+	if (exe_compile_flags & kSchedule) {
+		TraceSpan span{"compile", "Schedule"};
+		const Schedule::Args args = {.render_graph = *p_render_graph,
+		                             .collection = m_p_compile_info->collection,
+		                             .dependency = m_p_compile_info->dependency,
+		                             .metadata = m_p_compile_info->metadata};
+		const CompilePlan *p_plan = m_p_compile_info->GetCompatiblePlan();
+		m_p_compile_info->schedule = p_plan ? Schedule::Restore(args, *p_plan) : Schedule::Create(args);
+	}
+	if (exe_compile_flags & kVkAllocation) {
+		TraceSpan span{"compile", "VkAllocation"};
+		// Descriptors and framebuffers of the previous compile reference its images, release them first so that
+		// the images and memory return to the resource pool before the new allocation draws from it
+		m_p_compile_info->vk_descriptor = {};
+		m_p_compile_info->vk_command = {};
+		const VkAllocation::Args args = {.render_graph = *p_render_graph,
+		                                 .collection = m_p_compile_info->collection,
+		                                 .dependency = m_p_compile_info->dependency,
+		                                 .metadata = m_p_compile_info->metadata,
+		                                 .resource_pool = *m_p_compile_info->resource_pool,
+		                                 .opt_p_plan = m_p_compile_info->GetCompatiblePlan(),
+		                                 .opt_p_transient_heap = m_transient_heap.get(),
+		                                 .buffer_pack_max_size = m_buffer_pack_max_size,
+		                                 .alias_mapped_buffers = m_alias_mapped_buffers,
+		                                 .alias_barrier_weight = get_alias_barrier_weight()};
+		auto &plan_cache = m_p_compile_info->plan_cache;
+		uint64_t hash = m_p_compile_info->metadata.GetStructuralHash();
+		auto it = std::find_if(plan_cache.begin(), plan_cache.end(), [&](const auto &e) { return e.first == hash; });
+		if (it != plan_cache.end()) {
+			plan_cache.splice(plan_cache.begin(), plan_cache, it);
+			m_p_compile_info->vk_allocation = VkAllocation::Restore(queue->GetDevicePtr(), args, it->second);
+		} else {
+			m_p_compile_info->vk_allocation = VkAllocation::Create(queue->GetDevicePtr(), args);
+			if (std::size_t capacity = get_plan_cache_capacity()) {
+				plan_cache.emplace_front(hash, m_p_compile_info->vk_allocation.MakeSnapshot(args));
+				m_p_compile_info->TrimPlanCache(capacity);
+			}
+		}
+	}
+	if (exe_compile_flags & kVkDescriptor) {
+		TraceSpan span{"compile", "VkDescriptor"};
 		m_p_compile_info->vk_descriptor =
 		    VkDescriptor::Create(queue->GetDevicePtr(), {.render_graph = *p_render_graph,
 		                                                 .collection = m_p_compile_info->collection,
 		                                                 .dependency = m_p_compile_info->dependency,
 		                                                 .metadata = m_p_compile_info->metadata,
 		                                                 .vk_allocation = m_p_compile_info->vk_allocation});
-	if (exe_compile_flags & kVkCommand)
+	}
+	if (exe_compile_flags & kVkCommand) {
+		TraceSpan span{"compile", "VkCommand"};
 		m_p_compile_info->vk_command =
 		    VkCommand::Create(queue->GetDevicePtr(), {.render_graph = *p_render_graph,
 		                                              .collection = m_p_compile_info->collection,
@@ -142,7 +207,13 @@ void Executor::compile(const interface::RenderGraphBase *p_render_graph, const m
 		                                              .metadata = m_p_compile_info->metadata,
 		                                              .schedule = m_p_compile_info->schedule,
 		                                              .vk_allocation = m_p_compile_info->vk_allocation});
+	}
 
+	if (exe_compile_flags & (kVkAllocation | kVkDescriptor))
+		m_vk_objects_named = false;
+	m_p_compile_info->compiled = true;
+
+	TraceSpan vk_runner_span{"compile", "VkRunner"};
 	VkRunner::Create({.render_graph = *p_render_graph,
 	                  .collection = m_p_compile_info->collection,
 	                  .dependency = m_p_compile_info->dependency,
@@ -156,16 +227,136 @@ void Executor::compile(const interface::RenderGraphBase *p_render_graph, const m
 void Executor::CmdExecute(const interface::RenderGraphBase *p_render_graph,
                           const myvk::Ptr<myvk::CommandBuffer> &command_buffer) {
 	const auto &queue = command_buffer->GetCommandPoolPtr()->GetQueuePtr();
+	apply_memory_pressure();
+	if (m_transient_heap && m_transient_heap->GetGeneration() != m_transient_heap_generation)
+		m_compile_flags |= kVkAllocation; // Follow the reallocated heap
 	compile(p_render_graph, queue);
+	if (m_transient_heap)
+		m_transient_heap_generation = m_transient_heap->GetGeneration();
 	p_render_graph->PreExecute();
-	VkRunner::Run(command_buffer, {.render_graph = *p_render_graph,
-	                               .collection = m_p_compile_info->collection,
-	                               .dependency = m_p_compile_info->dependency,
-	                               .metadata = m_p_compile_info->metadata,
-	                               .schedule = m_p_compile_info->schedule,
-	                               .vk_allocation = m_p_compile_info->vk_allocation,
-	                               .vk_command = m_p_compile_info->vk_command,
-	                               .vk_descriptor = m_p_compile_info->vk_descriptor});
+
+	const VkRunner::Args runner_args = {.render_graph = *p_render_graph,
+	                                    .collection = m_p_compile_info->collection,
+	                                    .dependency = m_p_compile_info->dependency,
+	                                    .metadata = m_p_compile_info->metadata,
+	                                    .schedule = m_p_compile_info->schedule,
+	                                    .vk_allocation = m_p_compile_info->vk_allocation,
+	                                    .vk_command = m_p_compile_info->vk_command,
+	                                    .vk_descriptor = m_p_compile_info->vk_descriptor};
+	if (m_debug_utils && !m_vk_objects_named) {
+		VkRunner::SetVkObjectNames(queue->GetDevicePtr(), runner_args);
+		m_vk_objects_named = true;
+	}
+	VkRunner::Run(command_buffer, runner_args, m_profiler.get(), m_debug_utils, &m_pipeline_creation_records);
+	m_p_compile_info->resource_pool->NextFrame();
+}
+
+void Executor::EnableProfiler(uint32_t frame_latency, std::size_t window,
+                              VkQueryPipelineStatisticFlags statistic_flags) {
+	m_profiler = myvk::MakeUPtr<Profiler>(frame_latency, window, statistic_flags);
+}
+void Executor::DisableProfiler() { m_profiler.reset(); }
+
+void Executor::SetPlanCacheCapacity(std::size_t capacity) {
+	m_plan_cache_capacity = capacity;
+	m_p_compile_info->TrimPlanCache(get_plan_cache_capacity());
+}
+void Executor::SetTransientHeap(const myvk::Ptr<TransientHeap> &transient_heap) {
+	if (m_transient_heap == transient_heap)
+		return;
+	m_transient_heap = transient_heap;
+	m_compile_flags |= kVkAllocation;
+}
+void Executor::SetBufferPackMaxSize(VkDeviceSize max_size) {
+	if (m_buffer_pack_max_size == max_size)
+		return;
+	m_buffer_pack_max_size = max_size;
+	m_p_compile_info->plan_cache.clear(); // Cached allocations are of the previous packing
+	m_compile_flags |= kVkAllocation;
+}
+void Executor::SetMappedBufferAliasing(bool alias) {
+	if (m_alias_mapped_buffers == alias)
+		return;
+	m_alias_mapped_buffers = alias;
+	m_p_compile_info->plan_cache.clear(); // Cached allocations are of the previous placement
+	m_compile_flags |= kVkAllocation;
+}
+void Executor::SetAliasBarrierWeight(float weight) {
+	if (m_alias_barrier_weight == weight)
+		return;
+	m_alias_barrier_weight = weight;
+	m_p_compile_info->plan_cache.clear(); // Cached allocations are of the previous placement
+	m_compile_flags |= kVkAllocation;
+}
+AliasBarrierStats Executor::GetAliasBarrierStats() const {
+	const auto &vk_allocation = m_p_compile_info->vk_allocation;
+	return {.barrier_count = vk_allocation.GetAliasBarrierCount(),
+	        .serialization = vk_allocation.GetAliasSerialization()};
+}
+void Executor::SetResourcePoolMaxIdleFrames(uint32_t frames) {
+	m_resource_pool_max_idle_frames = frames;
+	m_p_compile_info->resource_pool->SetMaxIdleFrames(get_resource_pool_max_idle_frames());
+}
+uint32_t Executor::GetResourcePoolMaxIdleFrames() const { return m_resource_pool_max_idle_frames; }
+void Executor::SetMemoryBudget(const myvk::Ptr<myvk::MemoryBudget> &memory_budget) {
+	m_memory_budget = memory_budget;
+	apply_memory_pressure();
+}
+
+float Executor::get_alias_barrier_weight() const {
+	return m_memory_pressure >= myvk::MemoryBudget::Pressure::kHigh ? 0.0f : m_alias_barrier_weight;
+}
+std::size_t Executor::get_plan_cache_capacity() const {
+	switch (m_memory_pressure) {
+	case myvk::MemoryBudget::Pressure::kNormal:
+		return m_plan_cache_capacity;
+	case myvk::MemoryBudget::Pressure::kHigh:
+		return std::min(m_plan_cache_capacity, std::size_t{1});
+	default:
+		return 0;
+	}
+}
+uint32_t Executor::get_resource_pool_max_idle_frames() const {
+	switch (m_memory_pressure) {
+	case myvk::MemoryBudget::Pressure::kNormal:
+		return m_resource_pool_max_idle_frames;
+	case myvk::MemoryBudget::Pressure::kHigh:
+		return std::min(m_resource_pool_max_idle_frames, 1u);
+	default:
+		return 0;
+	}
+}
+void Executor::apply_memory_pressure() {
+	auto pressure = m_memory_budget ? m_memory_budget->GetPressure() : myvk::MemoryBudget::Pressure::kNormal;
+	if (m_memory_pressure == pressure)
+		return;
+	float prev_alias_barrier_weight = get_alias_barrier_weight();
+	m_memory_pressure = pressure;
+	if (get_alias_barrier_weight() != prev_alias_barrier_weight) {
+		m_p_compile_info->plan_cache.clear(); // Cached allocations are of the previous placement
+		m_compile_flags |= kVkAllocation;
+	}
+	m_p_compile_info->TrimPlanCache(get_plan_cache_capacity());
+	m_p_compile_info->resource_pool->SetMaxIdleFrames(get_resource_pool_max_idle_frames());
+}
+uint64_t Executor::GetStructuralHash() const { return m_p_compile_info->metadata.GetStructuralHash(); }
+
+std::vector<uint8_t> Executor::SerializePlan() const {
+	if (!m_p_compile_info->compiled)
+		return {};
+	return CompilePlan::Create({.dependency = m_p_compile_info->dependency,
+	                            .metadata = m_p_compile_info->metadata,
+	                            .schedule = m_p_compile_info->schedule,
+	                            .opt_p_vk_allocation = &m_p_compile_info->vk_allocation})
+	    .Serialize();
+}
+bool Executor::LoadPlan(std::span<const uint8_t> data) {
+	auto opt_plan = CompilePlan::Deserialize(data);
+	if (!opt_plan)
+		return false;
+	m_p_compile_info->loaded_plan = std::move(opt_plan);
+	m_compile_flags |= kSchedule | kVkAllocation; // Memory placements are part of the plan as well
+	return true;
 }
 
 const myvk::Ptr<myvk::ImageView> &Executor::GetVkImageView(const interface::ManagedImage *p_managed_image) {
@@ -73,6 +73,14 @@ struct PassInfo {
 		bool update_pipeline{true};
 		myvk::Ptr<myvk::PipelineBase> vk_pipeline;
 	} vk_command{};
+
+	// VkRunner
+	struct {
+		friend class VkRunner;
+
+	private:
+		std::string debug_label, group_debug_label;
+	} vk_runner{};
 };
 
 class RGMemoryAllocation;
@@ -100,6 +108,8 @@ struct ResourceInfo {
 		struct {
 			bool mapped{false};
 			VkBufferUsageFlags vk_usages{};
+			// Host accesses around the execution: data is read before any GPU write, or GPU writes may be read back
+			bool host_written{false}, host_read{false};
 		} buffer_alloc;
 		struct {
 			SubImageSize size{};
@@ -125,17 +135,23 @@ struct ResourceInfo {
 
 	private:
 		struct {
+			VkImageCreateInfo vk_create_info{};
 			myvk::Ptr<myvk::ImageBase> myvk_image{};
 			myvk::Ptr<myvk::ImageView> myvk_image_view{};
 		} image{};
 		struct {
+			VkBufferCreateInfo vk_create_info{};
 			myvk::Ptr<myvk::BufferBase> myvk_buffer{};
 			BufferView buffer_view{};
 			void *p_mapped{};
+			VkDeviceSize base_offset{}; // Offset of the root buffer in myvk_buffer
+			bool packed{};              // Shares a backing buffer with others
 		} buffer{};
 		VkMemoryRequirements vk_mem_reqs{};
 		myvk::Ptr<RGMemoryAllocation> myvk_mem_alloc{};
-		VkDeviceSize mem_offset{};
+		VkDeviceSize mem_offset{}, mem_alignment{};
+		uint32_t mem_bucket{};
+		bool mem_aliased{}, mem_shared{};
 	} vk_allocation{};
 
 	// VkRunner
@@ -145,6 +161,7 @@ struct ResourceInfo {
 	private:
 		myvk::Ptr<myvk::ImageView> ext_image_view_cache{};
 		BufferView ext_buffer_view_cache{};
+		VkBuffer ext_buffer_handle_cache{}; // Changes in place when a myvk::Defragmenter moves the buffer
 		bool ext_changed{};
 	} vk_runner{};
 };
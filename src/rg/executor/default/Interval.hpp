@@ -0,0 +1,41 @@
+#pragma once
+#ifndef MYVK_RG_EXE_DEF_INTERVAL_HPP
+#define MYVK_RG_EXE_DEF_INTERVAL_HPP
+
+#include <algorithm>
+#include <cinttypes>
+#include <functional>
+#include <numeric>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace myvk_rg_executor {
+
+// Calls func(i, j) once for each pair of overlapping half-open intervals [first, second), empty intervals overlap
+// nothing. Sweeps the intervals by their beginning with a min-heap of the active ends, O(N log N + K) for K pairs.
+template <typename T> inline void ForEachIntervalOverlap(std::span<const std::pair<T, T>> intervals, auto &&func) {
+	std::vector<std::size_t> order(intervals.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::ranges::sort(order, [&](std::size_t l, std::size_t r) { return intervals[l].first < intervals[r].first; });
+
+	std::vector<std::pair<T, std::size_t>> active; // (end, index) heap, the smallest end on top
+	for (std::size_t i : order) {
+		const auto &[begin, end] = intervals[i];
+		if (begin >= end)
+			continue;
+		while (!active.empty() && active.front().first <= begin) {
+			std::ranges::pop_heap(active, std::greater{});
+			active.pop_back();
+		}
+		// All intervals left end after the beginning, and begin no later than it
+		for (const auto &[_, j] : active)
+			func(j, i);
+		active.emplace_back(end, i);
+		std::ranges::push_heap(active, std::greater{});
+	}
+}
+
+} // namespace myvk_rg_executor
+
+#endif
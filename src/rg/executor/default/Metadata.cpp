@@ -18,6 +18,7 @@ Metadata Metadata::Create(const Args &args) {
 	fetch_alloc_usages(args);
 	r.propagate_alloc_info(args);
 	fetch_render_areas(args);
+	r.make_structural_hash(args);
 	return r;
 }
 
@@ -173,13 +174,24 @@ void Metadata::fetch_alloc_sizes(const Args &args) {
 }
 
 void Metadata::fetch_alloc_usages(const Args &args) {
+	// Passes are in topological order, so a buffer read before any GPU write to it holds data written by the host
+	std::vector<bool> gpu_written(args.dependency.GetRootResourceCount());
 	for (const auto *p_pass : args.dependency.GetPasses()) {
 		for (const InputBase *p_input : Dependency::GetPassInputs(p_pass))
 			Dependency::GetInputResource(p_input)->Visit(overloaded(
-			    [&](const InternalResource auto *p_resource) {
-				    get_alloc(Dependency::GetRootResource(p_resource)).vk_usages |=
+			    [&](const InternalImage auto *p_image) {
+				    get_alloc(Dependency::GetRootResource(p_image)).vk_usages |=
 				        UsageGetCreationUsages(p_input->GetUsage());
 			    },
+			    [&](const InternalBuffer auto *p_buffer) {
+				    const BufferBase *p_root = Dependency::GetRootResource(p_buffer);
+				    auto &alloc = get_alloc(p_root);
+				    alloc.vk_usages |= UsageGetCreationUsages(p_input->GetUsage());
+				    alloc.host_written |= UsageGetReadAccessFlags(p_input->GetUsage()) &&
+				                          !gpu_written[Dependency::GetResourceRootID(p_root)];
+				    if (!UsageIsReadOnly(p_input->GetUsage()))
+					    alloc.host_read = gpu_written[Dependency::GetResourceRootID(p_root)] = true;
+			    },
 			    [](auto &&) {}));
 	}
 }
@@ -218,4 +230,85 @@ void Metadata::fetch_render_areas(const Metadata::Args &args) {
 		p_pass->Visit(overloaded(graphics_pass_visitor, [](auto &&) {}));
 }
 
+namespace structural_hash {
+// 64-bit FNV-1a, independent of std::hash so that the result can be persisted
+class Hasher {
+private:
+	uint64_t m_hash{0xcbf29ce484222325ull};
+
+public:
+	template <typename T>
+	    requires std::is_arithmetic_v<T> || std::is_enum_v<T>
+	inline Hasher &operator<<(T value) {
+		const auto *p_bytes = reinterpret_cast<const uint8_t *>(&value);
+		for (std::size_t i = 0; i < sizeof(T); ++i)
+			m_hash = (m_hash ^ p_bytes[i]) * 0x100000001b3ull;
+		return *this;
+	}
+	inline Hasher &operator<<(const GlobalKey &key) {
+		std::string str = key.Format();
+		*this << str.size();
+		for (char c : str)
+			*this << c;
+		return *this;
+	}
+	inline Hasher &operator<<(const SubImageSize &size) {
+		return *this << size.GetExtent().width << size.GetExtent().height << size.GetExtent().depth
+		             << size.GetArrayLayers() << size.GetBaseMipLevel() << size.GetMipLevels();
+	}
+	inline uint64_t Get() const { return m_hash; }
+};
+} // namespace structural_hash
+
+void Metadata::make_structural_hash(const Args &args) {
+	structural_hash::Hasher hasher;
+
+	hasher << args.dependency.GetPasses().size();
+	for (const PassBase *p_pass : args.dependency.GetPasses()) {
+		hasher << p_pass->GetGlobalKey() << p_pass->GetType();
+		if (p_pass->GetType() == PassType::kGraphics) {
+			RenderPassArea area = get_meta(p_pass).render_area;
+			hasher << area.extent.width << area.extent.height << area.layers;
+		}
+
+		const auto &inputs = Dependency::GetPassInputs(p_pass);
+		hasher << inputs.size();
+		for (const InputBase *p_input : inputs) {
+			const ResourceBase *p_resource = Dependency::GetInputResource(p_input);
+			hasher << p_input->GetGlobalKey() << p_input->GetUsage() << p_input->GetPipelineStages()
+			       << p_input->GetInputAlias().GetState() << p_input->GetInputAlias().GetSourceKey()
+			       << p_resource->GetGlobalKey();
+			const auto &opt_descriptor_index = p_input->GetOptDescriptorIndex();
+			hasher << opt_descriptor_index.has_value();
+			if (opt_descriptor_index)
+				hasher << opt_descriptor_index->binding << opt_descriptor_index->array_element;
+			p_input->Visit(overloaded(
+			    [&](const ImageInput *p_image_input) {
+				    const auto &opt_attachment_index = p_image_input->GetOptAttachmentIndex();
+				    hasher << opt_attachment_index.value_or(-1);
+			    },
+			    [](auto &&) {}));
+		}
+	}
+
+	hasher << args.dependency.GetResources().size();
+	for (const ResourceBase *p_resource : args.dependency.GetResources()) {
+		hasher << p_resource->GetGlobalKey() << p_resource->GetClass() << Dependency::GetResourceRootID(p_resource)
+		       << Dependency::IsRootResource(p_resource);
+		p_resource->Visit(overloaded(
+		    [&](const ImageBase *p_image) {
+			    const auto &alloc = get_alloc(p_image);
+			    const auto &view = get_view(p_image);
+			    hasher << alloc.vk_type << alloc.vk_format << alloc.vk_usages << view.size << view.base_layer;
+		    },
+		    [&](const BufferBase *p_buffer) {
+			    const auto &alloc = get_alloc(p_buffer);
+			    const auto &view = get_view(p_buffer);
+			    hasher << alloc.mapped << alloc.vk_usages << view.offset << view.size;
+		    }));
+	}
+
+	m_structural_hash = hasher.Get();
+}
+
 } // namespace myvk_rg_executor
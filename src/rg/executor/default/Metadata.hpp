@@ -19,6 +19,7 @@ private:
 	};
 
 	std::vector<const ResourceBase *> m_internal_root_resources, m_internal_resources, m_external_resources;
+	uint64_t m_structural_hash{};
 
 	static auto get_size(const Args &args, const auto &size_variant);
 	static void combine_image(const Metadata::Args &args, const InternalImage auto *p_alloc_image);
@@ -30,6 +31,7 @@ private:
 	static void fetch_alloc_usages(const Args &args);
 	void propagate_alloc_info(const Args &args);
 	static void fetch_render_areas(const Args &args);
+	void make_structural_hash(const Args &args);
 
 	static auto &get_meta(const PassBase *p_pass) { return GetPassInfo(p_pass).metadata; }
 	static auto &get_meta(const ResourceBase *p_resource) { return GetResourceInfo(p_resource).metadata; }
@@ -56,6 +58,9 @@ public:
 
 	// Pass RenderArea
 	static RenderPassArea GetPassRenderArea(const PassBase *p_pass) { return get_meta(p_pass).render_area; }
+
+	// Hash of keys, inputs, usages, resource descriptions and resolved sizes, stable across runs and devices
+	inline uint64_t GetStructuralHash() const { return m_structural_hash; }
 };
 
 } // namespace myvk_rg_executor
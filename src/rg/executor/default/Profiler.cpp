@@ -0,0 +1,201 @@
+#include <myvk_rg/executor/Profiler.hpp>
+
+#include <myvk_rg/executor/Trace.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <numeric>
+
+namespace myvk_rg::executor {
+
+void ProfileRecord::Push(double ms) {
+	m_last = ms;
+	if (m_samples.size() < m_window)
+		m_samples.push_back(ms);
+	else
+		m_samples[m_next] = ms;
+	m_next = (m_next + 1) % m_window;
+}
+
+double ProfileRecord::GetAverage() const {
+	if (m_samples.empty())
+		return 0.0;
+	return std::accumulate(m_samples.begin(), m_samples.end(), 0.0) / double(m_samples.size());
+}
+
+double ProfileRecord::GetPercentile(double percentile) const {
+	if (m_samples.empty())
+		return 0.0;
+	std::vector<double> sorted = m_samples;
+	auto idx = std::size_t(std::clamp(percentile, 0.0, 1.0) * double(sorted.size() - 1) + 0.5);
+	std::nth_element(sorted.begin(), sorted.begin() + idx, sorted.end());
+	return sorted[idx];
+}
+
+ProfileStats ProfileRecord::GetStats() const {
+	if (m_samples.empty())
+		return {};
+	std::vector<double> sorted = m_samples;
+	std::sort(sorted.begin(), sorted.end());
+	const auto percentile = [&](double p) { return sorted[std::size_t(p * double(sorted.size() - 1) + 0.5)]; };
+	return {
+	    .sample_count = GetSampleCount(),
+	    .last_ms = m_last,
+	    .average_ms = GetAverage(),
+	    .min_ms = sorted.front(),
+	    .max_ms = sorted.back(),
+	    .p50_ms = percentile(0.5),
+	    .p95_ms = percentile(0.95),
+	    .p99_ms = percentile(0.99),
+	};
+}
+
+uint64_t PipelineStatistics::Get(VkQueryPipelineStatisticFlagBits statistic) const {
+	if (!(m_flags & statistic))
+		return 0;
+	return m_values[std::popcount(m_flags & (statistic - 1u))];
+}
+
+Profiler::Profiler(uint32_t frame_latency, std::size_t window, VkQueryPipelineStatisticFlags statistic_flags)
+    : m_frames(std::max(frame_latency, 1u)), m_window{window}, m_statistic_flags{statistic_flags},
+      m_statistic_count(std::popcount(statistic_flags)), m_frame_record(window) {}
+
+bool Profiler::fetch_frame(Frame *p_frame) {
+	auto query_count = uint32_t(p_frame->scope_queries.size() * 2);
+	uint32_t statistics_value_count = p_frame->statistics_query_count * m_statistic_count;
+	m_results.resize(query_count + statistics_value_count);
+	// No VK_QUERY_RESULT_WAIT_BIT, the frame is skipped if the results are not available yet
+	if (p_frame->query_pool->GetResults64(0, query_count, m_results.data(), 0) != VK_SUCCESS)
+		return false;
+	if (statistics_value_count &&
+	    p_frame->statistics_query_pool->GetResults(
+	        0, p_frame->statistics_query_count, statistics_value_count * sizeof(uint64_t),
+	        m_results.data() + query_count, m_statistic_count * sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) != VK_SUCCESS)
+		return false;
+
+	const auto get_ms = [&](uint32_t scope_id) {
+		uint64_t begin = m_results[scope_id << 1u] & m_timestamp_mask,
+		         end = m_results[scope_id << 1u | 1u] & m_timestamp_mask;
+		return end > begin ? double(end - begin) * m_timestamp_period * 1e-6 : 0.0;
+	};
+
+	m_frame_record.Push(get_ms(0));
+
+	// GPU spans are placed on the trace timeline relative to the CPU time the frame is recorded
+	if (TraceRecorder::IsEnabled()) {
+		uint64_t frame_begin = m_results[0] & m_timestamp_mask;
+		const auto get_trace_us = [&](uint32_t query) {
+			uint64_t timestamp = m_results[query] & m_timestamp_mask;
+			return p_frame->trace_begin_us +
+			       (timestamp > frame_begin ? uint64_t(double(timestamp - frame_begin) * m_timestamp_period * 1e-3)
+			                                : 0);
+		};
+		static constexpr const char *kScopeCategories[] = {"pass", "render_pass", "barrier"};
+		for (uint32_t i = 0; i < p_frame->scope_queries.size(); ++i) {
+			const auto &scope_query = p_frame->scope_queries[i];
+			TraceRecorder::AddSpan(i ? kScopeCategories[static_cast<std::size_t>(scope_query.scope)] : "frame",
+			                       i ? scope_query.key.Format() : "Frame", get_trace_us(i << 1u),
+			                       get_trace_us(i << 1u | 1u), TraceRecorder::Track::kGPU);
+		}
+	}
+	for (uint32_t i = 1; i < p_frame->scope_queries.size(); ++i) {
+		const auto &scope_query = p_frame->scope_queries[i];
+		auto &records = m_records[static_cast<std::size_t>(scope_query.scope)];
+		auto it = records.find(scope_query.key);
+		if (it == records.end())
+			it = records.emplace(scope_query.key, ProfileRecord(m_window)).first;
+		it->second.Push(get_ms(i));
+
+		if (scope_query.statistics_query != kNoQuery) {
+			auto values_begin = m_results.begin() + query_count + scope_query.statistics_query * m_statistic_count;
+			m_pass_statistics[scope_query.key] = PipelineStatistics{
+			    m_statistic_flags, std::vector<uint64_t>(values_begin, values_begin + m_statistic_count)};
+		}
+	}
+
+	p_frame->query_pool->Reset(0, query_count);
+	if (p_frame->statistics_query_count)
+		p_frame->statistics_query_pool->Reset(0, p_frame->statistics_query_count);
+	p_frame->statistics_query_count = 0;
+	p_frame->pending = false;
+	return true;
+}
+
+void Profiler::CmdBeginFrame(const myvk::Ptr<myvk::CommandBuffer> &command_buffer, uint32_t max_scope_count) {
+	const auto &device = command_buffer->GetDevicePtr();
+	const auto &physical_device = device->GetPhysicalDevicePtr();
+
+	if (m_timestamp_mask == 0) {
+		uint32_t family = command_buffer->GetCommandPoolPtr()->GetQueuePtr()->GetFamilyIndex();
+		uint32_t valid_bits = physical_device->GetQueueFamilyProperties()[family].timestampValidBits;
+		m_timestamp_mask = valid_bits >= 64 ? ~uint64_t(0) : (uint64_t(1) << valid_bits) - 1;
+		m_timestamp_period = physical_device->GetProperties().vk10.limits.timestampPeriod;
+	}
+
+	Frame &frame = m_frames[m_frame_index];
+	m_frame_index = (m_frame_index + 1) % m_frames.size();
+
+	m_p_frame = nullptr;
+	if (m_timestamp_mask == 0 || (frame.pending && !fetch_frame(&frame)))
+		return;
+
+	uint32_t query_count = (max_scope_count + 1) * 2;
+	if (!frame.query_pool || frame.query_pool->GetCount() < query_count) {
+		frame.query_pool = myvk::QueryPool::Create(device, VK_QUERY_TYPE_TIMESTAMP, query_count);
+		if (!frame.query_pool)
+			return;
+		frame.query_pool->Reset(0, query_count);
+	}
+	if (m_statistic_flags &&
+	    (!frame.statistics_query_pool || frame.statistics_query_pool->GetCount() < max_scope_count)) {
+		frame.statistics_query_pool = myvk::QueryPool::Create(device, VK_QUERY_TYPE_PIPELINE_STATISTICS,
+		                                                      max_scope_count, m_statistic_flags);
+		if (!frame.statistics_query_pool)
+			return;
+		frame.statistics_query_pool->Reset(0, max_scope_count);
+	}
+
+	m_p_frame = &frame;
+	frame.trace_begin_us = TraceRecorder::GetTimeUs();
+	frame.scope_queries.clear();
+	frame.scope_queries.reserve(max_scope_count + 1);
+	CmdBeginScope(command_buffer, ProfileScope::kPass, {});
+}
+
+uint32_t Profiler::CmdBeginScope(const myvk::Ptr<myvk::CommandBuffer> &command_buffer, ProfileScope scope,
+                                 const interface::GlobalKey &key) {
+	auto scope_id = uint32_t(m_p_frame->scope_queries.size());
+	assert(scope_id * 2 < m_p_frame->query_pool->GetCount());
+	uint32_t statistics_query = kNoQuery;
+	if (m_statistic_flags && scope == ProfileScope::kPass && !key.Empty())
+		statistics_query = m_p_frame->statistics_query_count++;
+
+	m_p_frame->scope_queries.push_back({.scope = scope, .key = key, .statistics_query = statistics_query});
+	command_buffer->CmdWriteTimestamp(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_p_frame->query_pool, scope_id << 1u);
+	if (statistics_query != kNoQuery)
+		command_buffer->CmdBeginQuery(m_p_frame->statistics_query_pool, statistics_query);
+	return scope_id;
+}
+
+void Profiler::CmdEndScope(const myvk::Ptr<myvk::CommandBuffer> &command_buffer, uint32_t scope_id) {
+	uint32_t statistics_query = m_p_frame->scope_queries[scope_id].statistics_query;
+	if (statistics_query != kNoQuery)
+		command_buffer->CmdEndQuery(m_p_frame->statistics_query_pool, statistics_query);
+	command_buffer->CmdWriteTimestamp(VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_p_frame->query_pool,
+	                                  scope_id << 1u | 1u);
+}
+
+void Profiler::CmdEndFrame(const myvk::Ptr<myvk::CommandBuffer> &command_buffer) {
+	CmdEndScope(command_buffer, 0);
+	m_p_frame->pending = true;
+	m_p_frame = nullptr;
+}
+
+void Profiler::Clear() {
+	for (auto &records : m_records)
+		records.clear();
+	m_frame_record.Clear();
+	m_pass_statistics.clear();
+}
+
+} // namespace myvk_rg::executor
@@ -0,0 +1,184 @@
+#include "ResourcePool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+
+namespace myvk_rg_executor {
+
+RGMemoryAllocation::RGMemoryAllocation(const myvk::Ptr<myvk::Device> &device,
+                                       const VkMemoryRequirements &memory_requirements,
+                                       const VmaAllocationCreateInfo &create_info)
+    : m_device_ptr{device}, m_requirements{memory_requirements}, m_create_flags{create_info.flags},
+      m_required_flags{create_info.requiredFlags} {
+	static std::atomic_uint64_t s_next_serial{1}; // 0 for unbound objects
+	m_serial = s_next_serial.fetch_add(1, std::memory_order_relaxed);
+	vmaAllocateMemory(device->GetAllocatorHandle(), &memory_requirements, &create_info, &m_allocation, &m_info);
+	if (create_info.flags & VMA_ALLOCATION_CREATE_MAPPED_BIT) {
+		assert(m_info.pMappedData);
+	}
+}
+RGMemoryAllocation::~RGMemoryAllocation() {
+	if (m_allocation != VK_NULL_HANDLE)
+		vmaFreeMemory(GetDevicePtr()->GetAllocatorHandle(), m_allocation);
+}
+bool RGMemoryAllocation::IsCompatible(const VkMemoryRequirements &memory_requirements,
+                                      const VmaAllocationCreateInfo &create_info) const {
+	return m_allocation != VK_NULL_HANDLE && m_create_flags == create_info.flags &&
+	       m_required_flags == create_info.requiredFlags &&
+	       (memory_requirements.memoryTypeBits >> m_info.memoryType) & 1u &&
+	       m_requirements.alignment % memory_requirements.alignment == 0 &&
+	       m_requirements.size >= memory_requirements.size && m_requirements.size <= memory_requirements.size * 2;
+}
+
+RGImage::RGImage(const myvk::Ptr<myvk::Device> &device, const VkImageCreateInfo &create_info)
+    : m_device_ptr{device}, m_create_info{create_info} {
+	vkCreateImage(GetDevicePtr()->GetHandle(), &create_info, nullptr, &m_image);
+	m_extent = create_info.extent;
+	m_mip_levels = create_info.mipLevels;
+	m_array_layers = create_info.arrayLayers;
+	m_format = create_info.format;
+	m_type = create_info.imageType;
+	m_usage = create_info.usage;
+}
+RGImage::~RGImage() {
+	if (m_image != VK_NULL_HANDLE)
+		vkDestroyImage(GetDevicePtr()->GetHandle(), m_image, nullptr);
+}
+void RGImage::Bind(const myvk::Ptr<RGMemoryAllocation> &alloc_ptr, VkDeviceSize offset) {
+	if (!IsBoundTo(alloc_ptr.get(), offset)) {
+		assert(m_bound_serial == 0);
+		vmaBindImageMemory2(m_device_ptr->GetAllocatorHandle(), alloc_ptr->GetHandle(), offset, m_image, nullptr);
+	}
+	m_alloc_ptr = alloc_ptr;
+	m_bound_serial = alloc_ptr->GetSerial();
+	m_bound_offset = offset;
+}
+
+RGBuffer::RGBuffer(const myvk::Ptr<myvk::Device> &device, const VkBufferCreateInfo &create_info)
+    : m_device_ptr{device}, m_create_info{create_info} {
+	vkCreateBuffer(GetDevicePtr()->GetHandle(), &create_info, nullptr, &m_buffer);
+	m_size = create_info.size;
+}
+RGBuffer::~RGBuffer() {
+	if (m_buffer != VK_NULL_HANDLE)
+		vkDestroyBuffer(GetDevicePtr()->GetHandle(), m_buffer, nullptr);
+}
+void RGBuffer::Bind(const myvk::Ptr<RGMemoryAllocation> &alloc_ptr, VkDeviceSize offset) {
+	if (!IsBoundTo(alloc_ptr.get(), offset)) {
+		assert(m_bound_serial == 0);
+		vmaBindBufferMemory2(m_device_ptr->GetAllocatorHandle(), alloc_ptr->GetHandle(), offset, m_buffer, nullptr);
+	}
+	m_alloc_ptr = alloc_ptr;
+	m_bound_serial = alloc_ptr->GetSerial();
+	m_bound_offset = offset;
+}
+
+namespace resource_pool {
+inline static myvk::CacheKey MakeKey(const VkImageCreateInfo &create_info) {
+	myvk::CacheKey key;
+	key << create_info.flags << create_info.imageType << create_info.format << create_info.extent.width
+	    << create_info.extent.height << create_info.extent.depth << create_info.mipLevels << create_info.arrayLayers
+	    << create_info.samples << create_info.tiling << create_info.usage << create_info.sharingMode
+	    << create_info.initialLayout;
+	return key;
+}
+inline static myvk::CacheKey MakeKey(const VkBufferCreateInfo &create_info) {
+	myvk::CacheKey key;
+	key << create_info.flags << create_info.size << create_info.usage << create_info.sharingMode;
+	return key;
+}
+
+// Take a pooled object with the create info (bound to p_bound_alloc at offset if specified)
+template <typename T, typename CreateInfo>
+inline std::unique_ptr<T> Take(auto &pool_map, const myvk::Ptr<myvk::Device> &device, const CreateInfo &create_info,
+                               const RGMemoryAllocation *p_bound_alloc, VkDeviceSize offset) {
+	auto [begin, end] = pool_map.equal_range(MakeKey(create_info));
+	for (auto it = begin; it != end; ++it) {
+		const T *ptr = it->second.ptr.get();
+		if (ptr->GetDevicePtr() != device || (p_bound_alloc && !ptr->IsBoundTo(p_bound_alloc, offset)))
+			continue;
+		std::unique_ptr<T> ret = std::move(it->second.ptr);
+		pool_map.erase(it);
+		return ret;
+	}
+	return nullptr;
+}
+} // namespace resource_pool
+
+myvk::Ptr<ResourcePool> ResourcePool::Create() { return myvk::Ptr<ResourcePool>{new ResourcePool{}}; }
+
+void ResourcePool::recycle(RGMemoryAllocation *ptr) {
+	m_allocs.push_back({.ptr = std::unique_ptr<RGMemoryAllocation>{ptr}, .release_frame = m_frame});
+}
+void ResourcePool::recycle(RGImage *ptr) {
+	auto alloc_ptr = std::move(ptr->m_alloc_ptr); // Recycle the memory after the image
+	m_images.emplace(resource_pool::MakeKey(ptr->m_create_info),
+	                 Entry<RGImage>{.ptr = std::unique_ptr<RGImage>{ptr}, .release_frame = m_frame});
+}
+void ResourcePool::recycle(RGBuffer *ptr) {
+	auto alloc_ptr = std::move(ptr->m_alloc_ptr);
+	m_buffers.emplace(resource_pool::MakeKey(ptr->m_create_info),
+	                  Entry<RGBuffer>{.ptr = std::unique_ptr<RGBuffer>{ptr}, .release_frame = m_frame});
+}
+
+void ResourcePool::drop_bound_to(uint64_t alloc_serial) {
+	std::erase_if(m_images, [=](const auto &it) { return it.second.ptr->GetBoundSerial() == alloc_serial; });
+	std::erase_if(m_buffers, [=](const auto &it) { return it.second.ptr->GetBoundSerial() == alloc_serial; });
+}
+
+myvk::Ptr<RGMemoryAllocation> ResourcePool::AcquireMemory(const myvk::Ptr<myvk::Device> &device,
+                                                          const VkMemoryRequirements &memory_requirements,
+                                                          const VmaAllocationCreateInfo &create_info,
+                                                          uint64_t preferred_serial) {
+	auto best_it = m_allocs.end();
+	for (auto it = m_allocs.begin(); it != m_allocs.end(); ++it) {
+		const RGMemoryAllocation *ptr = it->ptr.get();
+		if (ptr->GetDevicePtr() != device || !ptr->IsCompatible(memory_requirements, create_info))
+			continue;
+		if (ptr->GetSerial() == preferred_serial) {
+			best_it = it;
+			break;
+		}
+		if (best_it == m_allocs.end() || ptr->GetInfo().size < best_it->ptr->GetInfo().size)
+			best_it = it;
+	}
+	if (best_it == m_allocs.end())
+		return wrap(new RGMemoryAllocation(device, memory_requirements, create_info));
+
+	RGMemoryAllocation *ptr = best_it->ptr.release();
+	*best_it = std::move(m_allocs.back());
+	m_allocs.pop_back();
+	return wrap(ptr);
+}
+
+myvk::Ptr<RGImage> ResourcePool::AcquireImage(const myvk::Ptr<myvk::Device> &device,
+                                              const VkImageCreateInfo &create_info,
+                                              const RGMemoryAllocation *p_bound_alloc, VkDeviceSize offset) {
+	auto ptr = resource_pool::Take<RGImage>(m_images, device, create_info, p_bound_alloc, offset);
+	return wrap(ptr ? ptr.release() : new RGImage(device, create_info));
+}
+
+myvk::Ptr<RGBuffer> ResourcePool::AcquireBuffer(const myvk::Ptr<myvk::Device> &device,
+                                                const VkBufferCreateInfo &create_info,
+                                                const RGMemoryAllocation *p_bound_alloc, VkDeviceSize offset) {
+	auto ptr = resource_pool::Take<RGBuffer>(m_buffers, device, create_info, p_bound_alloc, offset);
+	return wrap(ptr ? ptr.release() : new RGBuffer(device, create_info));
+}
+
+void ResourcePool::NextFrame() {
+	++m_frame;
+	const auto is_expired = [this](uint64_t release_frame) { return m_frame - release_frame > m_max_idle_frames; };
+
+	std::erase_if(m_images, [&](const auto &it) { return is_expired(it.second.release_frame); });
+	std::erase_if(m_buffers, [&](const auto &it) { return is_expired(it.second.release_frame); });
+	// Pooled images and buffers must not outlive the memory they are bound to
+	std::erase_if(m_allocs, [&](const auto &entry) {
+		if (!is_expired(entry.release_frame))
+			return false;
+		drop_bound_to(entry.ptr->GetSerial());
+		return true;
+	});
+}
+
+} // namespace myvk_rg_executor
@@ -0,0 +1,150 @@
+#pragma once
+#ifndef MYVK_RG_EXE_DEF_RESOURCE_POOL_HPP
+#define MYVK_RG_EXE_DEF_RESOURCE_POOL_HPP
+
+#include <myvk/BufferBase.hpp>
+#include <myvk/Device.hpp>
+#include <myvk/ImageBase.hpp>
+#include <myvk/ObjectCache.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace myvk_rg_executor {
+
+class RGMemoryAllocation final : public myvk::DeviceObjectBase {
+private:
+	myvk::Ptr<myvk::Device> m_device_ptr;
+	VmaAllocation m_allocation{VK_NULL_HANDLE};
+	VmaAllocationInfo m_info{};
+	VkMemoryRequirements m_requirements{};
+	VmaAllocationCreateFlags m_create_flags{};
+	VkMemoryPropertyFlags m_required_flags{};
+	uint64_t m_serial{}; // Unique among all allocations, unlike the address
+
+public:
+	RGMemoryAllocation(const myvk::Ptr<myvk::Device> &device, const VkMemoryRequirements &memory_requirements,
+	                   const VmaAllocationCreateInfo &create_info);
+	~RGMemoryAllocation() final;
+
+	// Whether the allocation can serve the requirements (wasting at most half of it)
+	bool IsCompatible(const VkMemoryRequirements &memory_requirements,
+	                  const VmaAllocationCreateInfo &create_info) const;
+
+	inline const VmaAllocationInfo &GetInfo() const { return m_info; }
+	inline VmaAllocation GetHandle() const { return m_allocation; }
+	inline uint64_t GetSerial() const { return m_serial; }
+	const myvk::Ptr<myvk::Device> &GetDevicePtr() const final { return m_device_ptr; }
+};
+
+class RGImage final : public myvk::ImageBase {
+private:
+	myvk::Ptr<myvk::Device> m_device_ptr;
+	VkImageCreateInfo m_create_info{};
+	myvk::Ptr<RGMemoryAllocation> m_alloc_ptr;
+	// Binding is permanent, kept after the image is recycled and m_alloc_ptr is released (the memory may be freed
+	// by then, so it is identified by serial)
+	uint64_t m_bound_serial{};
+	VkDeviceSize m_bound_offset{};
+
+	friend class ResourcePool;
+
+public:
+	RGImage(const myvk::Ptr<myvk::Device> &device, const VkImageCreateInfo &create_info);
+	~RGImage() final;
+
+	// Binds the image if unbound, a recycled image only takes the ownership of the memory it is bound to
+	void Bind(const myvk::Ptr<RGMemoryAllocation> &alloc_ptr, VkDeviceSize offset);
+	inline uint64_t GetBoundSerial() const { return m_bound_serial; }
+	inline bool IsBoundTo(const RGMemoryAllocation *p_alloc, VkDeviceSize offset) const {
+		return m_bound_serial == p_alloc->GetSerial() && m_bound_offset == offset;
+	}
+	inline const VkImageCreateInfo &GetCreateInfo() const { return m_create_info; }
+	const myvk::Ptr<myvk::Device> &GetDevicePtr() const final { return m_device_ptr; }
+};
+
+class RGBuffer final : public myvk::BufferBase {
+private:
+	myvk::Ptr<myvk::Device> m_device_ptr;
+	VkBufferCreateInfo m_create_info{};
+	myvk::Ptr<RGMemoryAllocation> m_alloc_ptr;
+	uint64_t m_bound_serial{};
+	VkDeviceSize m_bound_offset{};
+
+	friend class ResourcePool;
+
+public:
+	RGBuffer(const myvk::Ptr<myvk::Device> &device, const VkBufferCreateInfo &create_info);
+	~RGBuffer() final;
+
+	void Bind(const myvk::Ptr<RGMemoryAllocation> &alloc_ptr, VkDeviceSize offset);
+	inline uint64_t GetBoundSerial() const { return m_bound_serial; }
+	inline bool IsBoundTo(const RGMemoryAllocation *p_alloc, VkDeviceSize offset) const {
+		return m_bound_serial == p_alloc->GetSerial() && m_bound_offset == offset;
+	}
+	inline const VkBufferCreateInfo &GetCreateInfo() const { return m_create_info; }
+	const myvk::Ptr<myvk::Device> &GetDevicePtr() const final { return m_device_ptr; }
+};
+
+// Keeps the images, buffers and memory released by previous compiles for reuse in later ones
+// Objects handed out return to the pool when their last reference drops, and are destroyed after staying unused
+// for more than GetMaxIdleFrames() frames
+class ResourcePool final : public std::enable_shared_from_this<ResourcePool> {
+private:
+	template <typename T> struct Entry {
+		std::unique_ptr<T> ptr;
+		uint64_t release_frame;
+	};
+	template <typename T> struct Recycler {
+		std::weak_ptr<ResourcePool> pool_weak_ptr;
+		inline void operator()(T *ptr) const {
+			if (auto pool_ptr = pool_weak_ptr.lock())
+				pool_ptr->recycle(ptr);
+			else
+				delete ptr;
+		}
+	};
+
+	uint64_t m_frame{};
+	uint32_t m_max_idle_frames{8};
+	std::vector<Entry<RGMemoryAllocation>> m_allocs;
+	std::unordered_multimap<myvk::CacheKey, Entry<RGImage>, myvk::CacheKey::Hash> m_images;
+	std::unordered_multimap<myvk::CacheKey, Entry<RGBuffer>, myvk::CacheKey::Hash> m_buffers;
+
+	inline ResourcePool() = default;
+
+	template <typename T> inline myvk::Ptr<T> wrap(T *ptr) {
+		return myvk::Ptr<T>{ptr, Recycler<T>{.pool_weak_ptr = weak_from_this()}};
+	}
+	void recycle(RGMemoryAllocation *ptr);
+	void recycle(RGImage *ptr);
+	void recycle(RGBuffer *ptr);
+	void drop_bound_to(uint64_t alloc_serial);
+
+public:
+	static myvk::Ptr<ResourcePool> Create();
+
+	// Prefers the allocation of preferred_serial if it is pooled and compatible, then the smallest compatible one
+	myvk::Ptr<RGMemoryAllocation> AcquireMemory(const myvk::Ptr<myvk::Device> &device,
+	                                            const VkMemoryRequirements &memory_requirements,
+	                                            const VmaAllocationCreateInfo &create_info,
+	                                            uint64_t preferred_serial = 0);
+	// With p_bound_alloc, only a pooled object bound to it at the offset is reused, otherwise a new unbound one is
+	// created. Without it, any pooled object with the create info is reused.
+	myvk::Ptr<RGImage> AcquireImage(const myvk::Ptr<myvk::Device> &device, const VkImageCreateInfo &create_info,
+	                                const RGMemoryAllocation *p_bound_alloc = nullptr, VkDeviceSize offset = 0);
+	myvk::Ptr<RGBuffer> AcquireBuffer(const myvk::Ptr<myvk::Device> &device, const VkBufferCreateInfo &create_info,
+	                                  const RGMemoryAllocation *p_bound_alloc = nullptr, VkDeviceSize offset = 0);
+
+	// Advances the frame counter and destroys objects idle for too long
+	void NextFrame();
+	inline void SetMaxIdleFrames(uint32_t frames) { m_max_idle_frames = frames; }
+	inline uint32_t GetMaxIdleFrames() const { return m_max_idle_frames; }
+	inline std::size_t GetPooledCount() const { return m_allocs.size() + m_images.size() + m_buffers.size(); }
+};
+
+} // namespace myvk_rg_executor
+
+#endif
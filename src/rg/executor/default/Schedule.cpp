@@ -4,6 +4,8 @@
 
 #include "Schedule.hpp"
 
+#include "CompilePlan.hpp"
+
 #include <algorithm>
 #include <cassert>
 
@@ -21,6 +23,48 @@ Schedule Schedule::Create(const Args &args) {
 	return s;
 }
 
+Schedule Schedule::Restore(const Args &args, const CompilePlan &plan) {
+	args.collection.ClearInfo(&PassInfo::schedule, &ResourceInfo::schedule);
+
+	const auto &resources = args.dependency.GetResources();
+	const auto get_input = [&](CompilePlan::InputRef ref) { return CompilePlan::GetInput(args.dependency, ref); };
+	const auto get_inputs = [&](const std::vector<CompilePlan::InputRef> &refs) {
+		std::vector<const InputBase *> inputs;
+		inputs.reserve(refs.size());
+		for (auto ref : refs)
+			inputs.push_back(get_input(ref));
+		return inputs;
+	};
+
+	Schedule s = {};
+	for (std::size_t topo_id = 0; uint32_t group_size : plan.GetPassGroupSizes()) {
+		auto &pass_group = s.m_pass_groups.emplace_back();
+		for (uint32_t subpass_id = 0; subpass_id < group_size; ++subpass_id) {
+			const PassBase *p_pass = args.dependency.GetTopoIDPass(topo_id++);
+			get_sched_info(p_pass).group_id = s.m_pass_groups.size() - 1;
+			get_sched_info(p_pass).subpass_id = subpass_id;
+			pass_group.subpasses.push_back(p_pass);
+		}
+	}
+	for (const auto &subpass_barrier : plan.GetSubpassBarriers())
+		s.m_pass_groups[subpass_barrier.group_id].subpass_deps.push_back({
+		    .p_attachment = static_cast<const ImageBase *>(resources[subpass_barrier.attachment_id]),
+		    .p_src = get_input(subpass_barrier.src),
+		    .p_dst = get_input(subpass_barrier.dst),
+		});
+	for (const auto &pass_barrier : plan.GetPassBarriers())
+		s.m_pass_barriers.push_back({.p_resource = resources[pass_barrier.resource_id],
+		                             .src_s = get_inputs(pass_barrier.src_s),
+		                             .dst_s = get_inputs(pass_barrier.dst_s),
+		                             .type = pass_barrier.type});
+	for (std::size_t i = 0; i < resources.size(); ++i) {
+		get_sched_info(resources[i]).first_inputs = get_inputs(plan.GetFirstInputs()[i]);
+		get_sched_info(resources[i]).last_inputs = get_inputs(plan.GetLastInputs()[i]);
+	}
+	s.check_ext_read_only(args);
+	return s;
+}
+
 inline static bool is_image_read_grouped(const InputBase *p_l, const InputBase *p_r) {
 	myvk_rg::Usage ul = p_l->GetUsage(), ur = p_r->GetUsage();
 	return !UsageIsAttachment(ul) && !UsageIsAttachment(ur) && UsageGetImageLayout(ul) == UsageGetImageLayout(ur);
@@ -13,6 +13,8 @@
 
 namespace myvk_rg_executor {
 
+class CompilePlan;
+
 class Schedule {
 public:
 	enum class BarrierType { kLocal, kIntValidate, kExtInput, kExtOutput };
@@ -30,8 +32,6 @@ public:
 		std::vector<SubpassBarrier> subpass_deps;
 		inline bool IsRenderPass() const { return subpasses[0]->GetType() == PassType::kGraphics; }
 	};
-
-private:
 	struct Args {
 		const RenderGraphBase &render_graph;
 		const Collection &collection;
@@ -39,6 +39,7 @@ private:
 		const Metadata &metadata;
 	};
 
+private:
 	std::vector<PassGroup> m_pass_groups;
 	std::vector<PassBarrier> m_pass_barriers;
 
@@ -66,6 +67,8 @@ private:
 
 public:
 	static Schedule Create(const Args &args);
+	// Rebuild from a compatible plan without merging passes or generating barriers
+	static Schedule Restore(const Args &args, const CompilePlan &plan);
 	inline const auto &GetPassGroups() const { return m_pass_groups; }
 	inline const auto &GetPassBarriers() const { return m_pass_barriers; }
 	static std::size_t GetGroupID(const PassBase *p_pass) { return get_sched_info(p_pass).group_id; }
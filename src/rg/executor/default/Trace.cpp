@@ -0,0 +1,176 @@
+#include <myvk_rg/executor/Trace.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace myvk_rg::executor {
+
+namespace {
+
+struct TraceEvent {
+	const char *category;
+	std::string name;
+	uint64_t begin_us, end_us;
+	TraceRecorder::Track track;
+};
+
+// Single-producer chunk list, the owner thread appends to the tail chunk and publishes with `count`,
+// Flush() consumes from the head and frees chunks the producer has left
+struct TraceChunk {
+	inline static constexpr uint32_t kCapacity = 1024;
+	TraceEvent events[kCapacity];
+	std::atomic_uint32_t count{0};
+	std::atomic<TraceChunk *> next{nullptr};
+};
+
+struct TraceThreadBuffer {
+	uint32_t thread_id{};
+	TraceChunk *p_tail{}; // Producer only
+	TraceChunk *p_head{}; // Consumer only
+	uint32_t head_index{};
+	std::atomic_bool retired{false}; // Set when the owner thread exits, Flush() frees the buffer once drained
+};
+
+// Retires the buffer of a thread on exit
+struct TraceThreadOwner {
+	TraceThreadBuffer *p_buffer;
+	inline ~TraceThreadOwner() { p_buffer->retired.store(true, std::memory_order_release); }
+};
+
+struct TraceRegistry {
+	std::mutex mutex;
+	std::vector<std::unique_ptr<TraceThreadBuffer>> thread_buffers;
+	uint32_t next_thread_id{0};
+	std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+	inline ~TraceRegistry() {
+		for (auto &buffer : thread_buffers)
+			for (TraceChunk *p_chunk = buffer->p_head; p_chunk;) {
+				TraceChunk *p_next = p_chunk->next.load(std::memory_order_relaxed);
+				delete p_chunk;
+				p_chunk = p_next;
+			}
+	}
+};
+
+TraceRegistry &get_registry() {
+	static TraceRegistry registry;
+	return registry;
+}
+
+TraceThreadBuffer *get_thread_buffer() {
+	thread_local TraceThreadOwner owner = [] {
+		auto &registry = get_registry();
+		std::scoped_lock lock{registry.mutex};
+		auto buffer = std::make_unique<TraceThreadBuffer>();
+		buffer->thread_id = registry.next_thread_id++;
+		buffer->p_head = buffer->p_tail = new TraceChunk{};
+		registry.thread_buffers.push_back(std::move(buffer));
+		return TraceThreadOwner{registry.thread_buffers.back().get()};
+	}();
+	return owner.p_buffer;
+}
+
+void write_json_string(std::FILE *p_file, std::string_view str) {
+	std::fputc('"', p_file);
+	for (char c : str) {
+		if (c == '"' || c == '\\') {
+			std::fputc('\\', p_file);
+			std::fputc(c, p_file);
+		} else if ((unsigned char)c < 0x20)
+			std::fprintf(p_file, "\\u%04x", (unsigned)c);
+		else
+			std::fputc(c, p_file);
+	}
+	std::fputc('"', p_file);
+}
+
+} // namespace
+
+uint64_t TraceRecorder::GetTimeUs() {
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() -
+	                                                             get_registry().epoch)
+	    .count();
+}
+
+void TraceRecorder::add_span(const char *category, std::string &&name, uint64_t begin_us, uint64_t end_us,
+                             Track track) {
+	TraceThreadBuffer *p_buffer = get_thread_buffer();
+	TraceChunk *p_tail = p_buffer->p_tail;
+	uint32_t count = p_tail->count.load(std::memory_order_relaxed);
+	if (count == TraceChunk::kCapacity) {
+		auto *p_new_tail = new TraceChunk{};
+		p_tail->next.store(p_new_tail, std::memory_order_release);
+		p_buffer->p_tail = p_tail = p_new_tail;
+		count = 0;
+	}
+	p_tail->events[count] = {
+	    .category = category, .name = std::move(name), .begin_us = begin_us, .end_us = end_us, .track = track};
+	p_tail->count.store(count + 1, std::memory_order_release);
+}
+
+bool TraceRecorder::Flush(const char *filename) {
+	std::FILE *p_file = std::fopen(filename, "w");
+	if (!p_file)
+		return false;
+	Flush(p_file);
+	std::fclose(p_file);
+	return true;
+}
+
+void TraceRecorder::Flush(std::FILE *p_file) {
+	auto &registry = get_registry();
+	std::scoped_lock lock{registry.mutex};
+
+	std::fputs("{\"traceEvents\":[\n", p_file);
+	std::fputs(R"({"name":"process_name","ph":"M","pid":0,"args":{"name":"CPU"}},)"
+	           "\n"
+	           R"({"name":"process_name","ph":"M","pid":1,"args":{"name":"GPU"}})",
+	           p_file);
+
+	for (auto &buffer : registry.thread_buffers) {
+		// Loaded before draining, so that every span of a retired buffer is visible
+		bool retired = buffer->retired.load(std::memory_order_acquire);
+		for (;;) {
+			TraceChunk *p_chunk = buffer->p_head;
+			// A chunk with a successor is full and no longer touched by its producer
+			TraceChunk *p_next = p_chunk->next.load(std::memory_order_acquire);
+			uint32_t count = p_next ? TraceChunk::kCapacity : p_chunk->count.load(std::memory_order_acquire);
+			for (uint32_t i = buffer->head_index; i < count; ++i) {
+				const TraceEvent &event = p_chunk->events[i];
+				bool gpu = event.track == Track::kGPU;
+				std::fputs(",\n{\"name\":", p_file);
+				write_json_string(p_file, event.name);
+				std::fprintf(p_file, R"(,"cat":"%s","ph":"X","ts":%llu,"dur":%llu,"pid":%d,"tid":%u})",
+				             event.category, (unsigned long long)event.begin_us,
+				             (unsigned long long)(event.end_us - event.begin_us), gpu ? 1 : 0,
+				             gpu ? 0u : buffer->thread_id);
+			}
+			if (!p_next) {
+				buffer->head_index = count;
+				break;
+			}
+			delete p_chunk;
+			buffer->p_head = p_next;
+			buffer->head_index = 0;
+		}
+		if (retired) {
+			delete buffer->p_head;
+			buffer->p_head = nullptr;
+		}
+	}
+	std::erase_if(registry.thread_buffers, [](const auto &buffer) { return buffer->p_head == nullptr; });
+
+	std::fputs("\n]}\n", p_file);
+}
+
+std::size_t TraceRecorder::GetThreadBufferCount() {
+	auto &registry = get_registry();
+	std::scoped_lock lock{registry.mutex};
+	return registry.thread_buffers.size();
+}
+
+} // namespace myvk_rg::executor
@@ -0,0 +1,62 @@
+#include <myvk_rg/executor/TransientHeap.hpp>
+
+#include "ResourcePool.hpp"
+
+namespace myvk_rg::executor {
+
+using myvk_rg_executor::ResourcePool;
+using myvk_rg_executor::RGMemoryAllocation;
+
+myvk::Ptr<TransientHeap> TransientHeap::Create() { return myvk::MakePtr<TransientHeap>(); }
+
+VkDeviceSize TransientHeap::GetSize() const {
+	VkDeviceSize size = 0;
+	for (const auto &[_, bucket] : m_buckets)
+		size += bucket.alloc_ptr->GetInfo().size;
+	return size;
+}
+
+bool TransientHeap::MergeRequirements(VkMemoryRequirements *p_requirements, VmaAllocationCreateInfo *p_create_info,
+                                      const VkMemoryRequirements &memory_requirements,
+                                      const VmaAllocationCreateInfo &create_info) {
+	if (p_create_info->flags != create_info.flags || p_create_info->requiredFlags != create_info.requiredFlags)
+		return false;
+	// memoryTypeBits of 0 in the create info means any type
+	uint32_t type_bits = p_requirements->memoryTypeBits & memory_requirements.memoryTypeBits &
+	                     (p_create_info->memoryTypeBits ? p_create_info->memoryTypeBits : ~0u) &
+	                     (create_info.memoryTypeBits ? create_info.memoryTypeBits : ~0u);
+	if (type_bits == 0)
+		return false;
+	p_requirements->size = std::max(p_requirements->size, memory_requirements.size);
+	p_requirements->alignment = std::max(p_requirements->alignment, memory_requirements.alignment); // Powers of 2
+	p_requirements->memoryTypeBits &= memory_requirements.memoryTypeBits;
+	p_create_info->memoryTypeBits = type_bits;
+	return true;
+}
+
+myvk::Ptr<RGMemoryAllocation> TransientHeap::acquire(const myvk::Ptr<myvk::Device> &device, uint32_t bucket,
+                                                     const VkMemoryRequirements &memory_requirements,
+                                                     const VmaAllocationCreateInfo &create_info,
+                                                     ResourcePool &resource_pool) {
+	VkMemoryRequirements heap_requirements = memory_requirements;
+	VmaAllocationCreateInfo heap_create_info = create_info;
+	auto &[alloc_ptr, requirements, heap_bucket_create_info] = m_buckets[bucket];
+	if (alloc_ptr && alloc_ptr->GetDevicePtr() == device) {
+		// Any size above the requirements is fine, the heap only grows
+		heap_requirements.size = std::max(heap_requirements.size, alloc_ptr->GetInfo().size);
+		if (alloc_ptr->IsCompatible(heap_requirements, create_info))
+			return alloc_ptr;
+		heap_requirements = requirements;
+		heap_create_info = heap_bucket_create_info;
+		if (!MergeRequirements(&heap_requirements, &heap_create_info, memory_requirements, create_info))
+			return nullptr;
+	}
+	// The previous allocation stays alive until all executors using it recompile, then returns to its pool
+	alloc_ptr = resource_pool.AcquireMemory(device, heap_requirements, heap_create_info);
+	requirements = heap_requirements;
+	heap_bucket_create_info = heap_create_info;
+	++m_generation;
+	return alloc_ptr;
+}
+
+} // namespace myvk_rg::executor
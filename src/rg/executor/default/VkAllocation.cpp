@@ -7,96 +7,172 @@
 
 #include "../VkHelper.hpp"
 #include "Info.hpp"
+#include "Interval.hpp"
+#include "ResourcePool.hpp"
+
+#include <map>
+#include <unordered_map>
 
 namespace myvk_rg_executor {
 
 using Meta = Metadata;
 
-class RGMemoryAllocation final : public myvk::DeviceObjectBase {
-private:
-	myvk::Ptr<myvk::Device> m_device_ptr;
-	VmaAllocation m_allocation{VK_NULL_HANDLE};
-	VmaAllocationInfo m_info{};
-
-public:
-	inline RGMemoryAllocation(const myvk::Ptr<myvk::Device> &device, const VkMemoryRequirements &memory_requirements,
-	                          const VmaAllocationCreateInfo &create_info)
-	    : m_device_ptr{device} {
-		vmaAllocateMemory(device->GetAllocatorHandle(), &memory_requirements, &create_info, &m_allocation, &m_info);
-		if (create_info.flags & VMA_ALLOCATION_CREATE_MAPPED_BIT) {
-			assert(m_info.pMappedData);
-		}
-	}
-	inline ~RGMemoryAllocation() final {
-		if (m_allocation != VK_NULL_HANDLE)
-			vmaFreeMemory(GetDevicePtr()->GetAllocatorHandle(), m_allocation);
-	}
-	inline const VmaAllocationInfo &GetInfo() const { return m_info; }
-	inline VmaAllocation GetHandle() const { return m_allocation; }
-	const myvk::Ptr<myvk::Device> &GetDevicePtr() const final { return m_device_ptr; }
-};
-class RGImage final : public myvk::ImageBase {
-private:
-	myvk::Ptr<myvk::Device> m_device_ptr;
-	myvk::Ptr<RGMemoryAllocation> m_alloc_ptr;
-
-public:
-	inline RGImage(const myvk::Ptr<myvk::Device> &device, const VkImageCreateInfo &create_info) : m_device_ptr{device} {
-		vkCreateImage(GetDevicePtr()->GetHandle(), &create_info, nullptr, &m_image);
-		m_extent = create_info.extent;
-		m_mip_levels = create_info.mipLevels;
-		m_array_layers = create_info.arrayLayers;
-		m_format = create_info.format;
-		m_type = create_info.imageType;
-		m_usage = create_info.usage;
-	}
-	inline ~RGImage() final {
-		if (m_image != VK_NULL_HANDLE)
-			vkDestroyImage(GetDevicePtr()->GetHandle(), m_image, nullptr);
-	};
-	const myvk::Ptr<myvk::Device> &GetDevicePtr() const final { return m_device_ptr; }
-	inline void SetAllocPtr(const myvk::Ptr<RGMemoryAllocation> &alloc_ptr) { m_alloc_ptr = alloc_ptr; }
-};
-class RGBuffer final : public myvk::BufferBase {
-private:
-	myvk::Ptr<myvk::Device> m_device_ptr;
-	myvk::Ptr<RGMemoryAllocation> m_alloc_ptr;
-
-public:
-	inline RGBuffer(const myvk::Ptr<myvk::Device> &device, const VkBufferCreateInfo &create_info)
-	    : m_device_ptr{device} {
-		vkCreateBuffer(GetDevicePtr()->GetHandle(), &create_info, nullptr, &m_buffer);
-		m_size = create_info.size;
-	}
-	inline ~RGBuffer() final {
-		if (m_buffer != VK_NULL_HANDLE)
-			vkDestroyBuffer(GetDevicePtr()->GetHandle(), m_buffer, nullptr);
-	}
-	const myvk::Ptr<myvk::Device> &GetDevicePtr() const final { return m_device_ptr; }
-	inline void SetAllocPtr(const myvk::Ptr<RGMemoryAllocation> &alloc_ptr) { m_alloc_ptr = alloc_ptr; }
-};
-
 VkAllocation VkAllocation::Create(const myvk::Ptr<myvk::Device> &device_ptr, const Args &args) {
+	VkAllocation alloc = Plan(DeviceModel::FromDevice(device_ptr), args);
+	alloc.m_device_ptr = device_ptr;
+	alloc.create_vk_objects(args);
+	return alloc;
+}
+
+VkAllocation VkAllocation::Plan(const DeviceModel &model, const Args &args) {
 	args.collection.ClearInfo(&ResourceInfo::vk_allocation);
 
 	VkAllocation alloc = {};
-	alloc.m_device_ptr = device_ptr;
 
 	alloc.init_alias_relation(args);
-	alloc.create_vk_resources(args);
-	alloc.create_vk_allocations(args);
-	alloc.bind_vk_resources(args);
-	alloc.create_resource_views(args);
+	alloc.init_root_lifetimes(args);
+	alloc.plan_vk_resources(model, args);
+	alloc.plan_vk_allocations(model, args);
+
+	return alloc;
+}
+
+VkAllocation VkAllocation::Plan(const Args &args, const Snapshot &snapshot) {
+	args.collection.ClearInfo(&ResourceInfo::vk_allocation);
+
+	VkAllocation alloc = {};
+	alloc.m_resource_alias_relation = snapshot.resource_alias_relation;
+	alloc.m_alias_barrier_count = snapshot.alias_barrier_count;
+	alloc.m_alias_serialization = snapshot.alias_serialization;
+
+	std::vector<const ResourceBase *> root_resources(args.dependency.GetRootResourceCount());
+	for (const ResourceBase *p_resource : args.metadata.GetIntRootResources()) {
+		std::size_t root_id = Dependency::GetResourceRootID(p_resource);
+		root_resources[root_id] = p_resource;
+		get_vk_alloc(p_resource) = snapshot.root_allocs[root_id];
+	}
+	const auto get_resources = [&](const std::vector<std::size_t> &root_ids) {
+		std::vector<const ResourceBase *> resources;
+		resources.reserve(root_ids.size());
+		for (std::size_t root_id : root_ids)
+			resources.push_back(root_resources[root_id]);
+		return resources;
+	};
+	for (const auto &snapshot_bucket : snapshot.mem_buckets) {
+		MemBucket bucket = {.key = snapshot_bucket.key,
+		                    .resources = get_resources(snapshot_bucket.root_ids),
+		                    .mem_reqs = snapshot_bucket.mem_reqs,
+		                    .create_info = snapshot_bucket.create_info};
+		for (const auto &packed_buffer : snapshot_bucket.packed_buffers)
+			bucket.packed_buffers.push_back(
+			    {.create_info = packed_buffer.create_info, .resources = get_resources(packed_buffer.root_ids)});
+		alloc.m_mem_buckets.push_back(std::move(bucket));
+	}
+
+	return alloc;
+}
 
+VkAllocation VkAllocation::Restore(const myvk::Ptr<myvk::Device> &device_ptr, const Args &args,
+                                   const Snapshot &snapshot) {
+	VkAllocation alloc = Plan(args, snapshot);
+	alloc.m_device_ptr = device_ptr;
+	alloc.create_vk_objects(args);
 	return alloc;
 }
 
+VkAllocation::Snapshot VkAllocation::MakeSnapshot(const Args &args) const {
+	Snapshot snapshot = {.resource_alias_relation = m_resource_alias_relation,
+	                     .alias_barrier_count = m_alias_barrier_count,
+	                     .alias_serialization = m_alias_serialization};
+	snapshot.root_allocs.resize(args.dependency.GetRootResourceCount());
+	for (const ResourceBase *p_resource : args.metadata.GetIntRootResources()) {
+		auto &root_alloc = snapshot.root_allocs[Dependency::GetResourceRootID(p_resource)];
+		root_alloc = get_vk_alloc(p_resource);
+		// Holding the objects would keep them out of the pool
+		root_alloc.image.myvk_image = nullptr;
+		root_alloc.image.myvk_image_view = nullptr;
+		root_alloc.buffer.myvk_buffer = nullptr;
+		root_alloc.buffer.buffer_view = {};
+		root_alloc.buffer.p_mapped = nullptr;
+		root_alloc.myvk_mem_alloc = nullptr;
+		root_alloc.mem_shared = false;
+	}
+	const auto get_root_ids = [](const std::vector<const ResourceBase *> &resources) {
+		std::vector<std::size_t> root_ids;
+		root_ids.reserve(resources.size());
+		for (const ResourceBase *p_resource : resources)
+			root_ids.push_back(Dependency::GetResourceRootID(p_resource));
+		return root_ids;
+	};
+	for (const MemBucket &bucket : m_mem_buckets) {
+		Snapshot::MemBucket snapshot_bucket = {.key = bucket.key,
+		                                       .root_ids = get_root_ids(bucket.resources),
+		                                       .mem_reqs = bucket.mem_reqs,
+		                                       .create_info = bucket.create_info};
+		for (const PackedBuffer &packed_buffer : bucket.packed_buffers)
+			snapshot_bucket.packed_buffers.push_back(
+			    {.create_info = packed_buffer.create_info, .root_ids = get_root_ids(packed_buffer.resources)});
+		snapshot.mem_buckets.push_back(std::move(snapshot_bucket));
+	}
+	return snapshot;
+}
+
+std::vector<std::span<const ResourceBase *const>> VkAllocation::GetPackedBufferGroups() const {
+	std::vector<std::span<const ResourceBase *const>> groups;
+	for (const MemBucket &bucket : m_mem_buckets)
+		for (const PackedBuffer &packed_buffer : bucket.packed_buffers)
+			groups.emplace_back(packed_buffer.resources);
+	return groups;
+}
+
+inline static bool IsMemBucketSharable(const VmaAllocationCreateInfo &create_info) {
+	return !(create_info.flags & VMA_ALLOCATION_CREATE_MAPPED_BIT);
+}
+
+std::vector<uint32_t> VkAllocation::GetSharableMemBuckets() const {
+	std::vector<uint32_t> keys;
+	for (const MemBucket &bucket : m_mem_buckets)
+		if (IsMemBucketSharable(bucket.create_info))
+			keys.push_back(bucket.key);
+	return keys;
+}
+
 void VkAllocation::init_alias_relation(const Args &args) {
 	m_resource_alias_relation.Reset(args.dependency.GetRootResourceCount(), args.dependency.GetRootResourceCount());
 }
 
-void VkAllocation::create_vk_resources(const Args &args) {
-	const auto create_image = [&](const InternalImage auto *p_image) {
+void VkAllocation::init_root_lifetimes(const Args &args) {
+	m_root_lifetimes.assign(args.dependency.GetRootResourceCount(),
+	                        {.first_topo_id = std::numeric_limits<std::size_t>::max(), .last_topo_id = 0});
+	for (const PassBase *p_pass : args.dependency.GetPasses()) {
+		std::size_t topo_id = Dependency::GetPassTopoID(p_pass);
+		for (const InputBase *p_input : Dependency::GetPassInputs(p_pass)) {
+			auto &lifetime = m_root_lifetimes[Dependency::GetResourceRootID(Dependency::GetInputResource(p_input))];
+			lifetime.first_topo_id = std::min(lifetime.first_topo_id, topo_id);
+			lifetime.last_topo_id = std::max(lifetime.last_topo_id, topo_id);
+		}
+	}
+}
+
+double VkAllocation::get_alias_serialization(const ResourceBase *p_l, const ResourceBase *p_r) const {
+	const auto &lifetime_l = m_root_lifetimes[Dependency::GetResourceRootID(p_l)],
+	           &lifetime_r = m_root_lifetimes[Dependency::GetResourceRootID(p_r)];
+	std::size_t distance = lifetime_l.last_topo_id < lifetime_r.first_topo_id
+	                           ? lifetime_r.first_topo_id - lifetime_l.last_topo_id
+	                           : lifetime_l.first_topo_id - std::min(lifetime_l.first_topo_id, lifetime_r.last_topo_id);
+	return 1.0 / double(std::max(distance, std::size_t{1}));
+}
+
+void VkAllocation::count_alias_barriers(const Args &args, const ResourceBase *p_l, const ResourceBase *p_r) {
+	for (auto [p_src, p_dst] : {std::pair{p_l, p_r}, std::pair{p_r, p_l}})
+		if (args.dependency.IsResourceLess(p_src, p_dst)) {
+			++m_alias_barrier_count;
+			m_alias_serialization += get_alias_serialization(p_src, p_dst);
+		}
+}
+
+void VkAllocation::plan_vk_resources(const DeviceModel &model, const Args &args) {
+	const auto plan_image = [&](const InternalImage auto *p_image) {
 		auto &vk_alloc = get_vk_alloc(p_image);
 
 		auto &alloc_info = Meta::GetAllocInfo(p_image);
@@ -140,11 +216,10 @@ void VkAllocation::create_vk_resources(const Args &args) {
 			}
 		}
 
-		vk_alloc.image.myvk_image = std::make_shared<RGImage>(m_device_ptr, create_info);
-		vkGetImageMemoryRequirements(m_device_ptr->GetHandle(), vk_alloc.image.myvk_image->GetHandle(),
-		                             &vk_alloc.vk_mem_reqs);
+		vk_alloc.image.vk_create_info = create_info;
+		vk_alloc.vk_mem_reqs = model.get_image_requirements(create_info);
 	};
-	const auto create_buffer = [&](const InternalBuffer auto *p_buffer) {
+	const auto plan_buffer = [&](const InternalBuffer auto *p_buffer) {
 		auto &vk_alloc = get_vk_alloc(p_buffer);
 
 		auto &alloc_info = Meta::GetAllocInfo(p_buffer);
@@ -155,13 +230,47 @@ void VkAllocation::create_vk_resources(const Args &args) {
 		create_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 		create_info.size = view_info.size;
 
-		vk_alloc.buffer.myvk_buffer = std::make_shared<RGBuffer>(m_device_ptr, create_info);
-		vkGetBufferMemoryRequirements(m_device_ptr->GetHandle(), vk_alloc.buffer.myvk_buffer->GetHandle(),
-		                              &vk_alloc.vk_mem_reqs);
+		vk_alloc.buffer.vk_create_info = create_info;
+		vk_alloc.vk_mem_reqs = model.get_buffer_requirements(create_info);
+
+		if (view_info.size <= args.buffer_pack_max_size) {
+			// Packed buffers only need offset alignment (and memory types for bucketing), the backing buffer is
+			// planned after placement
+			vk_alloc.buffer.packed = true;
+			vk_alloc.vk_mem_reqs.size = view_info.size;
+			vk_alloc.vk_mem_reqs.alignment = model.GetBufferOffsetAlignment(alloc_info.vk_usages);
+		}
 	};
 
 	for (const ResourceBase *p_resource : args.metadata.GetIntRootResources())
-		p_resource->Visit(overloaded(create_image, create_buffer, [](auto &&) {}));
+		p_resource->Visit(overloaded(plan_image, plan_buffer, [](auto &&) {}));
+}
+
+void VkAllocation::create_vk_objects(const Args &args) {
+	create_vk_resources(args);
+	create_vk_allocations(args);
+	bind_vk_resources(args);
+	create_resource_views(args);
+	for (MemBucket &bucket : m_mem_buckets)
+		for (PackedBuffer &packed_buffer : bucket.packed_buffers)
+			packed_buffer.backing = nullptr;
+}
+
+void VkAllocation::create_vk_resources(const Args &args) {
+	for (const ResourceBase *p_resource : args.metadata.GetIntRootResources())
+		p_resource->Visit(overloaded(
+		    [&](const InternalImage auto *p_image) {
+			    auto &vk_alloc = get_vk_alloc(p_image);
+			    vk_alloc.image.myvk_image =
+			        args.resource_pool.AcquireImage(m_device_ptr, vk_alloc.image.vk_create_info);
+		    },
+		    [&](const InternalBuffer auto *p_buffer) {
+			    auto &vk_alloc = get_vk_alloc(p_buffer);
+			    if (!vk_alloc.buffer.packed) // Packed buffers take their backing buffer in create_vk_allocations
+				    vk_alloc.buffer.myvk_buffer =
+				        args.resource_pool.AcquireBuffer(m_device_ptr, vk_alloc.buffer.vk_create_info);
+		    },
+		    [](auto &&) {}));
 }
 
 inline static constexpr VkDeviceSize DivCeil(VkDeviceSize l, VkDeviceSize r) { return (l / r) + (l % r ? 1 : 0); }
@@ -177,25 +286,78 @@ std::tuple<VkDeviceSize, uint32_t> VkAllocation::fetch_memory_requirements(std::
 	return {alignment, memory_type_bits};
 }
 
-void VkAllocation::alloc_naive(std::ranges::input_range auto &&resources, const VmaAllocationCreateInfo &create_info) {
-	auto [alignment, memory_type_bits] = fetch_memory_requirements(resources);
-	VkDeviceSize mem_total = 0;
+uint64_t VkAllocation::fetch_recycled_alloc(std::ranges::input_range auto &&resources) {
+	// The memory most recycled resources are bound to, reusing it keeps them valid
+	std::unordered_map<uint64_t, std::size_t> counts;
+	uint64_t alloc_serial = 0;
 	for (const ResourceBase *p_resource : resources) {
-		auto &vk_alloc = get_vk_alloc(p_resource);
-		vk_alloc.mem_offset = mem_total * alignment;
-		mem_total += DivCeil(vk_alloc.vk_mem_reqs.size, alignment);
+		uint64_t bound_serial = p_resource->Visit(overloaded(
+		    [](const InternalImage auto *p_image) {
+			    const auto &myvk_image = get_vk_alloc(p_image).image.myvk_image;
+			    return static_cast<const RGImage *>(myvk_image.get())->GetBoundSerial();
+		    },
+		    [](const InternalBuffer auto *p_buffer) {
+			    const auto &myvk_buffer = get_vk_alloc(p_buffer).buffer.myvk_buffer;
+			    return static_cast<const RGBuffer *>(myvk_buffer.get())->GetBoundSerial();
+		    },
+		    [](auto &&) -> uint64_t { return 0; }));
+		if (bound_serial && ++counts[bound_serial] > counts[alloc_serial])
+			alloc_serial = bound_serial;
 	}
-	if (mem_total == 0)
-		return;
+	return alloc_serial;
+}
 
-	VkMemoryRequirements mem_reqs = {
-	    .size = mem_total * alignment,
-	    .alignment = alignment,
-	    .memoryTypeBits = memory_type_bits,
-	};
-	auto mem_alloc = myvk::MakePtr<RGMemoryAllocation>(m_device_ptr, mem_reqs, create_info);
+std::vector<VkAllocation::PackedBuffer> VkAllocation::plan_packed_buffers(const DeviceModel &model,
+                                                                         std::ranges::input_range auto &&resources,
+                                                                         VkMemoryRequirements *p_mem_reqs) {
+	std::map<VkBufferUsageFlags, std::vector<const ResourceBase *>> usage_groups;
 	for (const ResourceBase *p_resource : resources)
-		get_vk_alloc(p_resource).myvk_mem_alloc = mem_alloc;
+		p_resource->Visit(overloaded(
+		    [&](const InternalBuffer auto *p_buffer) {
+			    if (get_vk_alloc(p_buffer).buffer.packed)
+				    usage_groups[Meta::GetAllocInfo(p_buffer).vk_usages].push_back(p_buffer);
+		    },
+		    [](auto &&) {}));
+
+	std::vector<PackedBuffer> packed_buffers;
+	for (auto &[usages, group] : usage_groups) {
+		VkBufferCreateInfo create_info = {VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO};
+		create_info.usage = usages;
+		create_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		for (const ResourceBase *p_resource : group) {
+			const auto &vk_alloc = get_vk_alloc(p_resource);
+			create_info.size = std::max(create_info.size, vk_alloc.mem_offset + vk_alloc.vk_mem_reqs.size);
+		}
+		VkMemoryRequirements backing_reqs = model.get_buffer_requirements(create_info);
+		p_mem_reqs->size = std::max(p_mem_reqs->size, backing_reqs.size);
+		p_mem_reqs->alignment = std::max(p_mem_reqs->alignment, backing_reqs.alignment);
+		p_mem_reqs->memoryTypeBits &= backing_reqs.memoryTypeBits;
+
+		packed_buffers.push_back({.create_info = create_info, .resources = std::move(group)});
+	}
+	return packed_buffers;
+}
+
+void VkAllocation::create_packed_buffers(const Args &args, std::vector<PackedBuffer> &packed_buffers) {
+	for (auto &[create_info, backing, group] : packed_buffers) {
+		backing = args.resource_pool.AcquireBuffer(m_device_ptr, create_info);
+		for (const ResourceBase *p_resource : group)
+			get_vk_alloc(p_resource).buffer.myvk_buffer = backing;
+	}
+}
+
+void VkAllocation::bind_packed_buffers(const Args &args, std::vector<PackedBuffer> &packed_buffers,
+                                       const myvk::Ptr<RGMemoryAllocation> &mem_alloc) {
+	for (auto &[_, backing, group] : packed_buffers) {
+		if (backing->GetBoundSerial() && !backing->IsBoundTo(mem_alloc.get(), 0))
+			backing = args.resource_pool.AcquireBuffer(m_device_ptr, backing->GetCreateInfo(), mem_alloc.get(), 0);
+		backing->Bind(mem_alloc, 0);
+		for (const ResourceBase *p_resource : group) {
+			auto &vk_alloc = get_vk_alloc(p_resource);
+			vk_alloc.buffer.myvk_buffer = backing;
+			vk_alloc.buffer.base_offset = vk_alloc.mem_offset;
+		}
+	}
 }
 
 namespace alloc_optimal {
@@ -211,8 +373,8 @@ struct MemEvent {
 };
 } // namespace alloc_optimal
 
-void VkAllocation::alloc_optimal(const Args &args, std::ranges::input_range auto &&resources,
-                                 const VmaAllocationCreateInfo &create_info) {
+VkMemoryRequirements VkAllocation::place_optimal(const Args &args, std::vector<const ResourceBase *> &resources,
+                                                 auto &&is_conflicted) {
 	auto [alignment, memory_type_bits] = fetch_memory_requirements(resources);
 
 	std::ranges::sort(resources, [&](const ResourceBase *p_l, const ResourceBase *p_r) -> bool {
@@ -230,11 +392,36 @@ void VkAllocation::alloc_optimal(const Args &args, std::ranges::input_range auto
 
 	VkDeviceSize mem_total = 0;
 
-	for (const ResourceBase *p_resource : resources) {
+	// Reuse the placement of a loaded plan if the memory requirements are unchanged
+	const auto get_plan_placement = [&](const ResourceBase *p_resource) -> const CompilePlan::MemPlacement * {
+		const auto &opt_placement = args.opt_p_plan->GetMemPlacements()[Dependency::GetResourceRootID(p_resource)];
+		const auto &vk_alloc = get_vk_alloc(p_resource);
+		return opt_placement && opt_placement->size == vk_alloc.vk_mem_reqs.size &&
+		               opt_placement->alignment == alignment && opt_placement->offset % alignment == 0 &&
+		               opt_placement->bucket == vk_alloc.mem_bucket
+		           ? &*opt_placement
+		           : nullptr;
+	};
+	bool use_plan = args.opt_p_plan && !args.opt_p_plan->GetMemPlacements().empty() &&
+	                std::ranges::all_of(resources, get_plan_placement);
+	if (use_plan) {
+		// The plan may be of other settings (e.g. mapped buffer aliasing), its overlaps must still be conflict-free
+		std::vector<std::pair<VkDeviceSize, VkDeviceSize>> plan_ranges;
+		plan_ranges.reserve(resources.size());
+		for (const ResourceBase *p_resource : resources) {
+			VkDeviceSize offset = get_plan_placement(p_resource)->offset;
+			plan_ranges.emplace_back(offset, offset + get_vk_alloc(p_resource).vk_mem_reqs.size);
+		}
+		ForEachIntervalOverlap<VkDeviceSize>(plan_ranges, [&](std::size_t l, std::size_t r) {
+			use_plan &= !is_conflicted(resources[l], resources[r]);
+		});
+	}
+
+	for (const ResourceBase *p_resource : use_plan ? std::span<const ResourceBase *>{} : resources) {
 		// Find an empty position to place
 		events.clear();
 		for (const auto &block : blocks)
-			if (args.dependency.IsResourceConflicted(p_resource, block.p_resource)) {
+			if (is_conflicted(p_resource, block.p_resource)) {
 				events.push_back({block.mem_begin, 1});
 				events.push_back({block.mem_end, (uint32_t)-1});
 			}
@@ -262,38 +449,140 @@ void VkAllocation::alloc_optimal(const Args &args, std::ranges::input_range auto
 			}
 		}
 
+		if (args.alias_barrier_weight > 0.0f) {
+			// Trade the footprint growth against the serialization of the barriers aliasing induces, the memory of
+			// resources accessed far earlier (or later) in the schedule is cheaper to reuse
+			const auto get_cost = [&](VkDeviceSize mem_pos) -> double {
+				VkDeviceSize mem_end = mem_pos + required_mem_size;
+				double serialization = 0.0;
+				for (const auto &block : blocks)
+					if (block.mem_begin < mem_end && mem_pos < block.mem_end)
+						serialization += get_alias_serialization(p_resource, block.p_resource);
+				double growth = double(std::max(mem_total, mem_end) - mem_total);
+				return growth / double(std::max(required_mem_size, VkDeviceSize{1})) +
+				       args.alias_barrier_weight * serialization;
+			};
+			double optimal_cost = get_cost(optimal_mem_pos);
+			const auto try_mem_pos = [&](VkDeviceSize mem_pos) {
+				if (double cost = get_cost(mem_pos); cost < optimal_cost) {
+					optimal_cost = cost;
+					optimal_mem_pos = mem_pos;
+				}
+			};
+			// Candidates are all fitting gaps, the top of the conflicted blocks and the top of the memory
+			if (!events.empty() && events.front().mem_pos >= required_mem_size)
+				try_mem_pos(0);
+			for (std::size_t i = 1; i < events.size(); ++i)
+				if (events[i - 1].cnt == 0 && events[i].cnt == 1 &&
+				    required_mem_size <= events[i].mem_pos - events[i - 1].mem_pos)
+					try_mem_pos(events[i - 1].mem_pos);
+			try_mem_pos(events.empty() ? 0 : events.back().mem_pos);
+			try_mem_pos(mem_total);
+		}
+
 		get_vk_alloc(p_resource).mem_offset = optimal_mem_pos * alignment;
 		mem_total = std::max(mem_total, optimal_mem_pos + required_mem_size);
 
 		blocks.push_back({optimal_mem_pos, optimal_mem_pos + required_mem_size, p_resource});
 	}
-
-	// Append alias relationships
-	for (const ResourceBase *p_l : resources) {
-		const auto &alloc_l = get_vk_alloc(p_l);
-		for (const ResourceBase *p_r : resources) {
-			const auto &alloc_r = get_vk_alloc(p_r);
-			// Check Overlapping
-			if (alloc_l.mem_offset + alloc_l.vk_mem_reqs.size > alloc_r.mem_offset &&
-			    alloc_r.mem_offset + alloc_r.vk_mem_reqs.size > alloc_l.mem_offset)
-				m_resource_alias_relation.Add(Dependency::GetResourceRootID(p_l), Dependency::GetResourceRootID(p_r));
+	for (const ResourceBase *p_resource : resources) {
+		auto &vk_alloc = get_vk_alloc(p_resource);
+		if (use_plan) {
+			vk_alloc.mem_offset = get_plan_placement(p_resource)->offset;
+			mem_total = std::max(mem_total,
+			                     vk_alloc.mem_offset / alignment + DivCeil(vk_alloc.vk_mem_reqs.size, alignment));
 		}
+		vk_alloc.mem_alignment = alignment;
+		vk_alloc.mem_aliased = true;
 	}
 
-	if (mem_total == 0)
-		return;
+	// Append alias relationships and count their barriers, only resources of disjoint lifetimes can overlap in memory
+	std::vector<std::pair<VkDeviceSize, VkDeviceSize>> mem_ranges;
+	mem_ranges.reserve(resources.size());
+	for (const ResourceBase *p_resource : resources) {
+		const auto &vk_alloc = get_vk_alloc(p_resource);
+		mem_ranges.emplace_back(vk_alloc.mem_offset, vk_alloc.mem_offset + vk_alloc.vk_mem_reqs.size);
+		if (vk_alloc.vk_mem_reqs.size)
+			m_resource_alias_relation.Add(Dependency::GetResourceRootID(p_resource),
+			                              Dependency::GetResourceRootID(p_resource));
+	}
+	ForEachIntervalOverlap<VkDeviceSize>(mem_ranges, [&](std::size_t l, std::size_t r) {
+		std::size_t root_id_l = Dependency::GetResourceRootID(resources[l]),
+		            root_id_r = Dependency::GetResourceRootID(resources[r]);
+		m_resource_alias_relation.Add(root_id_l, root_id_r);
+		m_resource_alias_relation.Add(root_id_r, root_id_l);
+		count_alias_barriers(args, resources[l], resources[r]);
+	});
 
-	VkMemoryRequirements mem_reqs = {
+	return {
 	    .size = mem_total * alignment,
 	    .alignment = alignment,
 	    .memoryTypeBits = memory_type_bits,
 	};
-	auto mem_alloc = myvk::MakePtr<RGMemoryAllocation>(m_device_ptr, mem_reqs, create_info);
-	for (const ResourceBase *p_resource : resources)
-		get_vk_alloc(p_resource).myvk_mem_alloc = mem_alloc;
+}
+
+void VkAllocation::plan_optimal(const DeviceModel &model, const Args &args, std::ranges::input_range auto &&resources,
+                                const VmaAllocationCreateInfo &create_info, auto &&is_conflicted) {
+	// Bucket by the memory type each resource prefers, so that no resource is forced into a slower type (or an
+	// unsupported one) by the others. Linear buffers and optimal images are also split if bufferImageGranularity
+	// requires padding between them.
+	std::map<uint32_t, std::vector<const ResourceBase *>> bucket_map;
+	for (const ResourceBase *p_resource : resources) {
+		auto &vk_alloc = get_vk_alloc(p_resource);
+		uint32_t memory_type = model.FindMemoryType(vk_alloc.vk_mem_reqs.memoryTypeBits, create_info.requiredFlags);
+		// If no allowed type has the required flags, fall back to the unfiltered type bits
+		if (memory_type == UINT32_MAX)
+			memory_type = model.FindMemoryType(vk_alloc.vk_mem_reqs.memoryTypeBits, 0);
+		bool linear = model.buffer_image_granularity > 1 && p_resource->GetType() == ResourceType::kBuffer;
+		vk_alloc.mem_bucket = memory_type << 1u | linear;
+		bucket_map[vk_alloc.mem_bucket].push_back(p_resource);
+	}
+
+	for (auto &[bucket_key, bucket_resources] : bucket_map) {
+		MemBucket bucket = {.key = bucket_key, .resources = std::move(bucket_resources), .create_info = create_info};
+		bucket.mem_reqs = place_optimal(args, bucket.resources, is_conflicted);
+		if (bucket.mem_reqs.size == 0)
+			continue;
+		bucket.packed_buffers = plan_packed_buffers(model, bucket.resources, &bucket.mem_reqs);
+		// Pin the allocation to the memory type the bucket is planned for
+		if (uint32_t memory_type = bucket_key >> 1u; memory_type < 32u) {
+			bucket.mem_reqs.memoryTypeBits &= 1u << memory_type;
+			bucket.create_info.memoryTypeBits = 1u << memory_type;
+			// A fallback type lacks the required flags, which are only preferred then
+			if ((model.memory_types[memory_type] & create_info.requiredFlags) != create_info.requiredFlags) {
+				bucket.create_info.preferredFlags |= create_info.requiredFlags;
+				bucket.create_info.requiredFlags = 0;
+			}
+		}
+		m_mem_buckets.push_back(std::move(bucket));
+	}
 }
 
 void VkAllocation::create_vk_allocations(const Args &args) {
+	for (MemBucket &bucket : m_mem_buckets) {
+		create_packed_buffers(args, bucket.packed_buffers);
+		// Each device-local bucket goes to the heap bucket of its key, memory the heap cannot share with the other
+		// executors falls back to a private allocation
+		myvk::Ptr<RGMemoryAllocation> mem_alloc =
+		    args.opt_p_transient_heap && IsMemBucketSharable(bucket.create_info)
+		        ? args.opt_p_transient_heap->acquire(m_device_ptr, bucket.key, bucket.mem_reqs, bucket.create_info,
+		                                             args.resource_pool)
+		        : nullptr;
+		bool mem_shared = mem_alloc != nullptr;
+		m_mem_shared |= mem_shared;
+		if (!mem_alloc)
+			mem_alloc = args.resource_pool.AcquireMemory(m_device_ptr, bucket.mem_reqs, bucket.create_info,
+			                                             fetch_recycled_alloc(bucket.resources));
+		bind_packed_buffers(args, bucket.packed_buffers, mem_alloc);
+		for (const ResourceBase *p_resource : bucket.resources) {
+			auto &vk_alloc = get_vk_alloc(p_resource);
+			vk_alloc.myvk_mem_alloc = mem_alloc;
+			vk_alloc.mem_shared = mem_shared;
+		}
+	}
+}
+
+void VkAllocation::plan_vk_allocations(const DeviceModel &model, const Args &args) {
 	std::vector<const ResourceBase *> optimal_resources, mapped_resources;
 	for (const ResourceBase *p_resource : args.metadata.GetIntRootResources())
 		p_resource->Visit(overloaded(
@@ -302,40 +591,61 @@ void VkAllocation::create_vk_allocations(const Args &args) {
 			    (Meta::GetAllocInfo(p_buffer).mapped ? mapped_resources : optimal_resources).push_back(p_buffer);
 		    },
 		    [](auto &&) {}));
-	alloc_optimal(args, optimal_resources,
-	              VmaAllocationCreateInfo{
-	                  .flags = /* VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT | */ VMA_ALLOCATION_CREATE_CAN_ALIAS_BIT,
-	                  .requiredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-	              });
-	alloc_naive(mapped_resources,
-	            VmaAllocationCreateInfo{
-	                .flags = /* VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT | */ VMA_ALLOCATION_CREATE_MAPPED_BIT |
-	                         VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT,
-	                .requiredFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-	            });
+	plan_optimal(model, args, optimal_resources,
+	             VmaAllocationCreateInfo{
+	                 .flags = /* VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT | */ VMA_ALLOCATION_CREATE_CAN_ALIAS_BIT,
+	                 .requiredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+	             },
+	             [&](const ResourceBase *p_l, const ResourceBase *p_r) {
+		              return args.dependency.IsResourceConflicted(p_l, p_r);
+	             });
+
+	// The host writes mapped buffers before the execution and reads them back after it, so a host-written buffer
+	// lives from the beginning and a host-read one until the end. Without mapped aliasing, every mapped buffer keeps
+	// its own memory.
+	const auto is_mapped_less = [&](const ResourceBase *p_l, const ResourceBase *p_r) {
+		return args.alias_mapped_buffers && !Meta::GetAllocInfo(static_cast<const BufferBase *>(p_l)).host_read &&
+		       !Meta::GetAllocInfo(static_cast<const BufferBase *>(p_r)).host_written &&
+		       args.dependency.IsResourceLess(p_l, p_r);
+	};
+	plan_optimal(model, args, mapped_resources,
+	             VmaAllocationCreateInfo{
+	                 .flags = /* VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT | */ VMA_ALLOCATION_CREATE_MAPPED_BIT |
+	                          VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT |
+	                          VMA_ALLOCATION_CREATE_CAN_ALIAS_BIT,
+	                 .requiredFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+	             },
+	             [&](const ResourceBase *p_l, const ResourceBase *p_r) {
+		              return !is_mapped_less(p_l, p_r) && !is_mapped_less(p_r, p_l);
+	             });
 }
 
 void VkAllocation::bind_vk_resources(const Args &args) {
 	for (const ResourceBase *p_resource : args.metadata.GetIntRootResources()) {
 		auto &vk_alloc = get_vk_alloc(p_resource);
+		const RGMemoryAllocation *mem_alloc = vk_alloc.myvk_mem_alloc.get();
 
 		p_resource->Visit(overloaded(
 		    [&](const InternalImage auto *p_image) {
-			    auto &myvk_image = vk_alloc.image.myvk_image;
-
-			    auto vma_allocation = vk_alloc.myvk_mem_alloc->GetHandle();
-			    vmaBindImageMemory2(m_device_ptr->GetAllocatorHandle(), vma_allocation, vk_alloc.mem_offset,
-			                        myvk_image->GetHandle(), nullptr);
-			    static_cast<RGImage *>(myvk_image.get())->SetAllocPtr(vk_alloc.myvk_mem_alloc);
+			    auto myvk_image = std::static_pointer_cast<RGImage>(vk_alloc.image.myvk_image);
+			    // A recycled image is already bound, swap it for one bound to the target placement (or a new one)
+			    if (myvk_image->GetBoundSerial() && !myvk_image->IsBoundTo(mem_alloc, vk_alloc.mem_offset))
+				    myvk_image = args.resource_pool.AcquireImage(m_device_ptr, myvk_image->GetCreateInfo(), mem_alloc,
+				                                                 vk_alloc.mem_offset);
+			    myvk_image->Bind(vk_alloc.myvk_mem_alloc, vk_alloc.mem_offset);
+			    vk_alloc.image.myvk_image = std::move(myvk_image);
 		    },
 		    [&](const InternalBuffer auto *p_buffer) {
-			    auto &myvk_buffer = vk_alloc.buffer.myvk_buffer;
-			    auto *mapped_data = (uint8_t *)vk_alloc.myvk_mem_alloc->GetInfo().pMappedData;
+			    if (!vk_alloc.buffer.packed) { // Packed buffers are bound with their backing buffer
+				    auto myvk_buffer = std::static_pointer_cast<RGBuffer>(vk_alloc.buffer.myvk_buffer);
+				    if (myvk_buffer->GetBoundSerial() && !myvk_buffer->IsBoundTo(mem_alloc, vk_alloc.mem_offset))
+					    myvk_buffer = args.resource_pool.AcquireBuffer(m_device_ptr, myvk_buffer->GetCreateInfo(),
+					                                                   mem_alloc, vk_alloc.mem_offset);
+				    myvk_buffer->Bind(vk_alloc.myvk_mem_alloc, vk_alloc.mem_offset);
+				    vk_alloc.buffer.myvk_buffer = std::move(myvk_buffer);
+			    }
 
-			    auto vma_allocation = vk_alloc.myvk_mem_alloc->GetHandle();
-			    vmaBindBufferMemory2(m_device_ptr->GetAllocatorHandle(), vma_allocation, vk_alloc.mem_offset,
-			                         myvk_buffer->GetHandle(), nullptr);
-			    static_cast<RGBuffer *>(myvk_buffer.get())->SetAllocPtr(vk_alloc.myvk_mem_alloc);
+			    auto *mapped_data = (uint8_t *)vk_alloc.myvk_mem_alloc->GetInfo().pMappedData;
 			    vk_alloc.buffer.p_mapped = mapped_data ? mapped_data + vk_alloc.mem_offset : nullptr;
 		    },
 		    [](auto &&) {}));
@@ -358,7 +668,7 @@ void VkAllocation::create_resource_views(const Args &args) {
 		create_info.subresourceRange.aspectMask = VkImageAspectFlagsFromVkFormat(create_info.format);
 
 		auto &vk_image_alloc = get_vk_alloc(p_image).image;
-		vk_image_alloc.myvk_image_view = myvk::ImageView::Create(root_vk_alloc.myvk_image, create_info);
+		vk_image_alloc.myvk_image_view = myvk::ImageView::CreateCached(root_vk_alloc.myvk_image, create_info);
 	};
 	const auto create_buffer_view = [&](const InternalBuffer auto *p_buffer) {
 		const auto &root_vk_alloc = get_vk_alloc(Dependency::GetRootResource(p_buffer)).buffer;
@@ -367,7 +677,7 @@ void VkAllocation::create_resource_views(const Args &args) {
 		auto &vk_buffer_alloc = get_vk_alloc(p_buffer).buffer;
 		vk_buffer_alloc.buffer_view = {
 		    .buffer = root_vk_alloc.myvk_buffer,
-		    .offset = view.offset,
+		    .offset = root_vk_alloc.base_offset + view.offset,
 		    .size = view.size,
 		};
 		vk_buffer_alloc.p_mapped =
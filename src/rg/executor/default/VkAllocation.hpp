@@ -6,39 +6,141 @@
 #ifndef MYVK_RG_EXE_DEF_ALLOCATOR_HPP
 #define MYVK_RG_EXE_DEF_ALLOCATOR_HPP
 
+#include "CompilePlan.hpp"
+#include "DeviceModel.hpp"
 #include "Metadata.hpp"
 
 #include <myvk/Device.hpp>
+#include <myvk_rg/executor/TransientHeap.hpp>
+
+#include <span>
 
 namespace myvk_rg_executor {
 
+class ResourcePool;
+class RGBuffer;
+
 class VkAllocation {
-private:
+public:
+	// Memory layout of a compiled allocation, restorable into a graph with the same structural hash
+	// No Vulkan object is held, the images, buffers and memory stay in the ResourcePool until restored
+	struct Snapshot {
+		struct PackedBuffer {
+			VkBufferCreateInfo create_info;
+			std::vector<std::size_t> root_ids;
+		};
+		struct MemBucket {
+			uint32_t key;
+			std::vector<std::size_t> root_ids;
+			VkMemoryRequirements mem_reqs;
+			VmaAllocationCreateInfo create_info;
+			std::vector<PackedBuffer> packed_buffers;
+		};
+		std::vector<std::remove_cvref_t<decltype(ResourceInfo::vk_allocation)>> root_allocs; // Indexed by root ID
+		std::vector<MemBucket> mem_buckets;
+		Relation resource_alias_relation;
+		std::size_t alias_barrier_count;
+		double alias_serialization;
+	};
 	struct Args {
 		const RenderGraphBase &render_graph;
 		const Collection &collection;
 		const Dependency &dependency;
 		const Metadata &metadata;
+		ResourcePool &resource_pool; // Images, buffers and memory are drawn from it first
+		const CompilePlan *opt_p_plan{}; // Memory placements are reused if compatible
+		myvk_rg::executor::TransientHeap *opt_p_transient_heap{}; // Aliased resources are placed in it if set
+		VkDeviceSize buffer_pack_max_size{}; // Buffers up to the size share backing VkBuffers, 0 disables packing
+		bool alias_mapped_buffers{}; // Mapped buffers of disjoint lifetimes share memory, otherwise none do
+		float alias_barrier_weight{}; // Cost of aliasing barriers against memory growth, 0 only minimizes memory
 	};
 
+private:
 	myvk::Ptr<myvk::Device> m_device_ptr;
 
 	Relation m_resource_alias_relation;
+	bool m_mem_shared{false};
+
+	// Passes accessing each root resource, in topological order
+	struct Lifetime {
+		std::size_t first_topo_id, last_topo_id;
+	};
+	std::vector<Lifetime> m_root_lifetimes;
+	std::size_t m_alias_barrier_count{};
+	double m_alias_serialization{};
 
 	static auto &get_vk_alloc(const ResourceBase *p_resource) { return GetResourceInfo(p_resource).vk_allocation; }
 
+	// Packed buffers of the same usages and memory, bound as one backing buffer at offset 0
+	struct PackedBuffer {
+		VkBufferCreateInfo create_info; // Of the backing buffer
+		myvk::Ptr<RGBuffer> backing;
+		std::vector<const ResourceBase *> resources;
+	};
+	// Aliased resources of one memory type (and tiling), placed from offset 0 of one allocation
+	struct MemBucket {
+		uint32_t key; // Memory type index << 1 | linear tiling
+		std::vector<const ResourceBase *> resources;
+		VkMemoryRequirements mem_reqs;
+		VmaAllocationCreateInfo create_info;
+		std::vector<PackedBuffer> packed_buffers;
+	};
+	std::vector<MemBucket> m_mem_buckets; // Planned, the backing buffers are released once created
+
 	void init_alias_relation(const Args &args);
-	void create_vk_resources(const Args &args);
+	void init_root_lifetimes(const Args &args);
+	// 1 / (pass distance) of two resources, as aliasing them serializes the passes in between
+	double get_alias_serialization(const ResourceBase *p_l, const ResourceBase *p_r) const;
+	// Counts the validation barriers of two overlapping resources, the same condition as in VkCommand
+	void count_alias_barriers(const Args &args, const ResourceBase *p_l, const ResourceBase *p_r);
+	// Planning, device-free
+	void plan_vk_resources(const DeviceModel &model, const Args &args);
 	static std::tuple<VkDeviceSize, uint32_t> fetch_memory_requirements(std::ranges::input_range auto &&resources);
-	void alloc_naive(std::ranges::input_range auto &&resources, const VmaAllocationCreateInfo &create_info);
-	void alloc_optimal(const Args &args, std::ranges::input_range auto &&resources,
-	                   const VmaAllocationCreateInfo &create_info);
+	static uint64_t fetch_recycled_alloc(std::ranges::input_range auto &&resources); // Serial of the memory
+	// Places resources from offset 0, aliasing the ones that are not conflicted, returns the total requirements
+	VkMemoryRequirements place_optimal(const Args &args, std::vector<const ResourceBase *> &resources,
+	                                   auto &&is_conflicted);
+	// Places resources in memory type buckets, one allocation each
+	void plan_optimal(const DeviceModel &model, const Args &args, std::ranges::input_range auto &&resources,
+	                  const VmaAllocationCreateInfo &create_info, auto &&is_conflicted);
+	static std::vector<PackedBuffer> plan_packed_buffers(const DeviceModel &model,
+	                                                     std::ranges::input_range auto &&resources,
+	                                                     VkMemoryRequirements *p_mem_reqs);
+	void plan_vk_allocations(const DeviceModel &model, const Args &args);
+
+	// Creation of the planned Vulkan objects
+	void create_vk_objects(const Args &args);
+	void create_vk_resources(const Args &args);
+	void create_packed_buffers(const Args &args, std::vector<PackedBuffer> &packed_buffers);
+	void bind_packed_buffers(const Args &args, std::vector<PackedBuffer> &packed_buffers,
+	                         const myvk::Ptr<RGMemoryAllocation> &mem_alloc);
 	void create_vk_allocations(const Args &args);
 	void bind_vk_resources(const Args &args);
 	void create_resource_views(const Args &args);
 
 public:
 	static VkAllocation Create(const myvk::Ptr<myvk::Device> &device_ptr, const Args &args);
+	// Memory requirements, placement, alias relation and barrier statistics only, no Vulkan object is created and
+	// Args::resource_pool and Args::opt_p_transient_heap are unused. Create() plans with DeviceModel::FromDevice().
+	static VkAllocation Plan(const DeviceModel &model, const Args &args);
+	// Layout of a snapshot without planning, device-free like Plan()
+	static VkAllocation Plan(const Args &args, const Snapshot &snapshot);
+	// Creates the layout of a snapshot, the objects it was made with are drawn back from the resource pool (or from
+	// the transient heap) if they are still pooled
+	static VkAllocation Restore(const myvk::Ptr<myvk::Device> &device_ptr, const Args &args, const Snapshot &snapshot);
+	Snapshot MakeSnapshot(const Args &args) const;
+
+	// Whether the aliased memory is shared with other executors through a TransientHeap
+	inline bool IsMemShared() const { return m_mem_shared; }
+	// Root buffers sharing each backing VkBuffer
+	std::vector<std::span<const ResourceBase *const>> GetPackedBufferGroups() const;
+	// Memory buckets placed in the bucket of the same key of a bound TransientHeap, all device-local ones (mapped
+	// memory is never shared to keep its data)
+	std::vector<uint32_t> GetSharableMemBuckets() const;
+
+	// Validation barriers induced by aliasing (ordered pairs of aliased resources) and their summed serialization
+	inline std::size_t GetAliasBarrierCount() const { return m_alias_barrier_count; }
+	inline double GetAliasSerialization() const { return m_alias_serialization; }
 
 	// Resource Alias Relationship
 	inline bool IsAliased(const ResourceBase *p_l, const ResourceBase *p_r) const {
@@ -52,6 +154,18 @@ public:
 		return get_vk_alloc(p_buffer).buffer.buffer_view;
 	}
 	static void *GetMappedData(const InternalBuffer auto *p_buffer) { return get_vk_alloc(p_buffer).buffer.p_mapped; }
+
+	// Memory Placement (on Internal Root Resources)
+	static bool IsMemAliased(const ResourceBase *p_resource) { return get_vk_alloc(p_resource).mem_aliased; }
+	static VkDeviceSize GetMemOffset(const ResourceBase *p_resource) { return get_vk_alloc(p_resource).mem_offset; }
+	// Memory type index << 1 | linear tiling, resources of different buckets are in different allocations
+	static uint32_t GetMemBucket(const ResourceBase *p_resource) { return get_vk_alloc(p_resource).mem_bucket; }
+	static VkDeviceSize GetMemAlignment(const ResourceBase *p_resource) {
+		return get_vk_alloc(p_resource).mem_alignment;
+	}
+	static const VkMemoryRequirements &GetMemRequirements(const ResourceBase *p_resource) {
+		return get_vk_alloc(p_resource).vk_mem_reqs;
+	}
 };
 
 } // namespace myvk_rg_executor
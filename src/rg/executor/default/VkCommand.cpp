@@ -478,6 +478,10 @@ void VkCommand::Builder::pop_pass(const myvk::Ptr<myvk::Device> &device_ptr, con
 		    .pPreserveAttachments = info.preserve_attachments.data(),
 		});
 
+	// Planning without a device stops at the barriers and attachments
+	if (!device_ptr)
+		return;
+
 	// Create RenderPass
 	VkRenderPassCreateInfo2 render_pass_create_info = {
 	    .sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO_2,
@@ -488,7 +492,7 @@ void VkCommand::Builder::pop_pass(const myvk::Ptr<myvk::Device> &device_ptr, con
 	    .dependencyCount = (uint32_t)vk_subpass_dependencies.size(),
 	    .pDependencies = vk_subpass_dependencies.data(),
 	};
-	p_out->myvk_render_pass = myvk::RenderPass::Create(device_ptr, render_pass_create_info);
+	p_out->myvk_render_pass = myvk::RenderPass::CreateCached(device_ptr, render_pass_create_info);
 
 	// Create Imageless Framebuffer
 	std::vector<VkFramebufferAttachmentImageInfo> vk_fb_att_image_infos;
@@ -511,8 +515,8 @@ void VkCommand::Builder::pop_pass(const myvk::Ptr<myvk::Device> &device_ptr, con
 		});
 	}
 	const auto &area = Metadata::GetPassRenderArea(in.subpasses[0]);
-	p_out->myvk_framebuffer =
-	    myvk::ImagelessFramebuffer::Create(p_out->myvk_render_pass, vk_fb_att_image_infos, area.extent, area.layers);
+	p_out->myvk_framebuffer = myvk::ImagelessFramebuffer::CreateCached(p_out->myvk_render_pass, vk_fb_att_image_infos,
+	                                                                   area.extent, area.layers);
 }
 
 VkCommand VkCommand::Create(const myvk::Ptr<myvk::Device> &device_ptr, const Args &args) {
@@ -10,6 +10,8 @@
 #include "Schedule.hpp"
 #include "VkAllocation.hpp"
 
+#include <myvk_rg/executor/Trace.hpp>
+
 namespace myvk_rg_executor {
 
 class VkCommand {
@@ -39,18 +41,22 @@ private:
 	std::vector<BarrierCmd> m_post_barriers;
 
 public:
+	// With a null device_ptr, only barriers and attachments are generated (no RenderPass or Framebuffer)
 	static VkCommand Create(const myvk::Ptr<myvk::Device> &device_ptr, const Args &args);
 	inline const auto &GetPassCommands() const { return m_pass_commands; }
 	inline const auto &GetPostBarriers() const { return m_post_barriers; }
-	static void CreatePipeline(const PassBase *p_pass) {
-		if (GetPassInfo(p_pass).vk_command.update_pipeline) {
-			GetPassInfo(p_pass).vk_command.update_pipeline = false;
-			GetPassInfo(p_pass).vk_command.vk_pipeline = p_pass->Visit(overloaded(
-			    [](PassWithPipeline auto *p_pipeline_pass) -> myvk::Ptr<myvk::PipelineBase> {
-				    return p_pipeline_pass->CreatePipeline();
-			    },
-			    [](auto &&) -> myvk::Ptr<myvk::PipelineBase> { return nullptr; }));
-		}
+	// Returns true if the pipeline is (re-)created
+	static bool CreatePipeline(const PassBase *p_pass) {
+		if (!GetPassInfo(p_pass).vk_command.update_pipeline)
+			return false;
+		TraceSpan span{"pipeline", p_pass->GetGlobalKey()};
+		GetPassInfo(p_pass).vk_command.update_pipeline = false;
+		GetPassInfo(p_pass).vk_command.vk_pipeline = p_pass->Visit(overloaded(
+		    [](PassWithPipeline auto *p_pipeline_pass) -> myvk::Ptr<myvk::PipelineBase> {
+			    return p_pipeline_pass->CreatePipeline();
+		    },
+		    [](auto &&) -> myvk::Ptr<myvk::PipelineBase> { return nullptr; }));
+		return true;
 	}
 	static const myvk::Ptr<myvk::PipelineBase> &GetVkPipeline(const PassBase *p_pass) {
 		return GetPassInfo(p_pass).vk_command.vk_pipeline;
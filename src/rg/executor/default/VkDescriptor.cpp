@@ -152,7 +152,7 @@ void VkDescriptor::create_vk_sets(const VkDescriptor::Args &args) {
 		}
 
 		// Create Layout
-		auto myvk_layout = myvk::DescriptorSetLayout::Create(m_device_ptr, layout_bindings);
+		auto myvk_layout = myvk::DescriptorSetLayout::CreateCached(m_device_ptr, layout_bindings);
 		desc_info.myvk_layout = myvk_layout;
 
 		// Push VkDescriptorLayouts for Batch Creation
@@ -6,18 +6,94 @@
 
 #include "../Barrier.hpp"
 
+#include <chrono>
+#include <unordered_set>
+
 namespace myvk_rg_executor {
 
 VkRunner VkRunner::Create(const VkRunner::Args &args) {
-	args.collection.ClearInfo(&ResourceInfo::vk_runner);
+	args.collection.ClearInfo(&ResourceInfo::vk_runner, &PassInfo::vk_runner);
 	return {};
 }
 
+const char *VkRunner::get_debug_label(const PassBase *p_pass) {
+	auto &label = get_runner_cache(p_pass).debug_label;
+	if (label.empty())
+		label = p_pass->GetGlobalKey().Format();
+	return label.c_str();
+}
+
+const char *VkRunner::get_group_debug_label(const PassBase *p_first_subpass) {
+	auto &label = get_runner_cache(p_first_subpass).group_debug_label;
+	if (label.empty())
+		label = "[RenderPass] " + p_first_subpass->GetGlobalKey().Format();
+	return label.c_str();
+}
+
+void VkRunner::set_vk_pipeline_name(const PassBase *p_pass) {
+	const auto &myvk_pipeline = VkCommand::GetVkPipeline(p_pass);
+	if (myvk_pipeline)
+		myvk_pipeline->GetDevicePtr()->SetObjectName(VK_OBJECT_TYPE_PIPELINE, (uint64_t)myvk_pipeline->GetHandle(),
+		                                             get_debug_label(p_pass));
+}
+
+std::string VkRunner::GetPackedBufferName(std::span<const ResourceBase *const> buffers) {
+	std::string name = "[Packed]";
+	for (const ResourceBase *p_buffer : buffers)
+		name += " " + p_buffer->GetGlobalKey().Format();
+	return name;
+}
+
+void VkRunner::SetVkObjectNames(const myvk::Ptr<myvk::Device> &device, const Args &args) {
+	if (!myvk::Device::IsDebugUtilsAvailable())
+		return;
+
+	const auto set_buffer_name = [&](const ResourceBase *p_resource, const std::string &name) {
+		p_resource->Visit(overloaded(
+		    [&](const InternalBuffer auto *p_buffer) {
+			    device->SetObjectName(VK_OBJECT_TYPE_BUFFER, (uint64_t)p_buffer->GetBufferView().buffer->GetHandle(),
+			                          name.c_str());
+		    },
+		    [](auto &&) {}));
+	};
+	// A backing buffer is named once after all the buffers packed in it
+	std::unordered_set<const ResourceBase *> packed_buffers;
+	for (std::span<const ResourceBase *const> group : args.vk_allocation.GetPackedBufferGroups()) {
+		packed_buffers.insert(group.begin(), group.end());
+		set_buffer_name(group.front(), GetPackedBufferName(group));
+	}
+
+	for (const ResourceBase *p_resource : args.metadata.GetIntRootResources()) {
+		std::string name = p_resource->GetGlobalKey().Format();
+		p_resource->Visit(overloaded(
+		    [&](const InternalImage auto *p_image) {
+			    const auto &myvk_view = p_image->GetVkImageView();
+			    device->SetObjectName(VK_OBJECT_TYPE_IMAGE, (uint64_t)myvk_view->GetImagePtr()->GetHandle(),
+			                          name.c_str());
+			    device->SetObjectName(VK_OBJECT_TYPE_IMAGE_VIEW, (uint64_t)myvk_view->GetHandle(), name.c_str());
+		    },
+		    [&](const InternalBuffer auto *p_buffer) {
+			    if (!packed_buffers.contains(p_buffer))
+				    set_buffer_name(p_buffer, name);
+		    },
+		    [](auto &&) {}));
+	}
+	for (const PassBase *p_pass : args.dependency.GetPasses()) {
+		const auto &myvk_set = VkDescriptor::GetVkDescriptorSet(p_pass);
+		if (myvk_set)
+			device->SetObjectName(VK_OBJECT_TYPE_DESCRIPTOR_SET, (uint64_t)myvk_set->GetHandle(),
+			                      get_debug_label(p_pass));
+		set_vk_pipeline_name(p_pass);
+	}
+}
+
 void VkRunner::cmd_pipeline_barriers(const myvk::Ptr<myvk::CommandBuffer> &command_buffer,
                                      std::span<const BarrierCmd> barrier_cmds) {
 	if (barrier_cmds.empty())
 		return;
 
+	TraceSpan span{"record", "Barriers"};
+
 	std::vector<VkBufferMemoryBarrier2> buffer_barriers;
 	std::vector<VkImageMemoryBarrier2> image_barriers;
 
@@ -63,24 +139,92 @@ void VkRunner::update_ext_cache(const VkRunner::Args &args) {
 		    },
 		    [&](const ExternalBufferBase *p_ext_buffer) {
 			    const auto &buffer_view = p_ext_buffer->GetBufferView();
-			    cache.ext_changed = buffer_view != cache.ext_buffer_view_cache;
+			    VkBuffer buffer_handle = buffer_view.buffer ? buffer_view.buffer->GetHandle() : VK_NULL_HANDLE;
+			    cache.ext_changed =
+			        buffer_view != cache.ext_buffer_view_cache || buffer_handle != cache.ext_buffer_handle_cache;
 			    cache.ext_buffer_view_cache = buffer_view;
+			    cache.ext_buffer_handle_cache = buffer_handle;
 		    },
 		    [](auto &&) {}));
 	}
 }
 
-void VkRunner::Run(const myvk::Ptr<myvk::CommandBuffer> &command_buffer, const Args &args) {
+void VkRunner::record_pipeline_creation(const PassBase *p_pass, std::chrono::steady_clock::time_point begin,
+                                        std::map<GlobalKey, PipelineCreationRecord> *p_pipeline_records) {
+	auto end = std::chrono::steady_clock::now();
+	double ms = std::chrono::duration<double, std::milli>(end - begin).count();
+	auto &record = (*p_pipeline_records)[p_pass->GetGlobalKey()];
+	++record.creation_count;
+	record.total_ms += ms;
+	record.max_ms = std::max(record.max_ms, ms);
+	record.last_ms = ms;
+
+	const auto &myvk_pipeline = VkCommand::GetVkPipeline(p_pass);
+	// The feedback of a pipeline created before the call belongs to its first creation
+	record.last_reused = myvk_pipeline && myvk_pipeline->GetCreationFeedback().end_time < begin;
+	record.last_feedback = myvk_pipeline && !record.last_reused ? myvk_pipeline->GetCreationFeedback()
+	                                                            : myvk::PipelineCreationFeedback{};
+	if (record.last_reused)
+		++record.reuse_count;
+	else if (record.last_feedback.cache_hit)
+		++record.cache_hit_count;
+}
+
+void VkRunner::Run(const myvk::Ptr<myvk::CommandBuffer> &command_buffer, const Args &args,
+                   Profiler *p_profiler, bool debug_utils,
+                   std::map<GlobalKey, PipelineCreationRecord> *p_pipeline_records) {
 	update_ext_cache(args);
 	args.vk_descriptor.VkUpdateExternal(args.dependency.GetPasses());
 
+	if (p_profiler) {
+		uint32_t max_scope_count = 1; // Post barriers
+		for (const auto &pass_cmd : args.vk_command.GetPassCommands())
+			max_scope_count += 2 + (pass_cmd.myvk_render_pass ? pass_cmd.subpasses.size() : 0);
+		p_profiler->CmdBeginFrame(command_buffer, max_scope_count);
+		if (!p_profiler->IsFrameActive())
+			p_profiler = nullptr;
+	}
+	const auto profile = [&](ProfileScope scope, const GlobalKey &key, auto &&cmd_func) {
+		if (p_profiler) {
+			uint32_t scope_id = p_profiler->CmdBeginScope(command_buffer, scope, key);
+			cmd_func();
+			p_profiler->CmdEndScope(command_buffer, scope_id);
+		} else
+			cmd_func();
+	};
+
+	if (args.vk_allocation.IsMemShared()) {
+		// Other executors sharing the transient heap may have accessed the memory before
+		VkMemoryBarrier2 heap_barrier = {.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+		                                 .srcStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+		                                 .srcAccessMask = VK_ACCESS_2_MEMORY_WRITE_BIT,
+		                                 .dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+		                                 .dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT};
+		command_buffer->CmdPipelineBarrier2({heap_barrier}, {}, {});
+	}
+
 	const auto run_pass = [&](const PassBase *p_pass) {
-		VkCommand::CreatePipeline(p_pass);
+		auto create_begin = std::chrono::steady_clock::now();
+		if (VkCommand::CreatePipeline(p_pass)) {
+			if (p_pipeline_records)
+				record_pipeline_creation(p_pass, create_begin, p_pipeline_records);
+			if (debug_utils)
+				set_vk_pipeline_name(p_pass);
+		}
+		TraceSpan span{"record", p_pass->GetGlobalKey()};
+		if (debug_utils)
+			command_buffer->CmdBeginDebugLabel(get_debug_label(p_pass));
 		p_pass->CmdExecute(command_buffer);
+		if (debug_utils)
+			command_buffer->CmdEndDebugLabel();
 	};
 
 	for (const auto &pass_cmd : args.vk_command.GetPassCommands()) {
-		cmd_pipeline_barriers(command_buffer, pass_cmd.prior_barriers);
+		const GlobalKey &pass_cmd_key = pass_cmd.subpasses.front()->GetGlobalKey();
+
+		if (!pass_cmd.prior_barriers.empty())
+			profile(ProfileScope::kBarrier, pass_cmd_key,
+			        [&] { cmd_pipeline_barriers(command_buffer, pass_cmd.prior_barriers); });
 
 		if (pass_cmd.myvk_render_pass) {
 			const auto &attachments = pass_cmd.attachments;
@@ -115,21 +259,32 @@ void VkRunner::Run(const myvk::Ptr<myvk::CommandBuffer> &command_buffer, const A
 			render_begin_info.pClearValues = clear_values.data();
 			render_begin_info.pNext = &attachment_begin_info;
 
-			vkCmdBeginRenderPass(command_buffer->GetHandle(), &render_begin_info, VK_SUBPASS_CONTENTS_INLINE);
+			if (debug_utils)
+				command_buffer->CmdBeginDebugLabel(get_group_debug_label(pass_cmd.subpasses.front()));
+			profile(ProfileScope::kRenderPass, pass_cmd_key, [&] {
+				vkCmdBeginRenderPass(command_buffer->GetHandle(), &render_begin_info, VK_SUBPASS_CONTENTS_INLINE);
 
-			run_pass(pass_cmd.subpasses.front());
-			for (std::size_t i = 1; i < pass_cmd.subpasses.size(); ++i) {
-				vkCmdNextSubpass(command_buffer->GetHandle(), VK_SUBPASS_CONTENTS_INLINE);
-				run_pass(pass_cmd.subpasses[i]);
-			}
+				for (std::size_t i = 0; i < pass_cmd.subpasses.size(); ++i) {
+					const PassBase *p_subpass = pass_cmd.subpasses[i];
+					if (i)
+						vkCmdNextSubpass(command_buffer->GetHandle(), VK_SUBPASS_CONTENTS_INLINE);
+					profile(ProfileScope::kPass, p_subpass->GetGlobalKey(), [&] { run_pass(p_subpass); });
+				}
 
-			vkCmdEndRenderPass(command_buffer->GetHandle());
+				vkCmdEndRenderPass(command_buffer->GetHandle());
+			});
+			if (debug_utils)
+				command_buffer->CmdEndDebugLabel();
 		} else {
 			assert(pass_cmd.subpasses.size() == 1);
-			run_pass(pass_cmd.subpasses.front());
+			profile(ProfileScope::kPass, pass_cmd_key, [&] { run_pass(pass_cmd.subpasses.front()); });
 		}
 	}
-	cmd_pipeline_barriers(command_buffer, args.vk_command.GetPostBarriers());
+	profile(ProfileScope::kBarrier, {},
+	        [&] { cmd_pipeline_barriers(command_buffer, args.vk_command.GetPostBarriers()); });
+
+	if (p_profiler)
+		p_profiler->CmdEndFrame(command_buffer);
 }
 
 } // namespace myvk_rg_executor
@@ -9,12 +9,15 @@
 #include "VkCommand.hpp"
 #include "VkDescriptor.hpp"
 
+#include <myvk_rg/executor/Profiler.hpp>
+
+#include <chrono>
 #include <span>
 
 namespace myvk_rg_executor {
 
 class VkRunner {
-private:
+public:
 	struct Args {
 		const RenderGraphBase &render_graph;
 		const Collection &collection;
@@ -26,15 +29,29 @@ private:
 		const VkDescriptor &vk_descriptor;
 	};
 
+private:
 	static auto &get_runner_cache(const ResourceBase *p_resource) { return GetResourceInfo(p_resource).vk_runner; }
+	static auto &get_runner_cache(const PassBase *p_pass) { return GetPassInfo(p_pass).vk_runner; }
+
+	static const char *get_debug_label(const PassBase *p_pass);
+	static const char *get_group_debug_label(const PassBase *p_first_subpass);
+	static void set_vk_pipeline_name(const PassBase *p_pass);
 
 	static void cmd_pipeline_barriers(const myvk::Ptr<myvk::CommandBuffer> &command_buffer,
 	                                  std::span<const BarrierCmd> barrier_cmds);
 	static void update_ext_cache(const Args &args);
+	static void record_pipeline_creation(const PassBase *p_pass, std::chrono::steady_clock::time_point begin,
+	                                     std::map<GlobalKey, PipelineCreationRecord> *p_pipeline_records);
 
 public:
 	static VkRunner Create(const Args &args);
-	static void Run(const myvk::Ptr<myvk::CommandBuffer> &command_buffer, const Args &args);
+	static void Run(const myvk::Ptr<myvk::CommandBuffer> &command_buffer, const Args &args,
+	                Profiler *p_profiler = nullptr, bool debug_utils = false,
+	                std::map<GlobalKey, PipelineCreationRecord> *p_pipeline_records = nullptr);
+	// Names internal VkImages, VkBuffers, VkDescriptorSets and VkPipelines after their GlobalKeys
+	static void SetVkObjectNames(const myvk::Ptr<myvk::Device> &device, const Args &args);
+	// Name of a backing VkBuffer, the GlobalKeys of the buffers packed in it
+	static std::string GetPackedBufferName(std::span<const ResourceBase *const> buffers);
 	static bool IsExtChanged(const ResourceBase *p_resource) { return get_runner_cache(p_resource).ext_changed; }
 };
 
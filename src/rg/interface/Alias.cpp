@@ -5,12 +5,16 @@
 
 namespace myvk_rg::interface {
 
-RawImageAlias::RawImageAlias(const ImageBase *image) : ImageAliasBase(AliasState::kRaw, image->GetGlobalKey()) {}
+RawImageAlias::RawImageAlias(const ImageBase *image)
+    : ImageAliasBase(AliasState::kRaw, image->GetGlobalKey(), image->GetKeyRef(), {}) {}
 OutputImageAlias::OutputImageAlias(const ImageInput *image_input)
-    : ImageAliasBase(AliasState::kOutput, image_input->GetGlobalKey()) {}
+    : ImageAliasBase(AliasState::kOutput, image_input->GetGlobalKey(), image_input->GetKeyRef(),
+                     image_input->GetParentKeyRef()) {}
 
-RawBufferAlias::RawBufferAlias(const BufferBase *buffer) : BufferAliasBase(AliasState::kRaw, buffer->GetGlobalKey()) {}
+RawBufferAlias::RawBufferAlias(const BufferBase *buffer)
+    : BufferAliasBase(AliasState::kRaw, buffer->GetGlobalKey(), buffer->GetKeyRef(), {}) {}
 OutputBufferAlias::OutputBufferAlias(const BufferInput *buffer_input)
-    : BufferAliasBase(AliasState::kOutput, buffer_input->GetGlobalKey()) {}
+    : BufferAliasBase(AliasState::kOutput, buffer_input->GetGlobalKey(), buffer_input->GetKeyRef(),
+                      buffer_input->GetParentKeyRef()) {}
 
 } // namespace myvk_rg::interface
\ No newline at end of file
@@ -4,6 +4,47 @@
 
 namespace myvk_rg::interface {
 
+ObjectBase::ObjectBase(Parent parent) : m_p_key{parent.p_pool_key} {
+	std::visit(overloaded([this](RenderGraphBase *p_rg) { m_p_render_graph = p_rg; },
+	                      [this](const ObjectBase *p_obj) {
+		                      m_p_render_graph = p_obj->GetRenderGraphPtr();
+		                      m_p_parent_object = p_obj;
+	                      }),
+	           parent.p_var_parent);
+	// The RenderGraph interns itself once its interner is constructed
+	if (m_p_key && m_p_render_graph && static_cast<ObjectBase *>(m_p_render_graph) != this)
+		m_key_ref = m_p_render_graph->m_key_interner.Intern(GetParentKeyRef().id, *m_p_key);
+}
+
+ObjectBase::ObjectBase(const ObjectBase &r)
+    : m_p_render_graph{r.m_p_render_graph}, m_p_parent_object{r.m_p_parent_object}, m_p_key{r.m_p_key},
+      m_key_ref{r.m_key_ref}, m_p_executor_info{r.m_p_executor_info} {
+	if (m_key_ref.id != KeyInterner::kInvalidID)
+		m_p_render_graph->m_key_interner.Retain(m_key_ref.id);
+}
+
+ObjectBase &ObjectBase::operator=(const ObjectBase &r) {
+	if (r.m_key_ref.id != KeyInterner::kInvalidID)
+		r.m_p_render_graph->m_key_interner.Retain(r.m_key_ref.id);
+	if (m_key_ref.id != KeyInterner::kInvalidID)
+		m_p_render_graph->m_key_interner.Release(m_key_ref.id);
+	m_p_render_graph = r.m_p_render_graph;
+	m_p_parent_object = r.m_p_parent_object;
+	m_p_key = r.m_p_key;
+	m_key_ref = r.m_key_ref;
+	m_p_executor_info = r.m_p_executor_info;
+	return *this;
+}
+
+ObjectBase::~ObjectBase() {
+	if (m_key_ref.id != KeyInterner::kInvalidID)
+		m_p_render_graph->m_key_interner.Release(m_key_ref.id);
+}
+
+ObjectArena *ObjectBase::GetObjectArenaPtr() const {
+	return m_p_render_graph ? &m_p_render_graph->m_object_arena : nullptr;
+}
+
 void ObjectBase::EmitEvent(Event event) { GetRenderGraphPtr()->m_executor->OnEvent(this, event); }
 
 } // namespace myvk_rg::interface
\ No newline at end of file
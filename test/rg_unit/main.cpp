@@ -1,12 +1,40 @@
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 #include "doctest.h"
 
+#include <myvk/AsyncUploader.hpp>
+#include <myvk/ComputePipeline.hpp>
+#include <myvk/Defragmenter.hpp>
+#include <myvk/GraphicsPipeline.hpp>
+#include <myvk/MemoryBudget.hpp>
+#include <myvk/ObjectCache.hpp>
+#include <myvk/ShaderReflection.hpp>
 #include <myvk_rg/executor/Executor.hpp>
+#include <myvk_rg/executor/Trace.hpp>
 #include <myvk_rg/interface/Input.hpp>
 #include <myvk_rg/interface/Key.hpp>
 #include <myvk_rg/interface/Pool.hpp>
 #include <myvk_rg/interface/Resource.hpp>
 
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+
+// Reads back a trace flushed to a temporary file, nothing is written to the working directory
+static std::string FlushTrace() {
+	std::FILE *p_file = std::tmpfile();
+	if (!p_file)
+		return {};
+	myvk_rg::executor::TraceRecorder::Flush(p_file);
+	std::string json(std::ftell(p_file), '\0');
+	std::rewind(p_file);
+	json.resize(std::fread(json.data(), 1, json.size(), p_file));
+	std::fclose(p_file);
+	return json;
+}
+
 TEST_SUITE("Interface") {
 	TEST_CASE("Test Key") {
 		using myvk_rg::interface::GlobalKey;
@@ -20,6 +48,27 @@ TEST_SUITE("Interface") {
 		CHECK((key0 != key1));
 		CHECK((GlobalKey{global_key0, key0} != global_key0));
 		CHECK((global_key0 == global_key1));
+
+		using myvk_rg::interface::KeyInterner;
+		KeyInterner interner;
+		auto ref0 = interner.Intern(KeyInterner::kInvalidID, key0);
+		auto ref1 = interner.Intern(ref0.id, key1);
+		CHECK_EQ(ref0.id, 0);
+		CHECK_EQ(ref1.id, 1);
+		CHECK((interner.Intern(ref0.id, key1) == ref1));
+		CHECK((interner.Find(global_key0) == ref1));
+		CHECK_EQ(interner.GetCount(), 2);
+
+		// Released IDs are reused with a new generation
+		interner.Release(ref1.id);
+		CHECK((interner.Find(global_key0) == ref1));
+		interner.Release(ref1.id);
+		CHECK_EQ(interner.Find(global_key0).id, KeyInterner::kInvalidID);
+		auto ref2 = interner.Intern(ref0.id, key0);
+		CHECK_EQ(ref2.id, ref1.id);
+		CHECK_NE(ref2.generation, ref1.generation);
+		CHECK_EQ(interner.GetCount(), 2);
+		CHECK_EQ(interner.GetLiveCount(), 2);
 	}
 
 	TEST_CASE("Test Pool Data") {
@@ -60,6 +109,416 @@ TEST_SUITE("Interface") {
 		CHECK_EQ(*var_wrapper.Get<int>(), 2);
 		*var_wrapper.Get<int>() = 3;
 		CHECK_EQ(*var_wrapper.Get<int>(), 3);
+
+		ObjectArena arena;
+		Wrapper<ObjectBase> arena_wrapper;
+		CHECK(arena_wrapper.ConstructIn<ManagedBuffer>(&arena, Parent{}));
+		CHECK(arena_wrapper.Get<BufferBase>());
+		CHECK_EQ(arena.GetChunkCount(), 1);
+	}
+
+	TEST_CASE("Test Flat Pool Map") {
+		using namespace myvk_rg::interface;
+
+		CHECK_NE(PoolKey::Hash{}({"a", 1}), PoolKey::Hash{}({"a", 2}));
+		CHECK_NE(PoolKey::Hash{}({"ab", 0}), PoolKey::Hash{}({"ba", 0}));
+
+		FlatPoolMap<Wrapper<int>> map;
+		std::vector<const int *> ptrs;
+		bool inserted = true, erased = true;
+		for (uint32_t i = 0; i < 1000; ++i) {
+			auto [p_entry, new_entry] = map.Emplace({"key", i});
+			inserted &= new_entry;
+			ptrs.push_back(p_entry->second.Construct<int>((int)i));
+		}
+		CHECK(inserted);
+		CHECK_FALSE(map.Emplace({"key", 7}).second);
+		for (uint32_t i = 0; i < 1000; i += 2)
+			erased &= map.Erase({"key", i});
+		CHECK(erased);
+		CHECK_FALSE(map.Erase({"key", 0}));
+		CHECK_EQ(map.GetSize(), 500);
+
+		bool stable = true;
+		for (uint32_t i = 1; i < 1000; i += 2) {
+			const auto *p_entry = map.Find({"key", i});
+			stable &= p_entry && p_entry->second.Get<int>() == ptrs[i] && *ptrs[i] == (int)i;
+		}
+		CHECK(stable);
+		CHECK_EQ(map.Find({"key", 0}), nullptr);
+
+		std::size_t count = 0;
+		for (const auto &[key, value] : map)
+			count += key.GetID() % 2;
+		CHECK_EQ(count, 500);
+	}
+}
+
+TEST_SUITE("Object Cache") {
+	TEST_CASE("Test Parallel Creation") {
+		myvk::ObjectCache<int> cache;
+		std::atomic_uint32_t create_count{0};
+		std::atomic_bool go{false};
+		myvk::Ptr<int> results[4];
+		std::vector<std::thread> threads;
+		for (auto &result : results)
+			threads.emplace_back([&] {
+				while (!go)
+					std::this_thread::yield();
+				myvk::CacheKey key;
+				key << 1u;
+				result = cache.GetOrCreate(std::move(key), [&] {
+					++create_count;
+					return std::make_shared<int>(1);
+				});
+			});
+		go = true;
+		for (auto &thread : threads)
+			thread.join();
+		// Creations may overlap, but every caller gets the first inserted object
+		CHECK_GE(create_count, 1u);
+		for (const auto &result : results)
+			CHECK_EQ(result, results[0]);
+		CHECK_EQ(cache.GetSize(), 1);
+
+		myvk::CacheKey key;
+		key << 1u;
+		CHECK_EQ(cache.GetOrCreate(std::move(key), [] { return std::make_shared<int>(2); }), results[0]);
+	}
+	TEST_CASE("Test Compute Pipeline Create Info") {
+		using myvk::ComputePipeline;
+		uint32_t spec_data[2] = {64, 1};
+		VkSpecializationMapEntry spec_entries[] = {{0, 0, sizeof(uint32_t)}, {1, sizeof(uint32_t), sizeof(uint32_t)}};
+		VkSpecializationInfo spec_info = {2, spec_entries, sizeof(spec_data), spec_data};
+		char name[] = "main";
+
+		VkComputePipelineCreateInfo l = {VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO};
+		l.stage = {VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO};
+		l.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+		l.stage.module = (VkShaderModule)0x10;
+		l.stage.pName = "main";
+		l.layout = (VkPipelineLayout)0x20;
+		VkComputePipelineCreateInfo r = l;
+		r.stage.pName = name; // Compared by content
+
+		ComputePipeline::CreateInfoEqual equal;
+		ComputePipeline::CreateInfoHash hash;
+		CHECK(equal(l, r));
+		CHECK_EQ(hash(l), hash(r));
+
+		l.stage.pSpecializationInfo = &spec_info;
+		CHECK_FALSE(equal(l, r));
+		uint32_t other_data[2] = {64, 1};
+		VkSpecializationInfo other_info = spec_info;
+		other_info.pData = other_data;
+		r.stage.pSpecializationInfo = &other_info;
+		CHECK(equal(l, r));
+		other_data[0] = 32;
+		CHECK_FALSE(equal(l, r));
+
+		r = l;
+		r.layout = (VkPipelineLayout)0x30;
+		CHECK_FALSE(equal(l, r));
+		r = l;
+		VkPipelineCreationFeedbackCreateInfo feedback = {VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO};
+		r.pNext = &feedback;
+		CHECK_FALSE(equal(r, r));
+	}
+	TEST_CASE("Test Graphics Pipeline Library Keys") {
+		using myvk::GraphicsPipelineState;
+		const auto fill_state = [](GraphicsPipelineState *p_state, VkPrimitiveTopology topology,
+		                           VkBool32 blend_enable) {
+			p_state->m_rasterization_state.Initialize(VK_POLYGON_MODE_FILL, VK_FRONT_FACE_COUNTER_CLOCKWISE);
+			p_state->m_vertex_input_state.Enable();
+			p_state->m_input_assembly_state.Enable(topology);
+			p_state->m_viewport_state.Enable();
+			p_state->m_multisample_state.Enable(VK_SAMPLE_COUNT_1_BIT);
+			p_state->m_depth_stencil_state.Enable();
+			p_state->m_color_blend_state.Enable(1, blend_enable);
+			p_state->m_dynamic_state.Enable({VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR});
+		};
+		const auto get_key = [](const GraphicsPipelineState &state, VkGraphicsPipelineLibraryFlagsEXT parts) {
+			myvk::CacheKey key;
+			CHECK(state.AppendCacheKey(&key, parts));
+			return key;
+		};
+		constexpr VkGraphicsPipelineLibraryFlagsEXT kParts[] = {
+		    VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT,
+		    VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT,
+		    VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT,
+		    VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT,
+		    GraphicsPipelineState::kAllLibraryParts,
+		};
+
+		GraphicsPipelineState base, strip, blend;
+		fill_state(&base, VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, VK_FALSE);
+		fill_state(&strip, VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP, VK_FALSE);
+		fill_state(&blend, VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, VK_TRUE);
+		// A state change only invalidates the library parts consuming it
+		for (VkGraphicsPipelineLibraryFlagsEXT parts : kParts) {
+			CAPTURE(parts);
+			CHECK_EQ(get_key(base, parts) == get_key(strip, parts),
+			         !(parts & VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT));
+			CHECK_EQ(get_key(base, parts) == get_key(blend, parts),
+			         !(parts & VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT));
+		}
+		// Keys of different parts never collide
+		CHECK_FALSE(get_key(base, kParts[1]) == get_key(base, kParts[2]));
+	}
+}
+
+// Device-less buffer and image with fake handles, for building barriers
+class FakeBuffer final : public myvk::BufferBase {
+public:
+	inline FakeBuffer() {
+		m_buffer = (VkBuffer)0x10;
+		m_size = 1024;
+	}
+	inline const myvk::Ptr<myvk::Device> &GetDevicePtr() const final {
+		static const myvk::Ptr<myvk::Device> kDevice{};
+		return kDevice;
+	}
+};
+class FakeImage final : public myvk::ImageBase {
+public:
+	inline FakeImage() {
+		m_image = (VkImage)0x20;
+		m_format = VK_FORMAT_R8G8B8A8_UNORM;
+		m_mip_levels = 4;
+		m_array_layers = 2;
+	}
+	inline const myvk::Ptr<myvk::Device> &GetDevicePtr() const final {
+		static const myvk::Ptr<myvk::Device> kDevice{};
+		return kDevice;
+	}
+};
+
+TEST_SUITE("Async Uploader") {
+	TEST_CASE("Test Ownership Transfer Barriers") {
+		using myvk::AsyncUploader;
+		constexpr uint32_t kTransferFamily = 1, kGraphicsFamily = 0;
+
+		FakeBuffer buffer;
+		VkBufferCopy buffer_region = {.srcOffset = 0, .dstOffset = 256, .size = 128};
+		myvk::BufferSyncState buffer_state = {VK_PIPELINE_STAGE_2_VERTEX_ATTRIBUTE_INPUT_BIT,
+		                                      VK_ACCESS_2_VERTEX_ATTRIBUTE_READ_BIT};
+		auto buffer_release = AsyncUploader::GetReleaseBarrier(buffer, buffer_region, kTransferFamily, kGraphicsFamily);
+		auto buffer_acquire =
+		    AsyncUploader::GetAcquireBarrier(buffer, buffer_region, buffer_state, kTransferFamily, kGraphicsFamily);
+		// Release covers the copy, acquire the destination state, both name the same transfer of the copied range
+		CHECK_EQ(buffer_release.srcStageMask, VK_PIPELINE_STAGE_2_COPY_BIT);
+		CHECK_EQ(buffer_release.dstAccessMask, VK_ACCESS_2_NONE);
+		CHECK_EQ(buffer_acquire.srcAccessMask, VK_ACCESS_2_NONE);
+		CHECK_EQ(buffer_acquire.dstStageMask, buffer_state.stage_mask);
+		CHECK_EQ(buffer_acquire.dstAccessMask, buffer_state.access_mask);
+		for (const auto &barrier : {buffer_release, buffer_acquire}) {
+			CHECK_EQ(barrier.buffer, buffer.GetHandle());
+			CHECK_EQ(barrier.srcQueueFamilyIndex, kTransferFamily);
+			CHECK_EQ(barrier.dstQueueFamilyIndex, kGraphicsFamily);
+			CHECK_EQ(barrier.offset, 256);
+			CHECK_EQ(barrier.size, 128);
+		}
+
+		FakeImage image;
+		VkBufferImageCopy image_region = {.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 2, 1, 1},
+		                                  .imageExtent = {16, 16, 1}};
+		myvk::ImageSyncState image_state = {VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
+		                                    VK_ACCESS_2_SHADER_SAMPLED_READ_BIT,
+		                                    VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+		auto image_release =
+		    AsyncUploader::GetReleaseBarrier(image, image_region, image_state, kTransferFamily, kGraphicsFamily);
+		auto image_acquire =
+		    AsyncUploader::GetAcquireBarrier(image, image_region, image_state, kTransferFamily, kGraphicsFamily);
+		CHECK_EQ(image_release.srcAccessMask, VK_ACCESS_2_TRANSFER_WRITE_BIT);
+		CHECK_EQ(image_acquire.dstAccessMask, image_state.access_mask);
+		// The layout transition must be identical on both queues
+		for (const auto &barrier : {image_release, image_acquire}) {
+			CHECK_EQ(barrier.image, image.GetHandle());
+			CHECK_EQ(barrier.srcQueueFamilyIndex, kTransferFamily);
+			CHECK_EQ(barrier.dstQueueFamilyIndex, kGraphicsFamily);
+			CHECK_EQ(barrier.oldLayout, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+			CHECK_EQ(barrier.newLayout, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+			CHECK_EQ(barrier.subresourceRange.baseMipLevel, 2);
+			CHECK_EQ(barrier.subresourceRange.levelCount, 1);
+			CHECK_EQ(barrier.subresourceRange.baseArrayLayer, 1);
+			CHECK_EQ(barrier.subresourceRange.layerCount, 1);
+		}
+	}
+	TEST_CASE("Test Batch Retirement") {
+		using myvk::AsyncUploader;
+		// Pending batches are never dropped
+		CHECK_FALSE(AsyncUploader::IsBatchRetired(false, false, false));
+		CHECK_FALSE(AsyncUploader::IsBatchRetired(false, true, true));
+		// Without an ownership transfer, a completed batch is dropped even if never acquired
+		CHECK(AsyncUploader::IsBatchRetired(true, false, false));
+		CHECK(AsyncUploader::IsBatchRetired(true, true, false));
+		// With one, it waits for CmdAcquire()
+		CHECK_FALSE(AsyncUploader::IsBatchRetired(true, false, true));
+		CHECK(AsyncUploader::IsBatchRetired(true, true, true));
+	}
+}
+
+TEST_SUITE("Defragmenter") {
+	TEST_CASE("Test Pass State Machine") {
+		using State = myvk::Defragmenter::PassState;
+		using Action = myvk::Defragmenter::PassAction;
+		const auto step = myvk::Defragmenter::GetPassAction;
+		// A new pass only begins when idle, whatever the timeline is at
+		CHECK_EQ(step(State::kIdle, false, false), Action::kBegin);
+		CHECK_EQ(step(State::kIdle, true, true), Action::kBegin);
+		// Copies in flight are waited for, then applied (or cancelled if abandoned, keeping the old resources)
+		CHECK_EQ(step(State::kCopying, false, false), Action::kWait);
+		CHECK_EQ(step(State::kCopying, false, true), Action::kWait);
+		CHECK_EQ(step(State::kCopying, true, false), Action::kApply);
+		CHECK_EQ(step(State::kCopying, true, true), Action::kCancel);
+		// Applied passes free the old resources once the queue is past them, even if abandoned
+		CHECK_EQ(step(State::kRetiring, false, false), Action::kWait);
+		CHECK_EQ(step(State::kRetiring, true, false), Action::kEnd);
+		CHECK_EQ(step(State::kRetiring, true, true), Action::kEnd);
+	}
+}
+
+TEST_SUITE("Memory Budget") {
+	TEST_CASE("Test Pressure Transitions") {
+		using Pressure = myvk::MemoryBudget::Pressure;
+		const myvk::MemoryBudget::Thresholds thresholds = {.high = 0.8f, .critical = 0.95f, .release = 0.05f};
+		const auto get_pressure = [&](VkDeviceSize usage, Pressure prev_pressure) {
+			return myvk::MemoryBudget::GetPressure(usage, 1000, thresholds, prev_pressure);
+		};
+		CHECK_EQ(get_pressure(500, Pressure::kNormal), Pressure::kNormal);
+		// Pressure rises as soon as a threshold is reached
+		CHECK_EQ(get_pressure(810, Pressure::kNormal), Pressure::kHigh);
+		CHECK_EQ(get_pressure(950, Pressure::kNormal), Pressure::kCritical);
+		CHECK_EQ(get_pressure(1001, Pressure::kHigh), Pressure::kOverBudget);
+		// A usage hovering around a threshold keeps the pressure, which only drops past the release margin
+		CHECK_EQ(get_pressure(790, Pressure::kHigh), Pressure::kHigh);
+		CHECK_EQ(get_pressure(740, Pressure::kHigh), Pressure::kNormal);
+		CHECK_EQ(get_pressure(990, Pressure::kOverBudget), Pressure::kOverBudget);
+		CHECK_EQ(get_pressure(940, Pressure::kOverBudget), Pressure::kCritical);
+		CHECK_EQ(get_pressure(500, Pressure::kCritical), Pressure::kNormal);
+		// The margin never holds a pressure the usage did not reach
+		CHECK_EQ(get_pressure(790, Pressure::kNormal), Pressure::kNormal);
+
+		// Usage oscillating across the high threshold changes the pressure once
+		Pressure pressure = Pressure::kNormal;
+		uint32_t change_count = 0;
+		for (uint32_t frame = 0; frame < 16; ++frame) {
+			Pressure next_pressure = get_pressure(frame % 2 ? 810 : 790, pressure);
+			change_count += next_pressure != pressure;
+			pressure = next_pressure;
+		}
+		CHECK_EQ(change_count, 1);
+	}
+}
+
+// Compute shader with two sampler bindings, only (0, 1) is listed in the entry point interface
+static std::vector<uint32_t> MakeSamplerShader(uint32_t version) {
+	enum : uint32_t { kMain = 1, kSampler, kPointer, kUsed, kUnused, kBound };
+	const auto inst = [](uint32_t opcode, uint32_t word_count) { return word_count << 16u | opcode; };
+	return {
+	    0x07230203, version, 0, kBound, 0,                               // Header
+	    inst(15, 6), 5, kMain, 0x6e69616d /* "main" */, 0, kUsed,        // OpEntryPoint GLCompute
+	    inst(16, 6), kMain, 17, 8, 8, 1,                                 // OpExecutionMode LocalSize
+	    inst(71, 4), kUsed, 34, 0, inst(71, 4), kUsed, 33, 1,            // OpDecorate DescriptorSet, Binding
+	    inst(71, 4), kUnused, 34, 0, inst(71, 4), kUnused, 33, 2,        // OpDecorate DescriptorSet, Binding
+	    inst(26, 2), kSampler,                                           // OpTypeSampler
+	    inst(32, 4), kPointer, 0, kSampler,                              // OpTypePointer UniformConstant
+	    inst(59, 4), kPointer, kUsed, 0, inst(59, 4), kPointer, kUnused, 0, // OpVariable UniformConstant
+	};
+}
+static std::optional<myvk::ShaderReflection> Reflect(const std::vector<uint32_t> &code) {
+	return myvk::ShaderReflection::Reflect(code.data(), code.size() * sizeof(uint32_t));
+}
+
+TEST_SUITE("Shader Reflection") {
+	TEST_CASE("Test Interface Versions") {
+		auto reflection = Reflect(MakeSamplerShader(0x10300));
+		REQUIRE(reflection);
+		CHECK_EQ(reflection->GetStage(), VK_SHADER_STAGE_COMPUTE_BIT);
+		CHECK_EQ(reflection->GetEntryPoint(), "main");
+		CHECK_EQ(reflection->GetWorkgroupSize(), std::array<uint32_t, 3>{8, 8, 1});
+		CHECK_EQ(reflection->GetBindings().size(), 2);
+
+		// Since SPIR-V 1.4, globals missing from the interface are not used by the entry point
+		reflection = Reflect(MakeSamplerShader(0x10600));
+		REQUIRE(reflection);
+		REQUIRE_EQ(reflection->GetBindings().size(), 1);
+		CHECK_EQ(reflection->GetBindings()[0].binding, 1);
+		CHECK_EQ(reflection->GetBindings()[0].descriptor_type, VK_DESCRIPTOR_TYPE_SAMPLER);
+		CHECK_EQ(reflection->GetBindings()[0].descriptor_count, 1);
+	}
+	TEST_CASE("Test Malformed Modules") {
+		auto code = MakeSamplerShader(0x10300);
+		CHECK(Reflect(code));
+
+		// Variable ids out of the bound are skipped
+		auto out_of_bound = code;
+		out_of_bound[out_of_bound.size() - 2] = 1000;
+		auto reflection = Reflect(out_of_bound);
+		REQUIRE(reflection);
+		CHECK_EQ(reflection->GetBindings().size(), 1);
+
+		// Truncated OpVariable without a storage class is skipped
+		auto truncated = code;
+		truncated.resize(truncated.size() - 8);
+		truncated.insert(truncated.end(), {3u << 16u | 59u, 3, 4});
+		reflection = Reflect(truncated);
+		REQUIRE(reflection);
+		CHECK_EQ(reflection->GetBindings().size(), 0);
+
+		// Instructions running past the end, bad magic and empty code fail
+		auto overrun = code;
+		overrun[overrun.size() - 4] = 8u << 16u | 59u;
+		CHECK_FALSE(Reflect(overrun));
+		auto bad_magic = code;
+		bad_magic[0] = 0;
+		CHECK_FALSE(Reflect(bad_magic));
+		CHECK_FALSE(Reflect({}));
+	}
+}
+
+TEST_SUITE("Trace") {
+	TEST_CASE("Test Trace Recorder") {
+		using myvk_rg::executor::TraceRecorder;
+		using myvk_rg::executor::TraceSpan;
+
+		{ TraceSpan span{"test", "disabled"}; }
+		TraceRecorder::Enable();
+		{ TraceSpan span{"test", myvk_rg::interface::GlobalKey{{"pass", 1}}}; }
+		TraceRecorder::AddSpan("test", "gpu\"span", 10, 20, TraceRecorder::Track::kGPU);
+		TraceRecorder::Disable();
+
+		std::string json = FlushTrace();
+		CHECK_EQ(json.find("disabled"), std::string::npos);
+		CHECK_NE(json.find(R"("name":"pass:1")"), std::string::npos);
+		CHECK_NE(json.find(R"("name":"gpu\"span","cat":"test","ph":"X","ts":10,"dur":10,"pid":1)"), std::string::npos);
+
+		// Flushed spans are released
+		CHECK_EQ(FlushTrace().find("pass:1"), std::string::npos);
+	}
+	TEST_CASE("Test Trace Thread Retirement") {
+		using myvk_rg::executor::TraceRecorder;
+		using myvk_rg::executor::TraceSpan;
+
+		FlushTrace();
+		std::size_t thread_buffer_count = TraceRecorder::GetThreadBufferCount();
+
+		TraceRecorder::Enable();
+		for (uint32_t i = 0; i < 4; ++i)
+			std::thread{[i] {
+				// Spans past the first chunk
+				for (uint32_t j = 0; j < 1500; ++j)
+					TraceSpan span{"test", myvk_rg::interface::GlobalKey{{"worker", i}}};
+			}}.join();
+		TraceRecorder::Disable();
+		CHECK_EQ(TraceRecorder::GetThreadBufferCount(), thread_buffer_count + 4);
+
+		// Buffers of exited threads are drained, then freed
+		std::string json = FlushTrace();
+		for (uint32_t i = 0; i < 4; ++i)
+			CHECK_NE(json.find("\"worker:" + std::to_string(i) + "\""), std::string::npos);
+		CHECK_EQ(TraceRecorder::GetThreadBufferCount(), thread_buffer_count);
+		CHECK_EQ(FlushTrace().find("worker"), std::string::npos);
 	}
 }
 
@@ -262,17 +721,189 @@ public:
 	inline ~MyRenderGraph2() final = default;
 };
 
+// Buffer "b" written by pass "w", "b" and temporary buffers are removed and re-added
+class ChurnRenderGraph final : public myvk_rg::RenderGraphBase {
+public:
+	inline ChurnRenderGraph() : myvk_rg::RenderGraphBase(nullptr) {
+		CreateBuffer();
+		auto w_pass = CreatePass<BufferWPass>({"w"}, GetBuffer()->Alias());
+		AddResult({"final"}, w_pass->GetBufferOutput());
+	}
+	inline ~ChurnRenderGraph() final = default;
+	inline void CreateBuffer() { CreateResource<myvk_rg::ManagedBuffer>({"b"})->SetSize(64); }
+	inline void DeleteBuffer() { DeleteResource({"b"}); }
+	inline myvk_rg::ManagedBuffer *GetBuffer() const { return GetBufferResource<myvk_rg::ManagedBuffer>({"b"}); }
+	inline void Churn(uint32_t count) {
+		for (uint32_t i = 0; i < count; ++i)
+			CreateResource<myvk_rg::ManagedBuffer>({"tmp", i});
+		for (uint32_t i = 0; i < count; ++i)
+			DeleteResource({"tmp", i});
+	}
+};
+
+// Two small buffers written by their own passes
+class PairRenderGraph final : public myvk_rg::RenderGraphBase {
+public:
+	inline PairRenderGraph() : myvk_rg::RenderGraphBase(nullptr) {
+		for (uint32_t i = 0; i < 2; ++i) {
+			auto buffer = CreateResource<myvk_rg::ManagedBuffer>({"p", i});
+			buffer->SetSize(64);
+			AddResult({"final", i}, CreatePass<BufferWPass>({"w", i}, buffer->Alias())->GetBufferOutput());
+		}
+	}
+	inline ~PairRenderGraph() final = default;
+};
+
+// Reads buffer "in" and writes buffer "out"
+class BufferRWPass final : public myvk_rg::ComputePassBase {
+public:
+	inline BufferRWPass(myvk_rg::Parent parent, const myvk_rg::Buffer &in, const myvk_rg::Buffer &out)
+	    : myvk_rg::ComputePassBase(parent) {
+		AddDescriptorInput<myvk_rg::Usage::kStorageBufferR, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT>({0}, {"in"}, in);
+		AddDescriptorInput<myvk_rg::Usage::kStorageBufferW, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT>({1}, {"out"}, out);
+	}
+	inline ~BufferRWPass() final = default;
+	inline myvk::Ptr<myvk::ComputePipeline> CreatePipeline() const final { return nullptr; }
+	inline void CmdExecute(const myvk::Ptr<myvk::CommandBuffer> &command_buffer) const final {}
+	inline auto GetBufferOutput() { return MakeBufferOutput({"out"}); }
+};
+
+// Mapped "upload" is only read before mapped "readback" is written, mapped "persistent" is read and written
+class MappedRenderGraph final : public myvk_rg::RenderGraphBase {
+public:
+	inline MappedRenderGraph() : myvk_rg::RenderGraphBase(nullptr) {
+		const auto create_buffer = [this](const char *name, bool mapped) {
+			auto buffer = CreateResource<myvk_rg::ManagedBuffer>({name});
+			buffer->SetSize(64);
+			buffer->SetMapped(mapped);
+			return buffer;
+		};
+		auto upload = create_buffer("upload", true), temp = create_buffer("temp", false),
+		     readback = create_buffer("readback", true), persistent = create_buffer("persistent", true);
+		auto upload_pass = CreatePass<BufferRWPass>({"upload"}, upload->Alias(), temp->Alias());
+		auto readback_pass = CreatePass<BufferRWPass>({"readback"}, upload_pass->GetBufferOutput(), readback->Alias());
+		auto persistent_pass = CreatePass<BufferWPass>({"persistent"}, persistent->Alias());
+		AddResult({"readback"}, readback_pass->GetBufferOutput());
+		AddResult({"persistent"}, persistent_pass->GetBufferOutput());
+	}
+	inline ~MappedRenderGraph() final = default;
+	inline const myvk_rg::ManagedBuffer *GetBuffer(const char *name) const {
+		return GetBufferResource<myvk_rg::ManagedBuffer>({name});
+	}
+};
+
+// Each pass reads the buffer of the previous one and writes its own
+class RelayRenderGraph final : public myvk_rg::RenderGraphBase {
+public:
+	inline explicit RelayRenderGraph(uint32_t pass_count) : myvk_rg::RenderGraphBase(nullptr) {
+		const auto create_buffer = [this](uint32_t i) {
+			auto buffer = CreateResource<myvk_rg::ManagedBuffer>({"r", i});
+			buffer->SetSize(1024);
+			return buffer;
+		};
+		auto output = CreatePass<BufferWPass>({"w", 0}, create_buffer(0)->Alias())->GetBufferOutput();
+		for (uint32_t i = 1; i < pass_count; ++i)
+			output = CreatePass<BufferRWPass>({"w", i}, output, create_buffer(i)->Alias())->GetBufferOutput();
+		AddResult({"final"}, output);
+	}
+	inline ~RelayRenderGraph() final = default;
+};
+
+// A chain of passes writing one buffer, to time building and tearing down large graphs
+class ChainRenderGraph final : public myvk_rg::RenderGraphBase {
+public:
+	inline explicit ChainRenderGraph(uint32_t pass_count) : myvk_rg::RenderGraphBase(nullptr) {
+		auto buffer = CreateResource<myvk_rg::ManagedBuffer>({"b"});
+		buffer->SetSize(64);
+		auto output = CreatePass<BufferWPass>({"w", 0}, buffer->Alias())->GetBufferOutput();
+		for (uint32_t i = 1; i < pass_count; ++i)
+			output = CreatePass<BufferWPass>({"w", i}, output)->GetBufferOutput();
+		AddResult({"final"}, output);
+	}
+	inline ~ChainRenderGraph() final = default;
+};
+
 #include "../../src/rg/executor/default/Collection.hpp"
+#include "../../src/rg/executor/default/CompilePlan.hpp"
 #include "../../src/rg/executor/default/Dependency.hpp"
 #include "../../src/rg/executor/default/Metadata.hpp"
+#include "../../src/rg/executor/default/ResourcePool.hpp"
 #include "../../src/rg/executor/default/Schedule.hpp"
+#include "../../src/rg/executor/default/VkAllocation.hpp"
+#include "../../src/rg/executor/default/VkCommand.hpp"
+#include "../../src/rg/executor/default/VkRunner.hpp"
+#include "../../src/rg/executor/default/Interval.hpp"
+
+#include <set>
+
+// Parts of a compile plan, serialized in the format of CompilePlan::Serialize() for crafting plans
+struct CompilePlanParts {
+	using CompilePlan = myvk_rg_executor::CompilePlan;
+
+	std::vector<uint8_t> header; // Magic and version
+	uint64_t structural_hash;
+	std::vector<uint32_t> pass_group_sizes;
+	std::vector<CompilePlan::SubpassBarrier> subpass_barriers;
+	std::vector<CompilePlan::PassBarrier> pass_barriers;
+	std::vector<std::vector<CompilePlan::InputRef>> first_inputs, last_inputs;
+	std::vector<std::optional<CompilePlan::MemPlacement>> mem_placements;
+
+	inline explicit CompilePlanParts(const CompilePlan &plan)
+	    : header{plan.Serialize()}, structural_hash{plan.GetStructuralHash()},
+	      pass_group_sizes{plan.GetPassGroupSizes()}, subpass_barriers{plan.GetSubpassBarriers()},
+	      pass_barriers{plan.GetPassBarriers()}, first_inputs{plan.GetFirstInputs()},
+	      last_inputs{plan.GetLastInputs()}, mem_placements{plan.GetMemPlacements()} {
+		header.resize(12);
+	}
+
+	inline std::vector<uint8_t> Serialize() const {
+		std::vector<uint8_t> data = header;
+		const auto write = [&](auto value) {
+			const auto *p_bytes = reinterpret_cast<const uint8_t *>(&value);
+			data.insert(data.end(), p_bytes, p_bytes + sizeof(value));
+		};
+		const auto write_refs = [&](const std::vector<CompilePlan::InputRef> &refs) {
+			write((uint32_t)refs.size());
+			for (auto ref : refs)
+				write(ref.pass_topo_id), write(ref.input_id);
+		};
+		write(structural_hash);
+		write((uint32_t)pass_group_sizes.size());
+		for (uint32_t size : pass_group_sizes)
+			write(size);
+		write((uint32_t)subpass_barriers.size());
+		for (const auto &b : subpass_barriers)
+			write(b.group_id), write(b.attachment_id), write(b.src.pass_topo_id), write(b.src.input_id),
+			    write(b.dst.pass_topo_id), write(b.dst.input_id);
+		write((uint32_t)pass_barriers.size());
+		for (const auto &b : pass_barriers)
+			write(b.resource_id), write_refs(b.src_s), write_refs(b.dst_s), write(b.type);
+		for (const auto *p_inputs : {&first_inputs, &last_inputs}) {
+			write((uint32_t)p_inputs->size());
+			for (const auto &refs : *p_inputs)
+				write_refs(refs);
+		}
+		write((uint32_t)mem_placements.size());
+		for (const auto &opt_placement : mem_placements) {
+			write(opt_placement.has_value());
+			if (opt_placement)
+				write(opt_placement->offset), write(opt_placement->size), write(opt_placement->alignment),
+				    write(opt_placement->bucket);
+		}
+		return data;
+	}
+};
+
 TEST_SUITE("Default Executor") {
 	auto render_graph = myvk::MakePtr<MyRenderGraph2>();
 
 	using myvk_rg_executor::Collection;
+	using myvk_rg_executor::CompilePlan;
 	using myvk_rg_executor::Dependency;
 	using myvk_rg_executor::Metadata;
 	using myvk_rg_executor::Schedule;
+	using myvk_rg_executor::VkAllocation;
+	using myvk_rg_executor::VkCommand;
 
 	using myvk_rg::interface::PassBase;
 	using myvk_rg::interface::ResourceBase;
@@ -295,6 +926,41 @@ TEST_SUITE("Default Executor") {
 		    printf("%s\n", it.first.Format().c_str()); */
 	}
 
+	TEST_CASE("Test Collection Churn") {
+		ChurnRenderGraph graph;
+		auto alias = graph.GetBuffer()->Alias();
+
+		// Released key IDs are reused
+		uint32_t key_count = graph.GetKeyInterner().GetCount();
+		for (uint32_t i = 0; i < 16; ++i)
+			graph.Churn(8);
+		CHECK_EQ(graph.GetKeyInterner().GetCount(), key_count + 8);
+		CHECK_EQ(Collection::Create(graph).FindSourceResource(alias), graph.GetBuffer());
+
+		graph.DeleteBuffer();
+		graph.Churn(8);
+		CHECK_THROWS(Collection::Create(graph).FindSourceResource(alias));
+
+		// Aliases made before the removal resolve to the re-added object, whatever ID it gets
+		graph.CreateBuffer();
+		CHECK_FALSE((graph.GetBuffer()->GetKeyRef() == alias.GetSourceRef()));
+		auto churn_collection = Collection::Create(graph);
+		CHECK_EQ(churn_collection.FindSourceResource(alias), graph.GetBuffer());
+		CHECK_NOTHROW(Dependency::Create({.render_graph = graph, .collection = churn_collection}));
+	}
+
+	TEST_CASE("Test Large Graph") {
+		constexpr uint32_t kPassCount = 10000;
+		auto begin = std::chrono::steady_clock::now();
+		{
+			ChainRenderGraph graph{kPassCount};
+			CHECK_EQ(graph.GetPassPoolData().GetSize(), kPassCount);
+			CHECK_NOTHROW(Collection::Create(graph));
+		}
+		auto duration = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin);
+		MESSAGE("Built, collected and destroyed " << kPassCount << " passes in " << duration.count() << " ms");
+	}
+
 	Dependency dependency;
 	TEST_CASE("Test Dependency") {
 		dependency = Dependency::Create({.render_graph = *render_graph, .collection = collection});
@@ -366,6 +1032,9 @@ TEST_SUITE("Default Executor") {
 			    [](const myvk_rg::interface::BufferBase *p_buffer) {
 				    const auto &view = Metadata::GetViewInfo(p_buffer);
 				    printf("offset=%lu, size=%lu", view.offset, view.size);
+				    // Read-written by storage passes: uploaded before and read back after the execution
+				    const auto &alloc = Metadata::GetAllocInfo(p_buffer);
+				    CHECK((alloc.host_written && alloc.host_read));
 			    }));
 			printf("\n");
 		}
@@ -387,6 +1056,22 @@ TEST_SUITE("Default Executor") {
 		}
 	}
 
+	TEST_CASE("Test Structural Hash") {
+		const auto create_metadata = [&] {
+			return Metadata::Create(
+			    {.render_graph = *render_graph, .collection = collection, .dependency = dependency});
+		};
+		uint64_t hash = metadata.GetStructuralHash();
+		CHECK_EQ(create_metadata().GetStructuralHash(), hash);
+
+		render_graph->SetCanvasSize({1920, 1080});
+		CHECK_NE(create_metadata().GetStructuralHash(), hash);
+
+		render_graph->SetCanvasSize({1280, 720});
+		metadata = create_metadata();
+		CHECK_EQ(metadata.GetStructuralHash(), hash);
+	}
+
 	Schedule schedule;
 	TEST_CASE("Test Schedule") {
 		schedule = Schedule::Create({
@@ -437,4 +1122,345 @@ TEST_SUITE("Default Executor") {
 			printf("\n");
 		}
 	}
-}
\ No newline at end of file
+
+	TEST_CASE("Test Compile Plan") {
+		auto plan = CompilePlan::Create({.dependency = dependency, .metadata = metadata, .schedule = schedule});
+		CHECK(plan.IsCompatible(dependency, metadata));
+		CHECK_EQ(plan.GetPassBarriers().size(), schedule.GetPassBarriers().size());
+
+		auto data = plan.Serialize();
+		auto opt_loaded_plan = CompilePlan::Deserialize(data);
+		REQUIRE(opt_loaded_plan);
+		CHECK(*opt_loaded_plan == plan);
+
+		auto truncated_data = data;
+		truncated_data.pop_back();
+		CHECK_FALSE(CompilePlan::Deserialize(truncated_data));
+
+		// Restoring from the loaded plan reproduces the same schedule
+		Schedule restored = Schedule::Restore(
+		    {.render_graph = *render_graph, .collection = collection, .dependency = dependency, .metadata = metadata},
+		    *opt_loaded_plan);
+		REQUIRE_EQ(restored.GetPassGroups().size(), schedule.GetPassGroups().size());
+		for (std::size_t i = 0; i < restored.GetPassGroups().size(); ++i)
+			CHECK(restored.GetPassGroups()[i].subpasses == schedule.GetPassGroups()[i].subpasses);
+		CHECK(CompilePlan::Create({.dependency = dependency, .metadata = metadata, .schedule = restored}) == plan);
+
+		// Crafted subpass barriers: on a buffer, or between passes outside of the group
+		REQUIRE_FALSE(plan.GetSubpassBarriers().empty());
+		const auto &resources = dependency.GetResources();
+		auto buffer_it = std::ranges::find_if(resources, [](const myvk_rg::interface::ResourceBase *p_resource) {
+			return p_resource->GetType() == myvk_rg::interface::ResourceType::kBuffer;
+		});
+		REQUIRE(buffer_it != resources.end());
+		std::size_t barrier_offset = 8 + 4 + 8 + 4 + 4 * plan.GetPassGroupSizes().size() + 4;
+		// Words of the first barrier: group_id, attachment_id, src, dst
+		const auto craft = [&](std::initializer_list<std::pair<std::size_t, uint32_t>> words) {
+			auto crafted_data = data;
+			for (auto [word, value] : words)
+				std::memcpy(crafted_data.data() + barrier_offset + word * sizeof(uint32_t), &value, sizeof(uint32_t));
+			auto crafted_plan = CompilePlan::Deserialize(crafted_data);
+			return crafted_plan && crafted_plan->IsCompatible(dependency, metadata);
+		};
+		CHECK(craft({{1, plan.GetSubpassBarriers()[0].attachment_id}}));
+		CHECK_FALSE(craft({{1, uint32_t(buffer_it - resources.begin())}}));
+		uint32_t group_id = plan.GetSubpassBarriers()[0].group_id, group_begin = 0;
+		for (uint32_t i = 0; i < group_id; ++i)
+			group_begin += plan.GetPassGroupSizes()[i];
+		uint32_t outside_topo_id = group_begin ? 0 : group_begin + plan.GetPassGroupSizes()[group_id];
+		REQUIRE_LT(outside_topo_id, dependency.GetPassCount());
+		CHECK_FALSE(craft({{4, outside_topo_id}, {5, 0u}}));
+
+		// Crafted groups and input lists, which Schedule::Restore() and the later stages rely on
+		const CompilePlanParts parts{plan};
+		REQUIRE(parts.Serialize() == data);
+		const auto is_compatible = [&](const CompilePlanParts &crafted_parts) {
+			auto crafted_plan = CompilePlan::Deserialize(crafted_parts.Serialize());
+			return crafted_plan && crafted_plan->IsCompatible(dependency, metadata);
+		};
+		auto empty_group = parts;
+		empty_group.pass_group_sizes.push_back(0);
+		CHECK_FALSE(is_compatible(empty_group));
+		// Two adjacent compute passes merged into one group
+		const auto is_compute_group = [&](std::size_t group_id, uint32_t group_begin) {
+			return parts.pass_group_sizes[group_id] == 1 &&
+			       dependency.GetTopoIDPass(group_begin)->GetType() != myvk_rg::interface::PassType::kGraphics;
+		};
+		bool merged = false;
+		for (uint32_t group_id = 0, begin = 0; group_id + 1 < parts.pass_group_sizes.size() && !merged;
+		     begin += parts.pass_group_sizes[group_id++]) {
+			if (!is_compute_group(group_id, begin) || !is_compute_group(group_id + 1, begin + 1))
+				continue;
+			auto compute_group = parts;
+			compute_group.pass_group_sizes[group_id] = 2;
+			compute_group.pass_group_sizes.erase(compute_group.pass_group_sizes.begin() + group_id + 1);
+			for (auto &b : compute_group.subpass_barriers)
+				b.group_id -= b.group_id > group_id;
+			CHECK_FALSE(is_compatible(compute_group));
+			merged = true;
+		}
+		CHECK(merged);
+		// Empty or foreign first / last inputs
+		std::size_t accessed_id = std::ranges::find_if(parts.first_inputs, [](const auto &refs) {
+			                          return !refs.empty();
+		                          }) - parts.first_inputs.begin();
+		REQUIRE_LT(accessed_id, resources.size());
+		auto empty_first = parts;
+		empty_first.first_inputs[accessed_id].clear();
+		CHECK_FALSE(is_compatible(empty_first));
+		auto empty_last = parts;
+		empty_last.last_inputs[accessed_id].clear();
+		CHECK_FALSE(is_compatible(empty_last));
+		const auto find_foreign = [&](std::size_t resource_id) {
+			const auto *p_root = Dependency::GetRootResource(resources[resource_id]);
+			return std::ranges::find_if(resources, [&](const myvk_rg::interface::ResourceBase *p_resource) {
+				       return Dependency::GetRootResource(p_resource) != p_root;
+			       }) -
+			       resources.begin();
+		};
+		std::size_t foreign_id = find_foreign(accessed_id);
+		REQUIRE_LT(foreign_id, resources.size());
+		auto foreign_first = parts;
+		foreign_first.first_inputs[accessed_id] = parts.last_inputs[foreign_id];
+		CHECK_FALSE(is_compatible(foreign_first));
+		auto foreign_last = parts;
+		foreign_last.last_inputs[accessed_id] = parts.last_inputs[foreign_id];
+		CHECK_FALSE(is_compatible(foreign_last));
+		// A pass barrier waiting on inputs of another resource
+		auto foreign_barrier = parts;
+		auto &barrier = foreign_barrier.pass_barriers[0];
+		barrier.dst_s = parts.last_inputs[find_foreign(barrier.resource_id)];
+		CHECK_FALSE(is_compatible(foreign_barrier));
+
+		// Never compiled through the executor
+		CHECK(render_graph->GetExecutor()->SerializePlan().empty());
+	}
+
+	// Collection, dependency and metadata of a render graph other than the suite's, for planning it
+	struct PlanningInput {
+		const myvk_rg::interface::RenderGraphBase &render_graph;
+		Collection collection;
+		Dependency dependency;
+		Metadata metadata;
+
+		inline explicit PlanningInput(const myvk_rg::interface::RenderGraphBase &graph)
+		    : render_graph{graph}, collection{Collection::Create(graph)},
+		      dependency{Dependency::Create({.render_graph = graph, .collection = collection})},
+		      metadata{Metadata::Create({.render_graph = graph, .collection = collection, .dependency = dependency})} {}
+		inline VkAllocation::Args GetArgs(myvk_rg_executor::ResourcePool &resource_pool) const {
+			return {.render_graph = render_graph,
+			        .collection = collection,
+			        .dependency = dependency,
+			        .metadata = metadata,
+			        .resource_pool = resource_pool};
+		}
+	};
+
+	TEST_CASE("Test Planning") {
+		// Mock device: images only in device-local memory, buffers in both memory types
+		myvk_rg_executor::DeviceModel model = {
+		    .buffer_image_granularity = 1024,
+		    .min_uniform_buffer_offset_alignment = 64,
+		    .min_storage_buffer_offset_alignment = 64,
+		    .min_texel_buffer_offset_alignment = 64,
+		    .memory_types = {VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+		                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT},
+		    .get_image_requirements =
+		        [](const VkImageCreateInfo &info) {
+			        VkDeviceSize size = VkDeviceSize{info.extent.width} * info.extent.height * info.extent.depth *
+			                            info.arrayLayers * info.mipLevels * 16;
+			        return VkMemoryRequirements{.size = size, .alignment = 4096, .memoryTypeBits = 0b01};
+		        },
+		    .get_buffer_requirements =
+		        [](const VkBufferCreateInfo &info) {
+			        return VkMemoryRequirements{.size = info.size, .alignment = 256, .memoryTypeBits = 0b11};
+		        },
+		};
+		auto resource_pool = myvk_rg_executor::ResourcePool::Create();
+		VkAllocation allocation = VkAllocation::Plan(model, {.render_graph = *render_graph,
+		                                                     .collection = collection,
+		                                                     .dependency = dependency,
+		                                                     .metadata = metadata,
+		                                                     .resource_pool = *resource_pool});
+
+		// Resources of a bucket alias exactly if their memory overlaps, which only non-conflicted ones may
+		bool valid = true;
+		for (const ResourceBase *p_l : metadata.GetIntRootResources())
+			for (const ResourceBase *p_r : metadata.GetIntRootResources()) {
+				if (p_l == p_r)
+					continue;
+				VkDeviceSize l_offset = VkAllocation::GetMemOffset(p_l), r_offset = VkAllocation::GetMemOffset(p_r);
+				bool overlapped = VkAllocation::GetMemBucket(p_l) == VkAllocation::GetMemBucket(p_r) &&
+				                  l_offset < r_offset + VkAllocation::GetMemRequirements(p_r).size &&
+				                  r_offset < l_offset + VkAllocation::GetMemRequirements(p_l).size;
+				valid &= overlapped == allocation.IsAliased(p_l, p_r);
+				valid &= !overlapped || !dependency.IsResourceConflicted(p_l, p_r);
+			}
+		CHECK(valid);
+		// Buffers and images are bucketed apart with a bufferImageGranularity above 1
+		std::set<uint32_t> image_buckets, buffer_buckets;
+		for (const ResourceBase *p_resource : metadata.GetIntRootResources())
+			(p_resource->GetType() == myvk_rg::interface::ResourceType::kImage ? image_buckets : buffer_buckets)
+			    .insert(VkAllocation::GetMemBucket(p_resource));
+		CHECK_EQ(image_buckets, std::set<uint32_t>{0u});
+		CHECK_EQ(buffer_buckets, std::set<uint32_t>{1u});
+		// A bound transient heap keeps one allocation per bucket
+		CHECK_EQ(allocation.GetSharableMemBuckets(), std::vector<uint32_t>{0u, 1u});
+
+		printf("Alias Barriers: %zu\n", allocation.GetAliasBarrierCount());
+
+		// A snapshot keeps the layout only, its objects are left to the resource pool
+		std::vector<std::tuple<VkDeviceSize, uint32_t>> placements;
+		for (const ResourceBase *p_resource : metadata.GetIntRootResources())
+			placements.emplace_back(VkAllocation::GetMemOffset(p_resource), VkAllocation::GetMemBucket(p_resource));
+		auto snapshot = allocation.MakeSnapshot({.render_graph = *render_graph,
+		                                         .collection = collection,
+		                                         .dependency = dependency,
+		                                         .metadata = metadata,
+		                                         .resource_pool = *resource_pool});
+		std::size_t snapshot_resource_count = 0;
+		for (const auto &bucket : snapshot.mem_buckets)
+			snapshot_resource_count += bucket.root_ids.size();
+		CHECK_EQ(snapshot_resource_count, metadata.GetIntRootResources().size());
+		auto restored = VkAllocation::Plan({.render_graph = *render_graph,
+		                                    .collection = collection,
+		                                    .dependency = dependency,
+		                                    .metadata = metadata,
+		                                    .resource_pool = *resource_pool},
+		                                   snapshot);
+		std::vector<std::tuple<VkDeviceSize, uint32_t>> restored_placements;
+		for (const ResourceBase *p_resource : metadata.GetIntRootResources())
+			restored_placements.emplace_back(VkAllocation::GetMemOffset(p_resource),
+			                                 VkAllocation::GetMemBucket(p_resource));
+		CHECK_EQ(restored_placements, placements);
+		CHECK_EQ(restored.GetAliasBarrierCount(), allocation.GetAliasBarrierCount());
+
+		auto command = VkCommand::Create(nullptr, {.render_graph = *render_graph,
+		                                           .collection = collection,
+		                                           .dependency = dependency,
+		                                           .metadata = metadata,
+		                                           .schedule = schedule,
+		                                           .vk_allocation = allocation});
+		CHECK_EQ(command.GetPassCommands().size(), schedule.GetPassGroups().size());
+
+		// Without device-local memory, the buckets fall back to the allowed types and only prefer device-local
+		auto host_model = model;
+		host_model.memory_types = {VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+		                           VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT};
+		PlanningInput host_input{*render_graph};
+		auto host_snapshot = VkAllocation::Plan(host_model, host_input.GetArgs(*resource_pool))
+		                         .MakeSnapshot(host_input.GetArgs(*resource_pool));
+		REQUIRE_FALSE(host_snapshot.mem_buckets.empty());
+		for (const auto &bucket : host_snapshot.mem_buckets) {
+			CHECK_EQ(bucket.key >> 1u, 0u);
+			CHECK_EQ(bucket.create_info.memoryTypeBits, 0b01u);
+			CHECK_EQ(bucket.create_info.requiredFlags, 0u);
+			CHECK_EQ(bucket.create_info.preferredFlags, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+		}
+
+		// Both storage buffers fit in one backing buffer, which is named once after them
+		PairRenderGraph pair_graph;
+		PlanningInput pair_input{pair_graph};
+		auto pair_args = pair_input.GetArgs(*resource_pool);
+		pair_args.buffer_pack_max_size = 128;
+		VkAllocation packed_allocation = VkAllocation::Plan(model, pair_args);
+		auto packed_groups = packed_allocation.GetPackedBufferGroups();
+		REQUIRE_EQ(packed_groups.size(), 1);
+		CHECK_EQ(packed_groups[0].size(), 2);
+		std::string packed_name = myvk_rg_executor::VkRunner::GetPackedBufferName(packed_groups[0]);
+		for (const ResourceBase *p_buffer : packed_groups[0])
+			CHECK_NE(packed_name.find(p_buffer->GetGlobalKey().Format()), std::string::npos);
+
+		// Mapped buffers of disjoint lifetimes share memory only if enabled, ones read and written never do
+		MappedRenderGraph mapped_graph;
+		PlanningInput mapped_input{mapped_graph};
+		const auto plan_mapped = [&](bool alias_mapped_buffers) {
+			auto args = mapped_input.GetArgs(*resource_pool);
+			args.alias_mapped_buffers = alias_mapped_buffers;
+			return VkAllocation::Plan(model, args);
+		};
+		const auto *p_upload = mapped_graph.GetBuffer("upload"), *p_readback = mapped_graph.GetBuffer("readback"),
+		           *p_persistent = mapped_graph.GetBuffer("persistent");
+		auto mapped_allocation = plan_mapped(false);
+		CHECK_FALSE(mapped_allocation.IsAliased(p_upload, p_readback));
+		CHECK_FALSE(mapped_allocation.IsAliased(p_upload, p_persistent));
+		mapped_allocation = plan_mapped(true);
+		CHECK(mapped_allocation.IsAliased(p_upload, p_readback));
+		CHECK_EQ(VkAllocation::GetMemOffset(p_upload), VkAllocation::GetMemOffset(p_readback));
+		CHECK_FALSE(mapped_allocation.IsAliased(p_upload, p_persistent));
+		CHECK_FALSE(mapped_allocation.IsAliased(p_readback, p_persistent));
+		// Only the device-local bucket of "temp" may go to a transient heap
+		CHECK_EQ(mapped_allocation.GetSharableMemBuckets(),
+		         std::vector<uint32_t>{VkAllocation::GetMemBucket(mapped_graph.GetBuffer("temp"))});
+
+		// Weighting the barriers trades memory for fewer aliasing barriers, even between neighbouring passes
+		RelayRenderGraph relay_graph{4};
+		PlanningInput relay_input{relay_graph};
+		const auto plan_relay = [&](float alias_barrier_weight) {
+			auto args = relay_input.GetArgs(*resource_pool);
+			args.alias_barrier_weight = alias_barrier_weight;
+			return VkAllocation::Plan(model, args);
+		};
+		VkAllocation relay_allocation = plan_relay(0.0f);
+		std::size_t relay_barrier_count = relay_allocation.GetAliasBarrierCount();
+		CHECK_GT(relay_barrier_count, 0);
+		// Counted on the overlapping pairs only, they match the barriers VkCommand puts between all aliased ones
+		std::size_t relay_aliased_pair_count = 0;
+		for (const ResourceBase *p_l : relay_input.metadata.GetIntRootResources())
+			for (const ResourceBase *p_r : relay_input.metadata.GetIntRootResources())
+				relay_aliased_pair_count +=
+				    relay_allocation.IsAliased(p_l, p_r) && relay_input.dependency.IsResourceLess(p_l, p_r);
+		CHECK_EQ(relay_barrier_count, relay_aliased_pair_count);
+		CHECK_LT(plan_relay(16.0f).GetAliasBarrierCount(), relay_barrier_count);
+	}
+
+	TEST_CASE("Test Transient Heap Requirements") {
+		using myvk_rg::executor::TransientHeap;
+		const VmaAllocationCreateInfo create_info = {.flags = VMA_ALLOCATION_CREATE_CAN_ALIAS_BIT,
+		                                             .requiredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT};
+		VkMemoryRequirements heap_reqs = {.size = 4096, .alignment = 256, .memoryTypeBits = 0b0111};
+		VmaAllocationCreateInfo heap_create_info = create_info;
+		heap_create_info.memoryTypeBits = 0b0011;
+
+		// Alignments and memory types of the executors combine, so either one is served by the merged heap
+		const VkMemoryRequirements other_reqs = {.size = 1024, .alignment = 4096, .memoryTypeBits = 0b0110};
+		REQUIRE(TransientHeap::MergeRequirements(&heap_reqs, &heap_create_info, other_reqs, create_info));
+		CHECK_EQ(heap_reqs.size, 4096);
+		CHECK_EQ(heap_reqs.alignment, 4096);
+		CHECK_EQ(heap_reqs.memoryTypeBits, 0b0110);
+		CHECK_EQ(heap_create_info.memoryTypeBits, 0b0010);
+		// Merging again changes nothing, the heap is not reallocated back and forth
+		auto merged_reqs = heap_reqs;
+		auto merged_create_info = heap_create_info;
+		REQUIRE(TransientHeap::MergeRequirements(&merged_reqs, &merged_create_info, other_reqs, create_info));
+		CHECK_EQ(merged_reqs.alignment, heap_reqs.alignment);
+		CHECK_EQ(merged_reqs.memoryTypeBits, heap_reqs.memoryTypeBits);
+		CHECK_EQ(merged_create_info.memoryTypeBits, heap_create_info.memoryTypeBits);
+
+		// Disjoint memory types or different flags cannot share memory
+		const VkMemoryRequirements disjoint_reqs = {.size = 1024, .alignment = 256, .memoryTypeBits = 0b1000};
+		CHECK_FALSE(TransientHeap::MergeRequirements(&merged_reqs, &merged_create_info, disjoint_reqs, create_info));
+		VmaAllocationCreateInfo mapped_create_info = create_info;
+		mapped_create_info.flags |= VMA_ALLOCATION_CREATE_MAPPED_BIT;
+		CHECK_FALSE(
+		    TransientHeap::MergeRequirements(&merged_reqs, &merged_create_info, other_reqs, mapped_create_info));
+	}
+
+	TEST_CASE("Test Interval Overlap") {
+		std::vector<std::pair<uint64_t, uint64_t>> intervals;
+		for (uint64_t i = 0; i < 200; ++i) {
+			uint64_t begin = (i * 7919) % 1000, size = (i * 104729) % 64;
+			intervals.emplace_back(begin, begin + size);
+		}
+		std::set<std::pair<std::size_t, std::size_t>> swept, brute;
+		myvk_rg_executor::ForEachIntervalOverlap<uint64_t>(
+		    intervals, [&](std::size_t l, std::size_t r) { swept.emplace(std::min(l, r), std::max(l, r)); });
+		for (std::size_t l = 0; l < intervals.size(); ++l)
+			for (std::size_t r = l + 1; r < intervals.size(); ++r)
+				if (intervals[l].first < intervals[r].second && intervals[r].first < intervals[l].second &&
+				    intervals[l].first < intervals[l].second && intervals[r].first < intervals[r].second)
+					brute.emplace(l, r);
+		CHECK_FALSE(brute.empty());
+		CHECK(swept == brute);
+	}
+}